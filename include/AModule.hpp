@@ -6,7 +6,11 @@
 #include <gtkmm/eventbox.h>
 #include <json/json.h>
 
+#include <functional>
+
 #include "IModule.hpp"
+#include "util/metrics.hpp"
+#include "util/update_dispatcher.hpp"
 
 namespace waybar {
 
@@ -21,7 +25,10 @@ class AModule : public IModule {
   auto doAction(const std::string &name) -> void override;
 
   /// Emitting on this dispatcher triggers a update() call
-  Glib::Dispatcher dp;
+  util::UpdateDispatcher dp;
+
+  /// Runs update(), recording its duration and delay when instrumentation is enabled
+  void dispatchUpdate();
 
  protected:
   // Don't need to make an object directly
@@ -34,6 +41,18 @@ class AModule : public IModule {
   SCROLL_DIR getScrollDir(GdkEventScroll *e);
   bool tooltipEnabled() const;
 
+  /**
+   * Lazy tooltips.
+   * The producer is only invoked when GTK queries the tooltip of `widget` and its result is cached
+   * until invalidateTooltip() is called, so modules don't format tooltips nobody looks at.
+   */
+  void setTooltipProducer(Gtk::Widget &widget, std::function<std::string()> producer,
+                          bool markup = true);
+  void invalidateTooltip();
+  const std::string &getTooltip();
+  virtual bool handleQueryTooltip(int x, int y, bool keyboard_tooltip,
+                                  const Glib::RefPtr<Gtk::Tooltip> &tooltip);
+
   const std::string name_;
   const Json::Value &config_;
   Gtk::EventBox event_box_;
@@ -55,6 +74,13 @@ class AModule : public IModule {
   gdouble distance_scrolled_y_;
   gdouble distance_scrolled_x_;
   std::map<std::string, std::string> eventActionMap_;
+  Gtk::Widget *tooltipWidget_{nullptr};
+  std::function<std::string()> tooltipProducer_;
+  std::string tooltipText_;
+  bool tooltipMarkup_{true};
+  bool tooltipCached_{false};
+  util::metrics::Histogram *updateMetric_{nullptr};
+  util::metrics::Histogram *latencyMetric_{nullptr};
   static const inline std::map<std::pair<uint, GdkEventType>, std::string> eventMap_{
       {std::make_pair(1, GdkEventType::GDK_BUTTON_PRESS), "on-click"},
       {std::make_pair(1, GdkEventType::GDK_BUTTON_RELEASE), "on-click-release"},
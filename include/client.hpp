@@ -5,6 +5,10 @@
 #include <gdk/gdkwayland.h>
 #include <wayland-client.h>
 
+#include <functional>
+#include <map>
+#include <string>
+
 #include "bar.hpp"
 #include "config.hpp"
 #include "util/css_reload_helper.hpp"
@@ -21,6 +25,21 @@ class Client {
   int main(int argc, char *argv[]);
   void reset();
 
+  struct WaylandGlobal {
+    uint32_t name;
+    std::string interface;
+    uint32_t version;
+  };
+  using GlobalHandler = std::function<void(struct wl_registry *, const WaylandGlobal &)>;
+
+  /**
+   * Calls `handler` for every global of `interface` on the shared registry: immediately for the
+   * ones already announced and later for the ones that appear. Returns an id for
+   * unsubscribeGlobal().
+   */
+  int subscribeGlobal(const std::string &interface, GlobalHandler handler);
+  void unsubscribeGlobal(int id);
+
   Glib::RefPtr<Gtk::Application> gtk_app;
   Glib::RefPtr<Gdk::Display> gdk_display;
   struct wl_display *wl_display = nullptr;
@@ -56,6 +75,10 @@ class Client {
   std::list<struct waybar_output> outputs_;
   std::unique_ptr<CssReloadHelper> m_cssReloadHelper;
   std::string m_cssFile;
+
+  std::map<uint32_t, WaylandGlobal> globals_;
+  std::map<int, std::pair<std::string, GlobalHandler>> global_handlers_;
+  int next_global_handler_id_ = 0;
 };
 
 }  // namespace waybar
@@ -27,6 +27,21 @@ class Battery : public ALabel {
   auto update() -> void override;
 
  private:
+  // What the tooltip shows, so it is only formatted when someone looks at it
+  struct TooltipValues {
+    std::string status;
+    std::string status_pretty;
+    std::string state;
+    uint8_t capacity = 0;
+    float time_remaining = 0;
+    std::string time_remaining_formatted;
+    float power = 0;
+    uint16_t cycles = 0;
+    float health = 0;
+
+    bool operator==(const TooltipValues&) const = default;
+  };
+
   static inline const fs::path data_dir_ = "/sys/class/power_supply/";
 
   void refreshBatteries();
@@ -35,6 +50,7 @@ class Battery : public ALabel {
   std::tuple<uint8_t, float, std::string, float, uint16_t, float> getInfos();
   const std::string formatTimeRemaining(float hoursRemaining);
   void setBarClass(std::string&);
+  std::string formatTooltip() const;
 
   int global_watch;
   std::map<fs::path, int> batteries_;
@@ -45,6 +61,7 @@ class Battery : public ALabel {
   std::string old_status_;
   bool warnFirstTime_{true};
   const Bar& bar_;
+  TooltipValues tooltip_;
 
   util::SleeperThread thread_;
   util::SleeperThread thread_battery_update_;
@@ -1,13 +1,9 @@
 #pragma once
 
-#include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include <gtkmm/drawingarea.h>
 
-namespace cava {
-extern "C" {
-#include <cava/common.h>
-}
-}  // namespace cava
+#include "ALabel.hpp"
+#include "util/cava_backend.hpp"
 
 namespace waybar::modules {
 using namespace std::literals::chrono_literals;
@@ -20,27 +16,23 @@ class Cava final : public ALabel {
   auto doAction(const std::string& name) -> void override;
 
  private:
-  util::SleeperThread thread_;
-  util::SleeperThread thread_fetch_input_;
-
-  struct cava::error_s error_ {};          // cava errors
-  struct cava::config_params prm_ {};      // cava parameters
-  struct cava::audio_raw audio_raw_ {};    // cava handled raw audio data(is based on audio_data)
-  struct cava::audio_data audio_data_ {};  // cava audio data
-  struct cava::cava_plan* plan_;           //{new cava_plan{}};
-  // Cava API to read audio source
-  cava::ptr input_source_;
-  // Delay to handle audio source
-  std::chrono::milliseconds frame_time_milsec_{1s};
+  // Capture and FFT are shared across outputs and run off the main thread
+  std::shared_ptr<util::CavaBackend> backend_;
+  int subscription_{-1};
+  // Last frame read from the backend
+  util::CavaBackend::Frame frame_;
   // Text to display
   std::string text_{""};
-  int rePaint_{1};
-  std::chrono::seconds fetch_input_delay_{4};
-  std::chrono::seconds suspend_silence_delay_{0};
-  bool silence_{false};
   bool hide_on_silence_{false};
   std::string format_silent_{""};
-  int sleep_counter_{0};
+  // Graph mode: bars are painted with Cairo instead of format-icons markup
+  bool graph_{false};
+  int graph_threshold_{1};
+  int graph_spacing_{1};
+  Gtk::DrawingArea area_;
+  std::vector<int> drawn_bars_;
+  void updateGraph();
+  bool onDraw(const Cairo::RefPtr<Cairo::Context>& cr);
   // Cava method
   void pause_resume();
   // ModuleActionMap
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <gtkmm/label.h>
+
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "AModule.hpp"
 #include "util/command.hpp"
@@ -13,11 +18,28 @@ namespace ffi {
 extern "C" {
 typedef struct wbcffi_module wbcffi_module;
 
+enum {
+  WBCFFI_FD_READ = 1 << 0,
+  WBCFFI_FD_WRITE = 1 << 1,
+  WBCFFI_FD_ERROR = 1 << 2,
+};
+
+typedef void (*wbcffi_fd_callback)(void* instance, int fd, uint32_t events);
+typedef int (*wbcffi_timer_callback)(void* instance);
+typedef void (*wbcffi_tick_callback)(void* instance, uint64_t tick);
+
 typedef struct {
   wbcffi_module* obj;
   const char* waybar_version;
   GtkContainer* (*get_root_widget)(wbcffi_module*);
   void (*queue_update)(wbcffi_module*);
+  // ABI version 2
+  unsigned int (*add_fd)(wbcffi_module*, int, uint32_t, wbcffi_fd_callback);
+  unsigned int (*add_timer)(wbcffi_module*, uint32_t, wbcffi_timer_callback);
+  unsigned int (*add_tick)(wbcffi_module*, wbcffi_tick_callback);
+  void (*remove_source)(wbcffi_module*, unsigned int);
+  void (*set_text)(wbcffi_module*, const char*);
+  void (*set_classes)(wbcffi_module*, const char* const*, size_t);
 } wbcffi_init_info;
 
 struct wbcffi_config_entry {
@@ -37,6 +59,16 @@ class CFFI : public AModule {
   virtual auto update() -> void override;
 
  private:
+  unsigned addSource(std::function<void()> remove);
+  unsigned addFd(int fd, uint32_t events, ffi::wbcffi_fd_callback cb);
+  unsigned addTimer(uint32_t interval_ms, ffi::wbcffi_timer_callback cb);
+  unsigned addTick(ffi::wbcffi_tick_callback cb);
+  void removeSource(unsigned id);
+  void removeSources();
+  Gtk::Label& label();
+  void setText(const char* markup);
+  void setClasses(const char* const* classes, size_t classes_len);
+
   ///
   void* cffi_instance_ = nullptr;
 
@@ -55,6 +87,15 @@ class CFFI : public AModule {
     std::function<DoActionFn> doAction = [](void*, const char*) {};
     std::function<UpdateFn> update = [](void*) {};
   } hooks_;
+
+  // Main loop sources registered through the v2 API, mapped to the function removing them
+  std::map<unsigned, std::function<void()>> sources_;
+  unsigned next_source_id_ = 1;
+
+  // Label managed through set_text/set_classes, created on first use
+  std::unique_ptr<Gtk::Label> label_;
+  std::string markup_;
+  std::vector<std::string> classes_;
 };
 
 }  // namespace waybar::modules
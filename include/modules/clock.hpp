@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <optional>
+
 #include "ALabel.hpp"
 #include "util/date.hpp"
 #include "util/sleeper_thread.hpp"
@@ -26,7 +29,8 @@ class Clock final : public ALabel {
   const std::string m_tlpFmt_;
   std::string m_tlpText_{""};                 // tooltip text to print
   const Glib::RefPtr<Gtk::Label> m_tooltip_;  // tooltip as a separate Gtk::Label
-  bool query_tlp_cb(int, int, bool, const Glib::RefPtr<Gtk::Tooltip>& tooltip);
+  bool handleQueryTooltip(int, int, bool, const Glib::RefPtr<Gtk::Tooltip>& tooltip) override;
+  auto get_tooltip() -> std::string;
   // Calendar
   const bool cldInTooltip_;  // calendar in tooltip
   /*
@@ -35,22 +39,25 @@ class Clock final : public ALabel {
     2 - calendar.format.days
     3 - calendar.format.today
     4 - calendar.format.weeks
-    5 - tooltip-format
    */
-  std::map<int, std::string const> fmtMap_;
+  std::array<std::string, 5> fmtMap_;
   uint cldMonCols_{3};           // calendar count month columns
   int cldWnLen_{3};              // calendar week number length
   const int cldMonColLen_{20};   // calendar month column length
   WS cldWPos_{WS::HIDDEN};       // calendar week side to print
   months cldCurrShift_{0};       // calendar months shift
   int cldShift_{1};              // calendar months shift factor
-  year_month_day cldYearShift_;  // calendar Year mode. Cached ymd
-  std::string cldYearCached_;    // calendar Year mode. Cached calendar
-  year_month cldMonShift_;       // calendar Month mode. Cached ym
-  std::string cldMonCached_;     // calendar Month mode. Cached calendar
-  day cldBaseDay_{0};            // calendar Cached day. Is used when today is changing(midnight)
   std::string cldText_{""};      // calendar text to print
   CldMode cldMode_{CldMode::MONTH};
+  struct CldCacheKey {
+    year_month_day today;
+    year_month shown;  // shown month, January of the shown year in Year mode
+    CldMode mode;
+    const time_zone* tz;
+    bool operator==(const CldCacheKey&) const = default;
+  };
+  std::optional<CldCacheKey> cldCacheKey_;  // calendar cache key
+  std::string cldCached_;                   // calendar Cached calendar
   auto get_calendar(const year_month_day& today, const year_month_day& ymd,
                     const time_zone* tz) -> const std::string;
 
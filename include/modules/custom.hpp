@@ -2,11 +2,16 @@
 
 #include <fmt/format.h>
 
+#include <atomic>
+#include <chrono>
 #include <csignal>
+#include <mutex>
 #include <string>
+#include <string_view>
 
 #include "ALabel.hpp"
 #include "util/command.hpp"
+#include "util/flat_json.hpp"
 #include "util/json.hpp"
 #include "util/sleeper_thread.hpp"
 
@@ -23,6 +28,15 @@ class Custom : public ALabel {
   void delayWorker();
   void continuousWorker();
   void waitingWorker();
+  void persistentWorker();
+  bool startPersistent();
+  bool requestPersistent(const char* reason);
+  void stopPersistent();
+  bool readLine();
+  bool readStream();
+  bool applyStreamLine(std::string_view line);
+  bool applyStreamOutput(const std::string& output);
+  bool loadStreamState();
   void parseOutputRaw();
   void parseOutputJson();
   void handleEvent();
@@ -43,6 +57,30 @@ class Custom : public ALabel {
   util::command::res output_;
   util::JsonParser parser_;
 
+  // "json-stream" return type: lines only carry the fields that changed
+  struct StreamState {
+    std::string text;
+    std::string alt;
+    std::string tooltip;
+    std::vector<std::string> classes;
+    int percentage{0};
+    bool received{false};
+  };
+  const bool stream_;
+  std::mutex stream_mutex_;
+  StreamState stream_state_;
+  // Unconsumed script output, worker thread only
+  std::string stream_buffer_;
+  util::FlatJsonReader stream_reader_;
+
+  // "persistent" scripts stay alive and answer one line per request written to their stdin
+  int persistent_in_;
+  std::chrono::milliseconds persistent_timeout_;
+  std::atomic<const char*> persistent_reason_;
+
+  // Duration of exec runs, or of requests to a persistent script
+  util::metrics::Histogram* exec_metric_;
+
   util::SleeperThread thread_;
 };
 
@@ -18,11 +18,27 @@ class Disk : public ALabel {
   auto update() -> void override;
 
  private:
+  // What the tooltip shows, so it is only formatted when someone looks at it
+  struct TooltipValues {
+    std::string free;
+    std::string used;
+    std::string total;
+    uint64_t percentage_free = 0;
+    uint64_t percentage_used = 0;
+    float specific_free = 0;
+    float specific_used = 0;
+    float specific_total = 0;
+
+    bool operator==(const TooltipValues&) const = default;
+  };
+
   util::SleeperThread thread_;
   std::string path_;
   std::string unit_;
+  TooltipValues tooltip_;
 
   float calc_specific_divisor(const std::string divisor);
+  std::string formatTooltip() const;
 };
 
 }  // namespace waybar::modules
@@ -8,6 +8,7 @@
 #include "bar.hpp"
 #include "dwl-ipc-unstable-v2-client-protocol.h"
 #include "util/json.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::dwl {
 
@@ -26,6 +27,7 @@ class Window : public AAppIconLabel, public sigc::trackable {
 
  private:
   const Bar &bar_;
+  util::RewriteRuleSet rewrite_;
 
   std::string title_;
   std::string appid_;
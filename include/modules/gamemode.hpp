@@ -5,6 +5,7 @@
 #include <string>
 
 #include "ALabel.hpp"
+#include "giomm/cancellable.h"
 #include "giomm/dbusconnection.h"
 #include "giomm/dbusproxy.h"
 #include "glibconfig.h"
@@ -39,6 +40,7 @@ class Gamemode : public AModule {
                  const Glib::VariantContainerBase &arguments);
 
   void getData();
+  void setGameCount(const Glib::VariantBase &value);
   bool handleToggle(GdkEventButton *const &) override;
 
   // Config
@@ -67,11 +69,13 @@ class Gamemode : public AModule {
   std::string lastStatus;
   bool showAltText = false;
 
-  guint login1_id;
+  guint login1_id = 0;
   Glib::RefPtr<Gio::DBus::Proxy> gamemode_proxy;
+  sigc::connection gamemode_signal;
   Glib::RefPtr<Gio::DBus::Connection> system_connection;
-  bool gamemodeRunning;
+  bool gamemodeRunning = false;
   guint gamemodeWatcher_id;
+  Glib::RefPtr<Gio::Cancellable> cancellable_;
 };
 
 }  // namespace waybar::modules
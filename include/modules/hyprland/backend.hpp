@@ -1,25 +1,67 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
-#include <list>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <utility>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
+#include "modules/hyprland/windowindex.hpp"
 #include "util/json.hpp"
 
 namespace waybar::modules::hyprland {
 
+/**
+ * A socket2 event ("name>>arg1,arg2,..."), parsed once and shared by every handler subscribed to
+ * its name. The views point into the received line and are only valid during onEvent().
+ */
+struct IPCEvent {
+  static IPCEvent parse(std::string_view line);
+
+  // Payload starting at the i-th argument, for trailing fields that may contain commas
+  std::string_view argsFrom(size_t i) const;
+
+  std::string_view name;
+  std::string_view payload;
+  std::vector<std::string_view> args;
+};
+
 class EventHandler {
  public:
-  virtual void onEvent(const std::string& ev) = 0;
+  virtual void onEvent(const IPCEvent& ev) = 0;
   virtual ~EventHandler() = default;
 };
 
+/**
+ * Immutable view of the compositor state. The IPC thread publishes a new version before it
+ * dispatches an event that changed it, readers keep the snapshot alive as long as they need it.
+ */
+class State {
+ public:
+  // Increases with every published version
+  uint64_t generation() const { return generation_; }
+  const WindowIndex& windows() const { return windows_; }
+
+ private:
+  friend class IPC;
+
+  uint64_t generation_ = 0;
+  WindowIndex windows_;
+};
+
 class IPC {
  public:
   IPC() { startIPC(); }
+  // Stops and joins the event thread
+  ~IPC();
+  IPC(const IPC&) = delete;
+  IPC& operator=(const IPC&) = delete;
 
   void registerForIPC(const std::string& ev, EventHandler* ev_handler);
   void unregisterForIPC(EventHandler* handler);
@@ -28,16 +70,55 @@ class IPC {
   Json::Value getSocket1JsonReply(const std::string& rq);
   static std::filesystem::path getSocketFolder(const char* instanceSig);
 
+  // Latest published state. Never blocks on the IPC thread for longer than a pointer copy.
+  std::shared_ptr<const State> state() const;
+  /* Reloads the windows from socket1, for when an event refers to a window the state doesn't
+   * know. The overload takes a `clients` reply the caller already has.
+   */
+  void resyncWindows();
+  void resyncWindows(const Json::Value& clients);
+
  protected:
   static std::filesystem::path socketFolder_;
 
+  void parseIPC(const std::string&);
+
  private:
+  // Allows looking up event names by string_view without building a std::string
+  struct NameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+  };
+  using Callbacks =
+      std::unordered_map<std::string, std::vector<EventHandler*>, NameHash, std::equal_to<>>;
+
   void startIPC();
-  void parseIPC(const std::string&);
+  void loadState();
+  void updateState(const IPCEvent& event);
+  // Called with updateMutex_ held
+  void publish(WindowIndex windows);
 
+  std::thread ipcThread_;
+  // The destructor shuts socket2 down to wake the event thread up from its read. Both are guarded
+  // by socketMutex_ so the socket is never shut down after the thread closed it.
+  std::mutex socketMutex_;
+  bool stopping_ = false;
+  int socketfd_ = -1;
+
+  // Registrations are copied on write so events are dispatched without holding callbackMutex_
   std::mutex callbackMutex_;
+  std::shared_ptr<const Callbacks> callbacks_ = std::make_shared<const Callbacks>();
+  // Held while handlers run, so unregisterForIPC() can wait for an in-flight event
+  std::mutex dispatchMutex_;
+  std::atomic<std::thread::id> dispatchThread_;
   util::JsonParser parser_;
-  std::list<std::pair<std::string, EventHandler*>> callbacks_;
+
+  // Serializes the updates of the state, which may come from the IPC thread or a module
+  std::mutex updateMutex_;
+  // Workspace names by id, to find the windows of a renamed workspace
+  std::unordered_map<std::string, std::string> workspaceNames_;
+  mutable std::mutex stateMutex_;
+  std::shared_ptr<const State> state_ = std::make_shared<const State>();
 };
 
 inline std::unique_ptr<IPC> gIPC;
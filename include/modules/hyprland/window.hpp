@@ -8,6 +8,7 @@
 #include "bar.hpp"
 #include "modules/hyprland/backend.hpp"
 #include "util/json.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::hyprland {
 
@@ -43,7 +44,7 @@ class Window : public waybar::AAppIconLabel, public EventHandler {
 
   static auto getActiveWorkspace(const std::string&) -> Workspace;
   static auto getActiveWorkspace() -> Workspace;
-  void onEvent(const std::string& ev) override;
+  void onEvent(const IPCEvent& ev) override;
   void queryActiveWorkspace();
   void setClass(const std::string&, bool enable);
 
@@ -51,6 +52,7 @@ class Window : public waybar::AAppIconLabel, public EventHandler {
   std::mutex mutex_;
   const Bar& bar_;
   util::JsonParser parser_;
+  util::RewriteRuleSet rewrite_;
   WindowData windowData_;
   Workspace workspace_;
   std::string soloClass_;
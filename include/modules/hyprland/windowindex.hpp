@@ -0,0 +1,56 @@
+#pragma once
+
+#include <json/value.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "util/persistent_map.hpp"
+
+using WindowAddress = std::string;
+
+namespace waybar::modules::hyprland {
+
+/**
+ * Every window known to Hyprland, kept up to date from socket2 events so that window events
+ * don't need a socket1 round-trip. Workspaces are keyed by name without the "special:" prefix
+ * because `openwindow` doesn't carry the workspace id.
+ * Copies share the windows with the original, so a new version can be built for every event.
+ */
+class WindowIndex {
+ public:
+  struct Window {
+    std::string workspaceName;
+    std::string windowClass;
+    std::string windowTitle;
+  };
+
+  /// The key of a workspace name as reported by Hyprland
+  static std::string workspaceKey(std::string const& name);
+
+  /// Adds the window or moves it to `workspace_name`
+  void insert(WindowAddress const& addr, std::string const& workspace_name,
+              std::string window_class, std::string window_title);
+  /// Removes the window, returns the workspace it was on
+  std::optional<std::string> erase(WindowAddress const& addr);
+  const Window* find(WindowAddress const& addr) const;
+  /// Returns false if the window isn't known
+  bool setTitle(WindowAddress const& addr, std::string window_title);
+  /// Moves the windows of a renamed workspace to its new name
+  void renameWorkspace(std::string const& old_name, std::string const& new_name);
+  uint32_t windowCount(std::string const& workspace_name) const;
+  size_t size() const { return m_windows.size(); }
+
+  /// Replaces the content with the reply of the `j/clients` request
+  void rebuild(Json::Value const& clients_json);
+
+ private:
+  util::PersistentMap<Window> m_windows;
+  // One entry per workspace with windows, small enough to be copied with the index
+  std::unordered_map<std::string, uint32_t> m_counts;
+};
+
+}  // namespace waybar::modules::hyprland
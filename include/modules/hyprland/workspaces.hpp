@@ -9,12 +9,14 @@
 #include <memory>
 #include <regex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "AModule.hpp"
 #include "bar.hpp"
 #include "modules/hyprland/backend.hpp"
 #include "modules/hyprland/windowcreationpayload.hpp"
+#include "modules/hyprland/windowindex.hpp"
 #include "modules/hyprland/workspace.hpp"
 #include "util/enum.hpp"
 #include "util/regex_collection.hpp"
@@ -47,7 +49,7 @@ class Workspaces : public AModule, public EventHandler {
   bool windowRewriteConfigUsesTitle() const { return m_anyWindowRewriteRuleUsesTitle; }
 
  private:
-  void onEvent(const std::string& e) override;
+  void onEvent(const IPCEvent& ev) override;
   void updateWindowCount();
   void sortWorkspaces();
   void createWorkspace(Json::Value const& workspace_data,
@@ -58,6 +60,10 @@ class Workspaces : public AModule, public EventHandler {
   void removeWorkspace(std::string const& name);
   void setUrgentWorkspace(std::string const& windowaddress);
 
+  // workspace index
+  void reindexWorkspaces();
+  Workspace* findWorkspace(std::string const& name);
+
   // Config
   void parseConfig(const Json::Value& config);
   auto populateIconsMap(const Json::Value& formatIcons) -> void;
@@ -83,11 +89,11 @@ class Workspaces : public AModule, public EventHandler {
   void onMonitorFocused(std::string const& payload);
 
   // window events
-  void onWindowOpened(std::string const& payload);
+  void onWindowOpened(IPCEvent const& ev);
   void onWindowClosed(std::string const& addr);
-  void onWindowMoved(std::string const& payload);
+  void onWindowMoved(IPCEvent const& ev);
 
-  void onWindowTitleEvent(std::string const& payload);
+  void onWindowTitleEvent(IPCEvent const& ev);
 
   void onConfigReloaded();
 
@@ -147,6 +153,12 @@ class Workspaces : public AModule, public EventHandler {
 
   std::vector<std::regex> m_ignoreWorkspaces;
 
+  // The published state as of the last event, see onWindowClosed()
+  std::shared_ptr<const State> m_state;
+  // Version of the state the window counts were taken from
+  uint64_t m_windowCountGeneration = 0;
+  std::unordered_map<std::string, Workspace*> m_workspaceIndex;
+
   std::mutex m_mutex;
   const Bar& m_bar;
   Gtk::Box m_box;
@@ -17,9 +17,25 @@ class Memory : public ALabel {
   auto update() -> void override;
 
  private:
+  // What the tooltip shows, so it is only formatted when someone looks at it
+  struct TooltipValues {
+    float total_ram_gigabytes = 0;
+    float total_swap_gigabytes = 0;
+    int used_ram_percentage = 0;
+    int used_swap_percentage = 0;
+    float used_ram_gigabytes = 0;
+    float used_swap_gigabytes = 0;
+    float available_ram_gigabytes = 0;
+    float available_swap_gigabytes = 0;
+
+    bool operator==(const TooltipValues&) const = default;
+  };
+
   void parseMeminfo();
+  std::string formatTooltip() const;
 
   std::unordered_map<std::string, unsigned long> meminfo_;
+  TooltipValues tooltip_;
 
   util::SleeperThread thread_;
 };
@@ -9,6 +9,7 @@
 #include <sys/epoll.h>
 
 #include <optional>
+#include <vector>
 
 #include "ALabel.hpp"
 #include "util/sleeper_thread.hpp"
@@ -25,6 +26,28 @@ class Network : public ALabel {
   auto update() -> void override;
 
  private:
+  // Values of the last update, formatted into the tooltip when GTK asks for it
+  struct TooltipValues {
+    std::string format;
+    std::string text;
+    std::string essid;
+    std::string bssid;
+    int32_t signal_strength_dbm = 0;
+    uint8_t signal_strength = 0;
+    std::string signal_strength_app;
+    std::string ifname;
+    std::string netmask;
+    std::string ipaddr;
+    std::string gwaddr;
+    int cidr = 0;
+    float frequency = 0;
+    std::string icon;
+    unsigned long long bandwidth_down = 0;
+    unsigned long long bandwidth_up = 0;
+
+    bool operator==(const TooltipValues&) const = default;
+  };
+
   static const uint8_t MAX_RETRY = 5;
   static const uint8_t EPOLL_MAX = 200;
 
@@ -48,6 +71,7 @@ class Network : public ALabel {
   void clearIface();
   bool wildcardMatch(const std::string& pattern, const std::string& text) const;
   std::optional<std::pair<unsigned long long, unsigned long long>> readBandwidthUsage();
+  std::string formatTooltip() const;
 
   int ifid_;
   sa_family_t family_;
@@ -67,6 +91,8 @@ class Network : public ALabel {
 
   unsigned long long bandwidth_down_total_;
   unsigned long long bandwidth_up_total_;
+  int netdev_fd_ = -1;
+  std::vector<char> netdev_buf_;
 
   std::string state_;
   std::string essid_;
@@ -88,6 +114,7 @@ class Network : public ALabel {
   util::Rfkill rfkill_;
 #endif
   float frequency_;
+  TooltipValues tooltip_;
 };
 
 }  // namespace waybar::modules
@@ -1,20 +1,120 @@
 #pragma once
 
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "util/json.hpp"
+#include "util/persistent_map.hpp"
+#include "util/sleeper_thread.hpp"
 
 namespace waybar::modules::niri {
 
+struct WorkspaceState {
+  uint64_t id;
+  unsigned idx;
+  std::optional<std::string> name;
+  // Interned by the IPC, compare by pointer. nullptr if the workspace has no output.
+  const std::string* output;
+  bool isActive;
+  bool isFocused;
+  std::optional<uint64_t> activeWindowId;
+};
+
+struct WindowState {
+  uint64_t id;
+  std::string title;
+  std::string appId;
+  std::optional<uint64_t> workspaceId;
+  bool isFocused;
+};
+
+// Objects touched by a single event.
+struct StateChanges {
+  // The whole list was replaced, ids are not recorded in that case.
+  bool allWorkspaces = false;
+  bool allWindows = false;
+  std::vector<uint64_t> workspaces;
+  std::vector<uint64_t> windows;
+
+  void merge(const StateChanges& other);
+  void clear();
+  bool empty() const;
+};
+
 class EventHandler {
  public:
   virtual void onEvent(const Json::Value& ev) = 0;
+  // Called before onEvent with the state changes caused by the event.
+  virtual void onStateChanged(const StateChanges& changes) {}
   virtual ~EventHandler() = default;
 };
 
+struct WorkspaceTable {
+  std::unordered_map<uint64_t, WorkspaceState> byId;
+  // Workspace ids sorted by output and index.
+  std::vector<uint64_t> order;
+  std::unordered_map<std::string, uint64_t> activeByOutput;
+  std::optional<uint64_t> focused;
+};
+
+// Window events are frequent (title changes), so the maps share their nodes between versions
+// instead of being copied for every event.
+struct WindowTable {
+  util::PersistentMap<WindowState> byId;
+  util::PersistentMap<unsigned> countByWorkspace;
+  std::optional<uint64_t> focused;
+};
+
+struct KeyboardLayouts {
+  std::vector<std::string> names;
+  unsigned current = 0;
+};
+
+/* Immutable view of the compositor state.
+ * The IPC thread publishes a new version after every event, sharing the tables the event didn't
+ * touch with the previous version. Readers keep the snapshot alive as long as they need it.
+ */
+class State {
+ public:
+  State();
+
+  // Increases with every published version.
+  uint64_t generation() const { return generation_; }
+
+  const std::unordered_map<uint64_t, WorkspaceState>& workspaces() const {
+    return workspaces_->byId;
+  }
+  const std::vector<uint64_t>& workspaceOrder() const { return workspaces_->order; }
+  const WorkspaceState* workspace(uint64_t id) const;
+  const WorkspaceState* focusedWorkspace() const;
+  const WorkspaceState* activeWorkspace(const std::string& output) const;
+
+  const util::PersistentMap<WindowState>& windows() const { return windows_->byId; }
+  const WindowState* window(uint64_t id) const;
+  unsigned windowCount(uint64_t workspaceId) const;
+
+  const std::vector<std::string>& keyboardLayoutNames() const { return layouts_->names; }
+  unsigned keyboardLayoutCurrent() const { return layouts_->current; }
+
+ private:
+  friend class IPC;
+
+  uint64_t generation_ = 0;
+  std::shared_ptr<const WorkspaceTable> workspaces_;
+  std::shared_ptr<const WindowTable> windows_;
+  std::shared_ptr<const KeyboardLayouts> layouts_;
+};
+
 class IPC {
  public:
   IPC() { startIPC(); }
@@ -22,25 +122,45 @@ class IPC {
   void registerForIPC(const std::string& ev, EventHandler* ev_handler);
   void unregisterForIPC(EventHandler* handler);
 
+  // Sends a request and waits for the reply.
   static Json::Value send(const Json::Value& request);
+  /* Queues a request for the request thread and returns immediately.
+   * `onReply` is invoked with the reply on that thread. Errors are logged.
+   */
+  void sendAsync(Json::Value request, std::function<void(const Json::Value&)> onReply = {});
 
-  // The data members are only safe to access while dataMutex_ is locked.
-  std::lock_guard<std::mutex> lockData() { return std::lock_guard(dataMutex_); }
-  const std::vector<Json::Value>& workspaces() const { return workspaces_; }
-  const std::vector<Json::Value>& windows() const { return windows_; }
-  const std::vector<std::string>& keyboardLayoutNames() const { return keyboardLayoutNames_; }
-  unsigned keyboardLayoutCurrent() const { return keyboardLayoutCurrent_; }
+  // Latest published state. Never blocks on the IPC thread for longer than a pointer copy.
+  std::shared_ptr<const State> state() const;
 
  private:
   void startIPC();
   static int connectToSocket();
   void parseIPC(const std::string&);
 
-  std::mutex dataMutex_;
-  std::vector<Json::Value> workspaces_;
-  std::vector<Json::Value> windows_;
-  std::vector<std::string> keyboardLayoutNames_;
-  unsigned keyboardLayoutCurrent_;
+  const std::string* internOutput(const Json::Value& output);
+  WorkspaceState parseWorkspace(const Json::Value& ws);
+  static WindowState parseWindow(const Json::Value& win);
+  void setWorkspaces(WorkspaceTable& table, const Json::Value& workspaces, StateChanges& changes);
+  static void activateWorkspace(WorkspaceTable& table, uint64_t id, bool focused,
+                                StateChanges& changes);
+  static void setWindows(WindowTable& table, const Json::Value& windows, StateChanges& changes);
+  static void setWindow(WindowTable& table, WindowState window, StateChanges& changes);
+  static void removeWindow(WindowTable& table, uint64_t id, StateChanges& changes);
+  static void focusWindow(WindowTable& table, std::optional<uint64_t> id, StateChanges& changes);
+  static void countWindow(WindowTable& table, const WindowState& window, int delta);
+
+  // Only ever grows, so the interned pointers stay valid for every snapshot.
+  std::unordered_set<std::string> outputs_;
+
+  mutable std::mutex stateMutex_;
+  std::shared_ptr<const State> state_ = std::make_shared<const State>();
+
+  void processRequests();
+
+  std::mutex requestMutex_;
+  std::deque<std::pair<Json::Value, std::function<void(const Json::Value&)>>> requests_;
+  bool requestThreadStarted_ = false;
+  util::SleeperThread requestThread_;
 
   util::JsonParser parser_;
   std::mutex callbackMutex_;
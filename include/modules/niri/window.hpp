@@ -3,9 +3,12 @@
 #include <gtkmm/button.h>
 #include <json/value.h>
 
+#include <optional>
+
 #include "AAppIconLabel.hpp"
 #include "bar.hpp"
 #include "modules/niri/backend.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::niri {
 
@@ -21,8 +24,11 @@ class Window : public AAppIconLabel, public EventHandler {
   void setClass(const std::string &className, bool enable);
 
   const Bar &bar_;
+  util::RewriteRuleSet rewrite_;
 
   std::string oldAppId_;
+  // Generation of the state shown by the module
+  std::optional<uint64_t> generation_;
 };
 
 }  // namespace waybar::modules::niri
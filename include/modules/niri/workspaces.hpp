@@ -3,6 +3,8 @@
 #include <gtkmm/button.h>
 #include <json/value.h>
 
+#include <mutex>
+
 #include "AModule.hpp"
 #include "bar.hpp"
 #include "modules/niri/backend.hpp"
@@ -17,14 +19,21 @@ class Workspaces : public AModule, public EventHandler {
 
  private:
   void onEvent(const Json::Value &ev) override;
+  void onStateChanged(const StateChanges &changes) override;
   void doUpdate();
-  Gtk::Button &addButton(const Json::Value &ws);
-  std::string getIcon(const std::string &value, const Json::Value &ws);
+  bool isShown(const WorkspaceState &ws) const;
+  void updateButton(Gtk::Button &button, const WorkspaceState &ws);
+  Gtk::Button &addButton(const WorkspaceState &ws);
+  std::string getIcon(const std::string &value, const WorkspaceState &ws);
 
   const Bar &bar_;
   Gtk::Box box_;
   // Map from niri workspace id to button.
   std::unordered_map<uint64_t, Gtk::Button> buttons_;
+
+  // Changes received since the last update, guarded by changesMutex_.
+  std::mutex changesMutex_;
+  StateChanges pendingChanges_{.allWorkspaces = true};
 };
 
 }  // namespace waybar::modules::niri
@@ -3,6 +3,7 @@
 #include <fmt/format.h>
 
 #include "ALabel.hpp"
+#include "giomm/cancellable.h"
 #include "giomm/dbusproxy.h"
 
 namespace waybar::modules {
@@ -17,12 +18,12 @@ struct Profile {
 class PowerProfilesDaemon : public ALabel {
  public:
   PowerProfilesDaemon(const std::string &, const Json::Value &);
+  virtual ~PowerProfilesDaemon();
   auto update() -> void override;
   void profileChangedCb(const Gio::DBus::Proxy::MapChangedProperties &,
                         const std::vector<Glib::ustring> &);
-  void busConnectedCb(Glib::RefPtr<Gio::AsyncResult> &r);
-  void getAllPropsCb(Glib::RefPtr<Gio::AsyncResult> &r);
-  void setPropCb(Glib::RefPtr<Gio::AsyncResult> &r);
+  void busConnectedCb(const Glib::RefPtr<Gio::DBus::Proxy> &proxy);
+  void getAllPropsCb(const Glib::VariantContainerBase &reply);
   void populateInitState();
   bool handleToggle(GdkEventButton *const &e) override;
 
@@ -43,6 +44,9 @@ class PowerProfilesDaemon : public ALabel {
   std::string tooltipFormat_;
   // DBus Proxy used to track the current active profile
   Glib::RefPtr<Gio::DBus::Proxy> powerProfilesProxy_;
+  sigc::connection propertiesChanged_;
+  // Cancelled on destruction so late DBus replies don't reach a dead module
+  Glib::RefPtr<Gio::Cancellable> cancellable_;
 };
 
 }  // namespace waybar::modules
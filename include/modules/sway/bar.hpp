@@ -50,10 +50,12 @@ class BarIpcClient {
   bool visible_by_urgency_ = false;
   std::atomic<bool> modifier_no_action_ = false;
 
-  SafeSignal<bool> signal_mode_;
+  // Mode, urgency and config updates carry the whole state, a newer value replaces a pending one.
+  // Visibility updates are edges of the modifier key and must all be delivered.
+  SafeSignal<bool> signal_mode_{SafeSignalMode::LATEST};
   SafeSignal<bool> signal_visible_;
-  SafeSignal<bool> signal_urgency_;
-  SafeSignal<swaybar_config> signal_config_;
+  SafeSignal<bool> signal_urgency_{SafeSignalMode::LATEST};
+  SafeSignal<swaybar_config> signal_config_{SafeSignalMode::LATEST};
 };
 
 }  // namespace modules::sway
@@ -12,6 +12,7 @@
 #include <string>
 
 #include "ipc.hpp"
+#include "util/metrics.hpp"
 #include "util/sleeper_thread.hpp"
 
 namespace waybar::modules::sway {
@@ -48,6 +49,8 @@ class Ipc {
   int fd_event_;
   std::mutex mutex_;
   util::SleeperThread thread_;
+  util::metrics::Histogram *ipc_bytes_;
+  util::metrics::Histogram *ipc_dispatch_;
 };
 
 }  // namespace waybar::modules::sway
@@ -9,6 +9,7 @@
 #include "client.hpp"
 #include "modules/sway/ipc/client.hpp"
 #include "util/json.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::sway {
 
@@ -37,6 +38,7 @@ class Window : public AAppIconLabel, public sigc::trackable {
   std::string shell_;
   int floating_count_;
   util::JsonParser parser_;
+  util::RewriteRuleSet rewrite_;
   std::mutex mutex_;
   Ipc ipc_;
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <giomm/cancellable.h>
 #include <giomm/dbusproxy.h>
 
 #include <string>
@@ -18,13 +19,19 @@ class SystemdFailedUnits : public ALabel {
   bool hide_on_ok;
   std::string format_ok;
 
-  bool update_pending;
+  bool update_pending, reload_pending;
   uint32_t nr_failed_system, nr_failed_user;
   std::string last_status;
   Glib::RefPtr<Gio::DBus::Proxy> system_proxy, user_proxy;
+  sigc::connection system_signal, user_signal, update_timeout;
+  Glib::RefPtr<Gio::Cancellable> cancellable;
 
+  void connectBus(Gio::DBus::BusType bus_type, Glib::RefPtr<Gio::DBus::Proxy> &proxy,
+                  sigc::connection &signal, uint32_t &nr_failed);
   void notify_cb(const Glib::ustring &sender_name, const Glib::ustring &signal_name,
-                 const Glib::VariantContainerBase &arguments);
+                 const Glib::VariantContainerBase &arguments, uint32_t *nr_failed);
+  void scheduleUpdate(bool reload);
+  void load(const Glib::RefPtr<Gio::DBus::Proxy> &proxy, uint32_t &nr_failed);
   void updateData();
 };
 
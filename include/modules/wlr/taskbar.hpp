@@ -20,6 +20,7 @@
 #include "client.hpp"
 #include "giomm/desktopappinfo.h"
 #include "util/json.hpp"
+#include "util/rewrite_string.hpp"
 #include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
 
 namespace waybar::modules::wlr {
@@ -79,6 +80,8 @@ class Task {
   std::string title_;
   std::string app_id_;
   uint32_t state_ = 0;
+  // Labels and tooltip need to be regenerated on the next update()
+  bool dirty_ = true;
 
   int32_t drag_start_x;
   int32_t drag_start_y;
@@ -104,6 +107,7 @@ class Task {
   bool minimized() const { return state_ & MINIMIZED; }
   bool active() const { return state_ & ACTIVE; }
   bool fullscreen() const { return state_ & FULLSCREEN; }
+  bool dirty() const { return dirty_; }
 
  public:
   /* Callbacks for the wlr protocol */
@@ -156,9 +160,11 @@ class Taskbar : public waybar::AModule {
   std::vector<Glib::RefPtr<Gtk::IconTheme>> icon_themes_;
   std::unordered_set<std::string> ignore_list_;
   std::map<std::string, std::string> app_ids_replace_map_;
+  util::RewriteRuleSet rewrite_;
 
   struct zwlr_foreign_toplevel_manager_v1 *manager_;
   struct wl_seat *seat_;
+  std::vector<int> global_subscriptions_;
 
  public:
   /* Callbacks for global registration */
@@ -172,6 +178,7 @@ class Taskbar : public waybar::AModule {
  public:
   void add_button(Gtk::Button &);
   void move_button(Gtk::Button &, int);
+  void sort_buttons();
   void remove_button(Gtk::Button &);
   void remove_task(uint32_t);
 
@@ -181,6 +188,7 @@ class Taskbar : public waybar::AModule {
   const std::vector<Glib::RefPtr<Gtk::IconTheme>> &icon_themes() const;
   const std::unordered_set<std::string> &ignore_list() const;
   const std::map<std::string, std::string> &app_ids_replace_map() const;
+  util::RewriteRuleSet &rewrite_rules();
 };
 
 } /* namespace waybar::modules::wlr */
@@ -158,6 +158,7 @@ class WorkspaceManager : public AModule {
 
   // wlr stuff
   zext_workspace_manager_v1 *workspace_manager_ = nullptr;
+  int registry_listener_ = -1;
 
   static uint32_t group_global_id;
 
@@ -1,7 +1,11 @@
 #include "ext-workspace-unstable-v1-client-protocol.h"
 
 namespace waybar::modules::wlr {
-void add_registry_listener(void *data);
+class WorkspaceManager;
+
+// Subscribes to the workspace manager global on the shared registry, returns the subscription id
+int add_registry_listener(WorkspaceManager *workspace_manager);
+void remove_registry_listener(int id);
 void add_workspace_listener(zext_workspace_handle_v1 *workspace_handle, void *data);
 void add_workspace_group_listener(zext_workspace_group_handle_v1 *workspace_group_handle,
                                   void *data);
@@ -3,9 +3,9 @@
 #include <glibmm/dispatcher.h>
 #include <sigc++/signal.h>
 
+#include <atomic>
 #include <functional>
-#include <mutex>
-#include <queue>
+#include <memory>
 #include <thread>
 #include <tuple>
 #include <type_traits>
@@ -13,14 +13,31 @@
 
 namespace waybar {
 
+/// How SafeSignal delivers the events emitted from other threads
+enum class SafeSignalMode {
+  // Every event, in the order each thread emitted them
+  QUEUE,
+  // Only the newest pending event, for signals that carry a state rather than a change
+  LATEST,
+};
+
 /**
  * Thread-safe signal wrapper.
- * Uses Glib::Dispatcher to pass events to another thread and locked queue to pass the arguments.
+ * Uses Glib::Dispatcher to pass events to another thread and a lock-free list to pass the
+ * arguments. Producers push with a single atomic operation and only wake the main loop when the
+ * list was empty, the main thread takes the whole list at once and moves the arguments out.
  */
 template <typename... Args>
 struct SafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
  public:
-  SafeSignal() { dp_.connect(sigc::mem_fun(*this, &SafeSignal::handle_event)); }
+  explicit SafeSignal(SafeSignalMode mode = SafeSignalMode::QUEUE) : mode_(mode) {
+    dp_.connect(sigc::mem_fun(*this, &SafeSignal::handle_event));
+  }
+
+  ~SafeSignal() {
+    delete_list(head_.exchange(nullptr, std::memory_order_acquire));
+    delete latest_.exchange(nullptr, std::memory_order_acquire);
+  }
 
   template <typename... EmitArgs>
   void emit(EmitArgs&&... args) {
@@ -32,12 +49,32 @@ struct SafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
        * As a downside, this makes main thread events prioritized over the other threads and
        * disrupts chronological order.
        */
+      if (mode_ == SafeSignalMode::LATEST) {
+        // A pending value from another thread is older than this one
+        delete latest_.exchange(nullptr, std::memory_order_acquire);
+      }
       signal_t::emit(std::forward<EmitArgs>(args)...);
-    } else {
-      {
-        std::unique_lock lock(mutex_);
-        queue_.emplace(std::forward<EmitArgs>(args)...);
+      return;
+    }
+
+    auto* node = new Node{arg_tuple_t(std::forward<EmitArgs>(args)...), nullptr};
+    if (mode_ == SafeSignalMode::LATEST) {
+      auto* previous = latest_.exchange(node, std::memory_order_acq_rel);
+      if (previous == nullptr) {
+        dp_.emit();
+      } else {
+        // Superseded before the main loop picked it up, a wakeup is already pending
+        delete previous;
       }
+      return;
+    }
+
+    auto* head = head_.load(std::memory_order_relaxed);
+    do {
+      node->next = head;
+    } while (!head_.compare_exchange_weak(head, node, std::memory_order_release,
+                                          std::memory_order_relaxed));
+    if (head == nullptr) {
       dp_.emit();
     }
   }
@@ -55,18 +92,50 @@ struct SafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
   using signal_t::emit_reverse;
   using signal_t::make_slot;
 
+  struct Node {
+    arg_tuple_t args;
+    Node* next;
+  };
+
+  static void delete_list(Node* node) {
+    while (node != nullptr) {
+      delete std::exchange(node, node->next);
+    }
+  }
+
   void handle_event() {
-    for (std::unique_lock lock(mutex_); !queue_.empty(); lock.lock()) {
-      auto args = queue_.front();
-      queue_.pop();
-      lock.unlock();
-      std::apply(cached_fn_, args);
+    if (mode_ == SafeSignalMode::LATEST) {
+      if (auto* node = latest_.exchange(nullptr, std::memory_order_acquire)) {
+        std::unique_ptr<Node> guard(node);
+        std::apply(cached_fn_, std::move(node->args));
+      }
+      return;
+    }
+
+    // The list is in reverse emission order
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+    Node* ordered = nullptr;
+    while (node != nullptr) {
+      ordered = std::exchange(node, std::exchange(node->next, ordered));
+    }
+
+    try {
+      while (ordered != nullptr) {
+        std::unique_ptr<Node> current(std::exchange(ordered, ordered->next));
+        std::apply(cached_fn_, std::move(current->args));
+      }
+    } catch (...) {
+      delete_list(ordered);
+      throw;
     }
   }
 
+  const SafeSignalMode mode_;
   Glib::Dispatcher dp_;
-  std::mutex mutex_;
-  std::queue<arg_tuple_t> queue_;
+  // Last pushed node of the list in QUEUE mode, nullptr when empty
+  std::atomic<Node*> head_ = nullptr;
+  // Pending node in LATEST mode
+  std::atomic<Node*> latest_ = nullptr;
   const std::thread::id main_tid_ = std::this_thread::get_id();
   // cache functor for signal emission to avoid recreating it on each event
   const slot_t cached_fn_ = make_slot();
@@ -10,6 +10,7 @@
 #include <string_view>
 #include <vector>
 
+#include "giomm/cancellable.h"
 #include "giomm/dbusproxy.h"
 #include "util/backend_common.hpp"
 #include "util/sleeper_thread.hpp"
@@ -50,6 +51,7 @@ class BacklightDevice {
 class BacklightBackend {
  public:
   BacklightBackend(std::chrono::milliseconds interval, std::function<void()> on_updated_cb = NOOP);
+  ~BacklightBackend();
 
   // const inline BacklightDevice *get_best_device(std::string_view preferred_device);
   const BacklightDevice *get_previous_best_device();
@@ -79,7 +81,9 @@ class BacklightBackend {
   // thread must destruct before shared data
   util::SleeperThread udev_thread_;
 
+  // Set once the asynchronous proxy creation finished
   Glib::RefPtr<Gio::DBus::Proxy> login_proxy_;
+  Glib::RefPtr<Gio::Cancellable> login_cancellable_;
 
   static constexpr int EPOLL_MAX_EVENTS = 16;
 };
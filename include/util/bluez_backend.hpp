@@ -0,0 +1,108 @@
+#pragma once
+
+#include <gio/gio.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace waybar::util {
+
+/**
+ * Process-wide cache of the BlueZ object tree.
+ *
+ * The object manager is created asynchronously once and shared by every bluetooth module
+ * instance. Controller and device records are kept up to date from the manager's signals, and
+ * subscribers are told which object changed instead of re-walking all objects.
+ * Everything runs on the GLib main context, so no locking is needed.
+ */
+class BluezBackend {
+ public:
+  struct ControllerInfo {
+    std::string path;
+    std::string address;
+    std::string address_type;
+    // std::string name; // just use alias instead
+    std::string alias;
+    bool powered{false};
+    bool discoverable{false};
+    bool pairable{false};
+    bool discovering{false};
+  };
+
+  // NOTE: there are some properties that not all devices provide
+  struct DeviceInfo {
+    std::string path;
+    std::string paired_controller;
+    std::string address;
+    std::string address_type;
+    // std::optional<std::string> name; // just use alias instead
+    std::string alias;
+    std::optional<std::string> icon;
+    bool paired{false};
+    bool trusted{false};
+    bool blocked{false};
+    bool connected{false};
+    bool services_resolved{false};
+    // NOTE: experimental feature in bluez
+    std::optional<unsigned char> battery_percentage;
+  };
+
+  enum class Change {
+    READY,  // initial object tree was loaded
+    CONTROLLER_ADDED,
+    CONTROLLER_CHANGED,
+    CONTROLLER_REMOVED,
+    DEVICE_CHANGED,  // also sent for new devices
+    DEVICE_REMOVED,
+  };
+  // `path` is the object path of the controller or device, empty for READY
+  using Callback = std::function<void(Change, const std::string& path)>;
+
+  /* Hack to keep constructor inaccessible but still public.
+   * This is required to be able to use std::make_shared.
+   */
+  struct private_constructor_tag {};
+
+  /// Returns the shared cache, creating it on first use
+  static std::shared_ptr<BluezBackend> getInstance();
+
+  explicit BluezBackend(private_constructor_tag tag);
+  ~BluezBackend();
+
+  bool ready() const { return manager_ != nullptr; }
+  const std::map<std::string, ControllerInfo>& controllers() const { return controllers_; }
+  const std::map<std::string, DeviceInfo>& devices() const { return devices_; }
+  const ControllerInfo* controller(const std::string& path) const;
+  const DeviceInfo* device(const std::string& path) const;
+
+  int subscribe(Callback cb);
+  void unsubscribe(int id);
+
+ private:
+  static void onManagerReady(GObject*, GAsyncResult*, gpointer);
+  static void onObjectAdded(GDBusObjectManager*, GDBusObject*, gpointer);
+  static void onObjectRemoved(GDBusObjectManager*, GDBusObject*, gpointer);
+  static void onInterfaceAdded(GDBusObjectManager*, GDBusObject*, GDBusInterface*, gpointer);
+  static void onInterfaceRemoved(GDBusObjectManager*, GDBusObject*, GDBusInterface*, gpointer);
+  static void onInterfaceProxyPropertiesChanged(GDBusObjectManagerClient*, GDBusObjectProxy*,
+                                                GDBusProxy*, GVariant*, const gchar* const*,
+                                                gpointer);
+
+  // Reads every known interface of `object` into the cache and notifies subscribers
+  void loadObject(GDBusObject* object);
+  void notify(Change change, const std::string& path);
+
+  GCancellable* cancellable_;
+  GDBusObjectManager* manager_ = nullptr;
+
+  std::map<std::string, ControllerInfo> controllers_;
+  std::map<std::string, DeviceInfo> devices_;
+
+  std::map<int, Callback> subscribers_;
+  int next_subscriber_id_{0};
+};
+
+}  // namespace waybar::util
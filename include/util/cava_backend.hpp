@@ -0,0 +1,103 @@
+#pragma once
+
+#include <json/json.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "util/sleeper_thread.hpp"
+
+namespace cava {
+extern "C" {
+#include <cava/common.h>
+}
+}  // namespace cava
+
+namespace waybar::util {
+
+/**
+ * Shared cava engine.
+ *
+ * Captures audio once and runs the FFT on a dedicated worker thread. The resulting bar heights are
+ * published through a seqlock-protected snapshot, so any number of module instances (one per
+ * output) can read the latest frame from the main thread without blocking the worker.
+ */
+class CavaBackend {
+ public:
+  /// Copy of a published frame. Reusable across reads to avoid allocations.
+  struct Frame {
+    uint64_t generation{0};
+    bool silent{false};
+    std::vector<int> bars;
+  };
+
+  /* Hack to keep constructor inaccessible but still public.
+   * This is required to be able to use std::make_shared.
+   */
+  struct private_constructor_tag {};
+
+  /// Returns the engine for the given module configuration, creating it on first use.
+  static std::shared_ptr<CavaBackend> getInstance(const Json::Value& config);
+
+  CavaBackend(const Json::Value& config, private_constructor_tag tag);
+  ~CavaBackend();
+
+  /**
+   * Copies the latest frame into `frame`.
+   * Returns false and leaves `frame` untouched if nothing was published since the last read.
+   */
+  bool readFrame(Frame& frame) const;
+
+  /// Registers a callback invoked from the worker thread after each published frame.
+  int subscribe(std::function<void()> cb);
+  void unsubscribe(int id);
+
+  /// Number of levels per bar used when rendering as a graph instead of icons
+  static constexpr int GRAPH_RANGE = 100;
+
+  int getAsciiRange() const { return prm_.ascii_range; }
+  int getBarsCount() const { return frame_size_; }
+  int getBarDelimiter() const { return prm_.bar_delim; }
+  void pauseResume();
+
+ private:
+  void process();
+  void publish(bool silent);
+  void notify();
+
+  util::SleeperThread thread_;
+  util::SleeperThread thread_fetch_input_;
+
+  struct cava::error_s error_ {};          // cava errors
+  struct cava::config_params prm_ {};      // cava parameters
+  struct cava::audio_raw audio_raw_ {};    // cava handled raw audio data(is based on audio_data)
+  struct cava::audio_data audio_data_ {};  // cava audio data
+  struct cava::cava_plan* plan_;           //{new cava_plan{}};
+  // Cava API to read audio source
+  cava::ptr input_source_;
+  // Delay to handle audio source
+  std::chrono::milliseconds frame_time_milsec_{1000};
+  int rePaint_{1};
+  std::chrono::seconds fetch_input_delay_{4};
+  std::chrono::seconds suspend_silence_delay_{0};
+  bool silence_{false};
+  int sleep_counter_{0};
+
+  // Published frame. Odd sequence means the worker is writing it.
+  std::atomic<uint64_t> seq_{0};
+  std::atomic<bool> frame_silent_{false};
+  std::unique_ptr<std::atomic<int>[]> frame_bars_;
+  int frame_size_{0};
+
+  std::mutex subscribers_mutex_;
+  std::map<int, std::function<void()>> subscribers_;
+  int next_subscriber_id_{0};
+};
+
+}  // namespace waybar::util
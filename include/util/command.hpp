@@ -66,9 +66,12 @@ inline int close(FILE* fp, pid_t pid) {
   return stat;
 }
 
-inline FILE* open(const std::string& cmd, int& pid, const std::string& output_name) {
+// If `input` is set, the command's stdin is connected to a pipe whose write end is stored there
+inline FILE* open(const std::string& cmd, int& pid, const std::string& output_name,
+                  int* input = nullptr) {
   if (cmd == "") return nullptr;
   int fd[2];
+  int in_fd[2] = {-1, -1};
   // Open the pipe with the close-on-exec flag set, so it will not be inherited
   // by any other subprocesses launched by other threads (which could result in
   // the pipe staying open after this child dies, causing us to hang when trying
@@ -77,6 +80,12 @@ inline FILE* open(const std::string& cmd, int& pid, const std::string& output_na
     spdlog::error("Unable to pipe fd");
     return nullptr;
   }
+  if (input != nullptr && pipe2(in_fd, O_CLOEXEC) != 0) {
+    spdlog::error("Unable to pipe fd");
+    ::close(fd[0]);
+    ::close(fd[1]);
+    return nullptr;
+  }
 
   pid_t child_pid = fork();
 
@@ -84,6 +93,10 @@ inline FILE* open(const std::string& cmd, int& pid, const std::string& output_na
     spdlog::error("Unable to exec cmd {}, error {}", cmd.c_str(), strerror(errno));
     ::close(fd[0]);
     ::close(fd[1]);
+    if (input != nullptr) {
+      ::close(in_fd[0]);
+      ::close(in_fd[1]);
+    }
     return nullptr;
   }
 
@@ -108,6 +121,9 @@ inline FILE* open(const std::string& cmd, int& pid, const std::string& output_na
 #endif
     ::close(fd[0]);
     dup2(fd[1], 1);
+    if (input != nullptr) {
+      dup2(in_fd[0], 0);
+    }
     setpgid(child_pid, child_pid);
     if (output_name != "") {
       setenv("WAYBAR_OUTPUT_NAME", output_name.c_str(), 1);
@@ -116,6 +132,10 @@ inline FILE* open(const std::string& cmd, int& pid, const std::string& output_na
     exit(0);
   } else {
     ::close(fd[1]);
+    if (input != nullptr) {
+      ::close(in_fd[0]);
+      *input = in_fd[1];
+    }
   }
   pid = child_pid;
   return fdopen(fd[0], "r");
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <giomm/cancellable.h>
+#include <giomm/dbusconnection.h>
+#include <giomm/dbusproxy.h>
+#include <glibmm/ustring.h>
+#include <glibmm/variant.h>
+
+#include <functional>
+#include <optional>
+
+/**
+ * Asynchronous wrappers around Gio's DBus API, so modules never stall the GTK main loop on a slow
+ * bus peer.
+ *
+ * Callbacks run on the main context. Once `cancellable` is cancelled they are dropped instead of
+ * called, so a module only has to cancel it in its destructor to outlive pending replies.
+ * Failures are logged; callbacks of calls that failed are not invoked.
+ */
+namespace waybar::util::dbus {
+
+using ConnectionReady = std::function<void(const Glib::RefPtr<Gio::DBus::Connection>&)>;
+using ProxyReady = std::function<void(const Glib::RefPtr<Gio::DBus::Proxy>&)>;
+using CallReady = std::function<void(const Glib::VariantContainerBase&)>;
+using PropertyReady = std::function<void(const Glib::VariantBase&)>;
+
+void getConnection(Gio::DBus::BusType bus_type, const Glib::RefPtr<Gio::Cancellable>& cancellable,
+                   ConnectionReady ready);
+
+void createProxy(Gio::DBus::BusType bus_type, const Glib::ustring& name,
+                 const Glib::ustring& object_path, const Glib::ustring& interface_name,
+                 const Glib::RefPtr<Gio::Cancellable>& cancellable, ProxyReady ready);
+
+void call(const Glib::RefPtr<Gio::DBus::Proxy>& proxy, const Glib::ustring& method,
+          const Glib::VariantContainerBase& parameters,
+          const Glib::RefPtr<Gio::Cancellable>& cancellable, CallReady ready = {});
+
+// `proxy` must be bound to the org.freedesktop.DBus.Properties interface
+void getProperty(const Glib::RefPtr<Gio::DBus::Proxy>& proxy, const Glib::ustring& interface_name,
+                 const Glib::ustring& property, const Glib::RefPtr<Gio::Cancellable>& cancellable,
+                 PropertyReady ready);
+
+// Returns the new value of `property` if it is part of a PropertiesChanged signal's parameters
+std::optional<Glib::VariantBase> changedProperty(const Glib::VariantContainerBase& parameters,
+                                                 const Glib::ustring& property);
+
+}  // namespace waybar::util::dbus
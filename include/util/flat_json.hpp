@@ -0,0 +1,48 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace waybar::util {
+
+struct FlatJsonValue {
+  enum class Type { NUL, BOOL, NUMBER, STRING, STRING_ARRAY };
+
+  Type type{Type::NUL};
+  bool boolean{false};
+  double number{0};
+  std::string string;
+  std::vector<std::string> strings;
+};
+
+struct FlatJsonMember {
+  std::string key;
+  FlatJsonValue value;
+};
+
+/**
+ * Lightweight reader for single-level JSON objects, such as the lines printed by custom module
+ * scripts.
+ *
+ * Members may hold strings, numbers, booleans, null or arrays of strings. Anything nested is
+ * rejected. Like JsonParser, "\x" escapes are accepted as a shorthand for "\u00". Storage is
+ * reused between lines, so a long-running producer doesn't allocate once its lines stop growing.
+ */
+class FlatJsonReader {
+ public:
+  /// Returns false if `line` is not a flat JSON object; members() is unspecified then
+  bool parse(std::string_view line);
+
+  /// Members of the last parsed object, in input order
+  std::span<const FlatJsonMember> members() const { return {members_.data(), size_}; }
+
+ private:
+  FlatJsonMember& nextMember();
+
+  std::vector<FlatJsonMember> members_;
+  size_t size_{0};
+};
+
+}  // namespace waybar::util
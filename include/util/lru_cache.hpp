@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace waybar::util {
+
+/**
+ * Bounded least-recently-used cache.
+ * Lookups move the entry to the front, inserting into a full cache evicts the oldest entry.
+ * The capacity must be at least 1, insert() always keeps the entry it returns.
+ * Not thread-safe.
+ */
+template <typename Key, typename Value>
+class LruCache {
+ public:
+  explicit LruCache(std::size_t capacity) : capacity_(capacity) {
+    if (capacity_ == 0) {
+      throw std::invalid_argument("LruCache capacity must be at least 1");
+    }
+  }
+
+  // The index points into items_, so copies have to rebuild it
+  LruCache(const LruCache& other) : capacity_(other.capacity_), items_(other.items_) {
+    for (auto it = items_.begin(); it != items_.end(); ++it) index_.emplace(it->first, it);
+  }
+  LruCache(LruCache&&) noexcept = default;
+  LruCache& operator=(const LruCache& other) {
+    if (this != &other) *this = LruCache(other);
+    return *this;
+  }
+  LruCache& operator=(LruCache&&) noexcept = default;
+
+  /// Returns the cached value or nullptr. The pointer is valid until the next insert().
+  Value* find(const Key& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    items_.splice(items_.begin(), items_, it->second);
+    return &it->second->second;
+  }
+
+  Value& insert(const Key& key, Value value) {
+    if (auto it = index_.find(key); it != index_.end()) {
+      it->second->second = std::move(value);
+      items_.splice(items_.begin(), items_, it->second);
+      return it->second->second;
+    }
+    if (items_.size() >= capacity_) {
+      index_.erase(items_.back().first);
+      items_.pop_back();
+    }
+    items_.emplace_front(key, std::move(value));
+    index_.emplace(key, items_.begin());
+    return items_.front().second;
+  }
+
+  void clear() {
+    index_.clear();
+    items_.clear();
+  }
+
+  std::size_t size() const { return items_.size(); }
+  std::size_t capacity() const { return capacity_; }
+
+ private:
+  std::size_t capacity_;
+  std::list<std::pair<Key, Value>> items_;
+  std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator> index_;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <json/json.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * Opt-in instrumentation (`waybar --metrics`).
+ *
+ * Modules and backends record counts and latency/size histograms under their name. While
+ * disabled, histogram() returns nullptr and the recording helpers only test that pointer.
+ * Recording is lock-free and may happen from any thread.
+ */
+namespace waybar::util::metrics {
+
+namespace detail {
+extern std::atomic<bool> enabled;
+}
+
+inline bool enabled() { return detail::enabled.load(std::memory_order_relaxed); }
+void setEnabled(bool enabled);
+
+/// Monotonic time in microseconds
+inline int64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// Histogram with power of two buckets, bucket i counts values below 2^i
+class Histogram {
+ public:
+  static constexpr size_t BUCKETS = 40;
+
+  void record(int64_t value);
+  Json::Value toJson() const;
+
+ private:
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> min_{UINT64_MAX};
+  std::atomic<uint64_t> max_{0};
+  std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+};
+
+/**
+ * Returns the histogram `metric` of `module`, creating it on first use.
+ * Returns nullptr while instrumentation is disabled. Histograms are never freed, so callers
+ * may keep the pointer.
+ */
+Histogram* histogram(const std::string& module, const std::string& metric);
+
+/// Records the lifetime of the scope in microseconds, if `histogram` is set
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(Histogram* histogram)
+      : histogram_(histogram), start_(histogram != nullptr ? nowUs() : 0) {}
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+  ~ScopedTimer() {
+    if (histogram_ != nullptr) {
+      histogram_->record(nowUs() - start_);
+    }
+  }
+
+ private:
+  Histogram* histogram_;
+  int64_t start_;
+};
+
+/// All histograms as {"<module>": {"<metric>": {...}}}
+Json::Value toJson();
+
+/// Writes toJson() to `path`, returns false if the file couldn't be written
+bool dump(const std::string& path);
+
+}  // namespace waybar::util::metrics
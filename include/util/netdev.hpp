@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string_view>
+#include <utility>
+
+namespace waybar::util {
+
+/**
+ * Scans the contents of /proc/net/dev for `ifname` and returns its received and transmitted byte
+ * counters. Returns zeros if the interface isn't listed. Doesn't allocate.
+ */
+std::pair<unsigned long long, unsigned long long> parseNetdevBytes(std::string_view netdev,
+                                                                   std::string_view ifname);
+
+}  // namespace waybar::util
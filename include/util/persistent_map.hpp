@@ -0,0 +1,155 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace waybar::util {
+
+/**
+ * Immutable map from integer ids to values with structural sharing.
+ * Copies share every node and cost a pointer copy. set() and erase() only copy the nodes on the
+ * path to the entry (a 32-way trie on the key bits, so a handful of nodes), the other copies keep
+ * seeing the previous content. Not thread-safe, but nodes are never modified once shared, so each
+ * thread may use its own copy.
+ */
+template <typename Value>
+class PersistentMap {
+ public:
+  const Value* find(uint64_t key) const {
+    const Node* node = root_.get();
+    for (unsigned shift = 0; node != nullptr; shift += BITS) {
+      if (node->value) return node->key == key ? &*node->value : nullptr;
+      const auto bit = slot(key, shift);
+      if ((node->bitmap & bit) == 0) return nullptr;
+      node = node->children[index(node->bitmap, bit)].get();
+    }
+    return nullptr;
+  }
+
+  bool contains(uint64_t key) const { return find(key) != nullptr; }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  void set(uint64_t key, Value value) {
+    bool added = false;
+    root_ = insert(root_, key, std::move(value), 0, added);
+    if (added) ++size_;
+  }
+
+  /// Returns false if the key wasn't present
+  bool erase(uint64_t key) {
+    if (!root_) return false;
+    bool removed = false;
+    root_ = remove(root_, key, 0, removed);
+    if (removed) --size_;
+    return removed;
+  }
+
+  /// Calls `fn(key, value)` for every entry, in no particular order
+  template <typename Fn>
+  void forEach(Fn&& fn) const {
+    visit(root_.get(), fn);
+  }
+
+ private:
+  static constexpr unsigned BITS = 5;
+
+  struct Node;
+  using NodePtr = std::shared_ptr<const Node>;
+
+  // A leaf holds a value, a branch one child per bit set in `bitmap`, in bit order
+  struct Node {
+    uint32_t bitmap = 0;
+    std::vector<NodePtr> children;
+    uint64_t key = 0;
+    std::optional<Value> value;
+  };
+
+  static uint32_t slot(uint64_t key, unsigned shift) {
+    return uint32_t{1} << ((key >> shift) & ((1u << BITS) - 1));
+  }
+  static std::size_t index(uint32_t bitmap, uint32_t bit) {
+    return std::popcount(bitmap & (bit - 1));
+  }
+
+  static NodePtr leaf(uint64_t key, Value&& value) {
+    auto node = std::make_shared<Node>();
+    node->key = key;
+    node->value.emplace(std::move(value));
+    return node;
+  }
+
+  static NodePtr insert(const NodePtr& node, uint64_t key, Value&& value, unsigned shift,
+                        bool& added) {
+    if (!node) {
+      added = true;
+      return leaf(key, std::move(value));
+    }
+    if (node->value) {
+      if (node->key == key) return leaf(key, std::move(value));
+      // Two keys share the path so far, push the existing leaf one level down
+      auto branch = std::make_shared<Node>();
+      branch->bitmap = slot(node->key, shift);
+      branch->children.push_back(node);
+      return insert(branch, key, std::move(value), shift, added);
+    }
+
+    const auto bit = slot(key, shift);
+    const auto i = index(node->bitmap, bit);
+    auto copy = std::make_shared<Node>(*node);
+    if ((node->bitmap & bit) != 0) {
+      copy->children[i] = insert(node->children[i], key, std::move(value), shift + BITS, added);
+    } else {
+      copy->bitmap |= bit;
+      copy->children.insert(copy->children.begin() + i, leaf(key, std::move(value)));
+      added = true;
+    }
+    return copy;
+  }
+
+  static NodePtr remove(const NodePtr& node, uint64_t key, unsigned shift, bool& removed) {
+    if (node->value) {
+      if (node->key != key) return node;
+      removed = true;
+      return nullptr;
+    }
+
+    const auto bit = slot(key, shift);
+    if ((node->bitmap & bit) == 0) return node;
+    const auto i = index(node->bitmap, bit);
+    auto child = remove(node->children[i], key, shift + BITS, removed);
+    if (!removed) return node;
+
+    auto copy = std::make_shared<Node>(*node);
+    if (child) {
+      copy->children[i] = std::move(child);
+    } else {
+      copy->bitmap &= ~bit;
+      copy->children.erase(copy->children.begin() + i);
+    }
+    if (copy->children.empty()) return nullptr;
+    // A lone leaf is found by its key at any depth, so it replaces its branch
+    if (copy->children.size() == 1 && copy->children.front()->value) return copy->children.front();
+    return copy;
+  }
+
+  template <typename Fn>
+  static void visit(const Node* node, Fn& fn) {
+    if (node == nullptr) return;
+    if (node->value) {
+      fn(node->key, *node->value);
+      return;
+    }
+    for (const auto& child : node->children) visit(child.get(), fn);
+  }
+
+  NodePtr root_;
+  std::size_t size_ = 0;
+};
+
+}  // namespace waybar::util
@@ -2,10 +2,14 @@
 
 #include <json/json.h>
 
+#include <cstddef>
 #include <functional>
 #include <regex>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include "util/lru_cache.hpp"
 
 namespace waybar::util {
 
@@ -13,39 +17,69 @@ struct Rule {
   std::regex rule;
   std::string repr;
   int priority;
+  // Lowercase substring every match must contain. Empty if the pattern has no usable literal.
+  std::string literal;
 
   // Fix for Clang < 16
   // See https://en.cppreference.com/w/cpp/compiler_support/20 "Parenthesized initialization of
   // aggregates"
-  Rule(std::regex rule, std::string repr, int priority)
-      : rule(std::move(rule)), repr(std::move(repr)), priority(priority) {}
+  Rule(std::regex rule, std::string repr, int priority, std::string literal = "")
+      : rule(std::move(rule)),
+        repr(std::move(repr)),
+        priority(priority),
+        literal(std::move(literal)) {}
 };
 
 int default_priority_function(std::string& key);
 
+/* Returns the longest run of literal characters that any match of the ECMAScript pattern has to
+ * contain, lowercased. Returns an empty string when no such run can be determined cheaply
+ * (e.g. alternations).
+ */
+std::string required_literal(const std::string& pattern);
+
 /* A collection of regexes and strings, with a default string to return if no regexes.
  * When a regex is matched, the corresponding string is returned.
- * All regexes that are matched are cached, so that the regexes are only
- * evaluated once against a given string.
+ * Results are kept in a bounded LRU cache, so that the regexes are only
+ * evaluated once against recently seen strings.
  * Regexes may be given a higher priority than others, so that they are matched
  * first. The priority function is given the regex string, and should return a
  * higher number for higher priority regexes.
+ * Before running a regex, the string is checked for the literal part of the rule,
+ * which skips most non-matching rules without entering the regex engine.
  */
 class RegexCollection {
+ public:
+  static constexpr std::size_t DEFAULT_CACHE_SIZE = 512;
+
  private:
+  struct CacheEntry {
+    std::string repr;
+    bool matched_any;
+  };
+
   std::vector<Rule> rules;
-  std::map<std::string, std::string> regex_cache;
+  LruCache<std::string, CacheEntry> regex_cache{DEFAULT_CACHE_SIZE};
   std::string default_repr;
+  std::size_t cache_hits = 0;
+  std::size_t cache_misses = 0;
 
   std::string find_match(std::string& value, bool& matched_any);
+  void log_stats() const;
 
  public:
   RegexCollection() = default;
   RegexCollection(
       const Json::Value& map, std::string default_repr = "",
-      const std::function<int(std::string&)>& priority_function = default_priority_function);
-  ~RegexCollection() = default;
+      const std::function<int(std::string&)>& priority_function = default_priority_function,
+      std::size_t cache_size = DEFAULT_CACHE_SIZE);
+  ~RegexCollection();
+  RegexCollection(const RegexCollection&) = default;
+  RegexCollection(RegexCollection&&) = default;
+  RegexCollection& operator=(const RegexCollection&) = default;
+  RegexCollection& operator=(RegexCollection&&) = default;
 
+  // The returned reference stays valid until the next call to get()
   std::string& get(std::string& value, bool& matched_any);
   std::string& get(std::string& value);
 };
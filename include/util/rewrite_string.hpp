@@ -1,10 +1,42 @@
 #pragma once
 #include <json/json.h>
 
+#include <regex>
 #include <string>
+#include <vector>
+
+#include "util/lru_cache.hpp"
 
 namespace waybar::util {
 std::string rewriteString(const std::string&, const Json::Value&);
 std::string rewriteStringOnce(const std::string& value, const Json::Value& rules,
                               bool& matched_any);
+
+/**
+ * Rewrite rules compiled once from the "rewrite" config object.
+ * Rewritten strings are kept in a bounded LRU cache, so repeated titles skip the regexes entirely.
+ */
+class RewriteRuleSet {
+ public:
+  static constexpr std::size_t DEFAULT_CACHE_SIZE = 128;
+
+  RewriteRuleSet() = default;
+  /// Throws std::invalid_argument if `cache_size` is 0
+  explicit RewriteRuleSet(const Json::Value& rules, std::size_t cache_size = DEFAULT_CACHE_SIZE);
+
+  /// Applies every rule matching the whole `value` in config order
+  std::string apply(const std::string& value);
+  bool empty() const { return rules_.empty(); }
+
+ private:
+  struct Rule {
+    std::regex regex;
+    std::string replacement;
+  };
+
+  std::string rewrite(const std::string& value) const;
+
+  std::vector<Rule> rules_;
+  LruCache<std::string, std::string> cache_{DEFAULT_CACHE_SIZE};
+};
 }  // namespace waybar::util
@@ -106,14 +106,19 @@ class SleeperThread {
     }
   }
 
-  ~SleeperThread() {
-    connection_.disconnect();
-    stop();
+  // Waits for the thread to exit after stop(), so its owner can release what the thread uses
+  void join() {
     if (thread_.joinable()) {
       thread_.join();
     }
   }
 
+  ~SleeperThread() {
+    connection_.disconnect();
+    stop();
+    join();
+  }
+
  private:
   std::thread thread_;
   std::condition_variable condvar_;
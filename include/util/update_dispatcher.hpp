@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace waybar::util {
+
+class UpdateQueue;
+
+/**
+ * Requests an update of a module from any thread.
+ *
+ * Emits are collapsed while the update is pending. The pending updates of all modules run in a
+ * single main loop iteration, woken through one process-wide Glib::Dispatcher instead of a pipe
+ * per module. Must be created and destroyed on the main thread.
+ */
+class UpdateDispatcher {
+ public:
+  UpdateDispatcher();
+  ~UpdateDispatcher();
+  UpdateDispatcher(const UpdateDispatcher&) = delete;
+  UpdateDispatcher& operator=(const UpdateDispatcher&) = delete;
+
+  void connect(std::function<void()> slot) { slot_ = std::move(slot); }
+
+  void emit();
+  void operator()() { emit(); }
+
+  /// Returns the time of the oldest emit() since the last call, 0 if unknown
+  int64_t takeRequestTime() { return requested_.exchange(0, std::memory_order_relaxed); }
+
+ private:
+  friend class UpdateQueue;
+
+  std::function<void()> slot_;
+  std::atomic<bool> pending_{false};
+  std::atomic<int64_t> requested_{0};
+};
+
+}  // namespace waybar::util
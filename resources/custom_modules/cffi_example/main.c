@@ -5,6 +5,7 @@ typedef struct {
   wbcffi_module* waybar_module;
   GtkBox* container;
   GtkButton* button;
+  GtkLabel* uptime;
 } ExampleMod;
 
 // This static variable is shared between all instances of this module
@@ -16,8 +17,16 @@ void onclicked(GtkButton* button) {
   gtk_button_set_label(button, text);
 }
 
+// Called once per second by Waybar's shared scheduler, no thread needed
+void ontick(void* instance, uint64_t tick) {
+  ExampleMod* inst = instance;
+  char text[64];
+  snprintf(text, 64, " up %lus", (unsigned long)tick);
+  gtk_label_set_text(inst->uptime, text);
+}
+
 // You must
-const size_t wbcffi_version = 1;
+const size_t wbcffi_version = 2;
 
 void* wbcffi_init(const wbcffi_init_info* init_info, const wbcffi_config_entry* config_entries,
                   size_t config_entries_len) {
@@ -45,6 +54,11 @@ void* wbcffi_init(const wbcffi_init_info* init_info, const wbcffi_config_entry*
   g_signal_connect(inst->button, "clicked", G_CALLBACK(onclicked), NULL);
   gtk_container_add(GTK_CONTAINER(inst->container), GTK_WIDGET(inst->button));
 
+  // Add a label updated by the scheduler tick (ABI version 2)
+  inst->uptime = GTK_LABEL(gtk_label_new(""));
+  gtk_container_add(GTK_CONTAINER(inst->container), GTK_WIDGET(inst->uptime));
+  init_info->add_tick(init_info->obj, ontick);
+
   // Add a label
   label = GTK_LABEL(gtk_label_new("]"));
   gtk_container_add(GTK_CONTAINER(inst->container), GTK_WIDGET(label));
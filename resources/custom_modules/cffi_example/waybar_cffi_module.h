@@ -7,12 +7,39 @@
 extern "C" {
 #endif
 
-/// Waybar ABI version. 1 is the latest version
+/// Waybar ABI version. 2 is the latest version
+///
+/// Version 2 adds the main loop and label functions to `wbcffi_init_info`. Modules declaring
+/// version 1 keep working unchanged.
 extern const size_t wbcffi_version;
 
 /// Private Waybar CFFI module
 typedef struct wbcffi_module wbcffi_module;
 
+/// File descriptor events, see `wbcffi_init_info.add_fd` (ABI version 2)
+enum {
+  WBCFFI_FD_READ = 1 << 0,
+  WBCFFI_FD_WRITE = 1 << 1,
+  /// Only reported, errors and hang-ups are always watched for. The source is removed once the
+  /// callback returns, the module still owns and closes the file descriptor.
+  WBCFFI_FD_ERROR = 1 << 2,
+};
+
+/// Called from the GTK main event loop when `fd` is ready
+/// @param instance Module instance data (as returned by `wbcffi_init`)
+/// @param events   Bitmask of WBCFFI_FD_* events
+typedef void (*wbcffi_fd_callback)(void* instance, int fd, uint32_t events);
+
+/// Called from the GTK main event loop when a timer expires
+/// @param instance Module instance data (as returned by `wbcffi_init`)
+/// @return Non-zero to keep the timer running, 0 to remove it
+typedef int (*wbcffi_timer_callback)(void* instance);
+
+/// Called from the GTK main event loop on each tick of the shared scheduler
+/// @param instance Module instance data (as returned by `wbcffi_init`)
+/// @param tick     Number of ticks since the scheduler was started
+typedef void (*wbcffi_tick_callback)(void* instance, uint64_t tick);
+
 /// Waybar module information
 typedef struct {
   /// Waybar CFFI object pointer
@@ -29,6 +56,40 @@ typedef struct {
   /// loop iteration
   /// @param obj Waybar CFFI object pointer
   void (*queue_update)(wbcffi_module*);
+
+  // The following functions are only available with ABI version 2. They must be called from
+  // the GTK main event loop, i.e. from wbcffi_init or any wbcffi_* / callback function.
+  // Sources still registered when the module is removed are removed after wbcffi_deinit.
+
+  /// Watches a file descriptor from the GTK main event loop
+  /// @param obj    Waybar CFFI object pointer
+  /// @param fd     File descriptor, owned by the module
+  /// @param events Bitmask of WBCFFI_FD_READ and WBCFFI_FD_WRITE
+  /// @param cb     Called each time `fd` is ready, until the source is removed or a
+  ///               WBCFFI_FD_ERROR event was reported
+  /// @return Source ID, 0 on failure
+  unsigned int (*add_fd)(wbcffi_module* obj, int fd, uint32_t events, wbcffi_fd_callback cb);
+
+  /// Calls `cb` every `interval_ms` milliseconds from the GTK main event loop
+  /// @return Source ID, 0 on failure
+  unsigned int (*add_timer)(wbcffi_module* obj, uint32_t interval_ms, wbcffi_timer_callback cb);
+
+  /// Calls `cb` on each tick of the scheduler shared by all modules, once per second. Modules
+  /// updating on this tick are redrawn together instead of each waking Waybar up.
+  /// @return Source ID, 0 on failure
+  unsigned int (*add_tick)(wbcffi_module* obj, wbcffi_tick_callback cb);
+
+  /// Removes a source returned by add_fd, add_timer or add_tick
+  void (*remove_source)(wbcffi_module* obj, unsigned int id);
+
+  /// Sets the markup of a label Waybar adds to the root widget on first use. The string is only
+  /// read during the call and the label is left untouched if the markup didn't change.
+  /// The root widget holds a single child, so don't combine with widgets added by the module.
+  void (*set_text)(wbcffi_module* obj, const char* markup);
+
+  /// Replaces the CSS classes set on that label by the previous call
+  /// @param classes Array of `classes_len` class names, only read during the call
+  void (*set_classes)(wbcffi_module* obj, const char* const* classes, size_t classes_len);
 } wbcffi_init_info;
 
 /// Config key-value pair
@@ -89,6 +89,25 @@ AModule::~AModule() {
   }
 }
 
+void AModule::dispatchUpdate() {
+  const auto requested = dp.takeRequestTime();
+  if (!util::metrics::enabled()) {
+    update();
+    return;
+  }
+  if (updateMetric_ == nullptr) {
+    updateMetric_ = util::metrics::histogram(name_, "update_us");
+    latencyMetric_ = util::metrics::histogram(name_, "event_to_render_us");
+  }
+  {
+    util::metrics::ScopedTimer timer(updateMetric_);
+    update();
+  }
+  if (requested != 0) {
+    latencyMetric_->record(util::metrics::nowUs() - requested);
+  }
+}
+
 auto AModule::update() -> void {
   // Run user-provided update handler if configured
   if (config_["on-update"].isString()) {
@@ -274,6 +293,46 @@ bool AModule::handleScroll(GdkEventScroll* e) {
 
 bool AModule::tooltipEnabled() const { return isTooltip; }
 
+void AModule::setTooltipProducer(Gtk::Widget& widget, std::function<std::string()> producer,
+                                 bool markup) {
+  tooltipProducer_ = std::move(producer);
+  tooltipMarkup_ = markup;
+  if (tooltipWidget_ != &widget) {
+    tooltipWidget_ = &widget;
+    widget.set_has_tooltip(true);
+    widget.signal_query_tooltip().connect(sigc::mem_fun(*this, &AModule::handleQueryTooltip));
+  }
+  invalidateTooltip();
+}
+
+void AModule::invalidateTooltip() {
+  tooltipCached_ = false;
+  // Refresh the tooltip right away only if it may be visible, otherwise wait for the next query
+  if (tooltipWidget_ != nullptr &&
+      (tooltipWidget_->get_state_flags() & Gtk::StateFlags::STATE_FLAG_PRELIGHT)) {
+    tooltipWidget_->trigger_tooltip_query();
+  }
+}
+
+const std::string& AModule::getTooltip() {
+  if (!tooltipCached_) {
+    tooltipText_ = tooltipProducer_ ? tooltipProducer_() : "";
+    tooltipCached_ = true;
+  }
+  return tooltipText_;
+}
+
+bool AModule::handleQueryTooltip(int /*x*/, int /*y*/, bool /*keyboard_tooltip*/,
+                                 const Glib::RefPtr<Gtk::Tooltip>& tooltip) {
+  const auto& text = getTooltip();
+  if (text.empty()) return false;
+  if (tooltipMarkup_)
+    tooltip->set_markup(text);
+  else
+    tooltip->set_text(text);
+  return true;
+}
+
 AModule::operator Gtk::Widget&() { return event_box_; }
 
 }  // namespace waybar
@@ -520,7 +520,7 @@ void waybar::Bar::getModules(const Factory& factory, const std::string& pos,
         }
         module->dp.connect([module, ref] {
           try {
-            module->update();
+            module->dispatchUpdate();
           } catch (const std::exception& e) {
             spdlog::error("{}: {}", ref, e.what());
           }
@@ -5,11 +5,13 @@
 
 #include <iostream>
 #include <utility>
+#include <vector>
 
 #include "gtkmm/icontheme.h"
 #include "idle-inhibit-unstable-v1-client-protocol.h"
 #include "util/clara.hpp"
 #include "util/format.hpp"
+#include "util/metrics.hpp"
 
 waybar::Client *waybar::Client::inst() {
   static auto *c = new Client();
@@ -19,6 +21,18 @@ waybar::Client *waybar::Client::inst() {
 void waybar::Client::handleGlobal(void *data, struct wl_registry *registry, uint32_t name,
                                   const char *interface, uint32_t version) {
   auto *client = static_cast<Client *>(data);
+  auto &global = client->globals_[name] = {name, interface, version};
+  // Handlers may subscribe or unsubscribe, which would invalidate the iteration
+  std::vector<GlobalHandler> handlers;
+  for (const auto &[id, handler] : client->global_handlers_) {
+    if (handler.first == global.interface) {
+      handlers.push_back(handler.second);
+    }
+  }
+  for (const auto &handler : handlers) {
+    handler(registry, global);
+  }
+
   if (strcmp(interface, zxdg_output_manager_v1_interface.name) == 0 &&
       version >= ZXDG_OUTPUT_V1_NAME_SINCE_VERSION) {
     client->xdg_output_manager = static_cast<struct zxdg_output_manager_v1 *>(wl_registry_bind(
@@ -31,9 +45,21 @@ void waybar::Client::handleGlobal(void *data, struct wl_registry *registry, uint
 
 void waybar::Client::handleGlobalRemove(void *data, struct wl_registry * /*registry*/,
                                         uint32_t name) {
-  // Nothing here
+  static_cast<Client *>(data)->globals_.erase(name);
+}
+
+int waybar::Client::subscribeGlobal(const std::string &interface, GlobalHandler handler) {
+  for (const auto &[name, global] : globals_) {
+    if (global.interface == interface) {
+      handler(registry, global);
+    }
+  }
+  global_handlers_.emplace(next_global_handler_id_, std::make_pair(interface, std::move(handler)));
+  return next_global_handler_id_++;
 }
 
+void waybar::Client::unsubscribeGlobal(int id) { global_handlers_.erase(id); }
+
 void waybar::Client::handleOutput(struct waybar_output &output) {
   static const struct zxdg_output_v1_listener xdgOutputListener = {
       .logical_position = [](void *, struct zxdg_output_v1 *, int32_t, int32_t) {},
@@ -221,6 +247,7 @@ int waybar::Client::main(int argc, char *argv[]) {
   std::string config_opt;
   std::string style_opt;
   std::string log_level;
+  bool metrics = false;
   auto cli = clara::detail::Help(show_help) |
              clara::detail::Opt(show_version)["-v"]["--version"]("Show version") |
              clara::detail::Opt(config_opt, "config")["-c"]["--config"]("Config path") |
@@ -228,7 +255,9 @@ int waybar::Client::main(int argc, char *argv[]) {
              clara::detail::Opt(
                  log_level,
                  "trace|debug|info|warning|error|critical|off")["-l"]["--log-level"]("Log level") |
-             clara::detail::Opt(bar_id, "id")["-b"]["--bar"]("Bar id");
+             clara::detail::Opt(bar_id, "id")["-b"]["--bar"]("Bar id") |
+             clara::detail::Opt(metrics)["-m"]["--metrics"](
+                 "Record module timings, dumped as JSON on SIGRTMIN");
   auto res = cli.parse(clara::detail::Args(argc, argv));
   if (!res) {
     spdlog::error("Error in command line: {}", res.errorMessage());
@@ -245,6 +274,9 @@ int waybar::Client::main(int argc, char *argv[]) {
   if (!log_level.empty()) {
     spdlog::set_level(spdlog::level::from_str(log_level));
   }
+  if (metrics) {
+    waybar::util::metrics::setEnabled(true);
+  }
   gtk_app = Gtk::Application::create(argc, argv, "fr.arouillard.waybar",
                                      Gio::APPLICATION_HANDLES_COMMAND_LINE);
 
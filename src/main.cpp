@@ -2,22 +2,43 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include <unistd.h>
+
 #include <csignal>
+#include <cstdlib>
 #include <list>
 #include <mutex>
 
 #include "client.hpp"
+#include "util/metrics.hpp"
 
 std::mutex reap_mtx;
 std::list<pid_t> reap;
 volatile bool reload;
 
+// Writes the instrumentation data to $XDG_RUNTIME_DIR/waybar-metrics-<pid>.json
+void dumpMetrics() {
+  if (!waybar::util::metrics::enabled()) {
+    spdlog::warn("Received SIGRTMIN, but metrics are disabled, start waybar with --metrics");
+    return;
+  }
+  const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+  const auto path = fmt::format("{}/waybar-metrics-{}.json", runtime_dir ? runtime_dir : "/tmp",
+                                getpid());
+  if (waybar::util::metrics::dump(path)) {
+    spdlog::info("Metrics written to {}", path);
+  } else {
+    spdlog::error("Unable to write metrics to {}", path);
+  }
+}
+
 void* signalThread(void* args) {
   int err;
   int signum;
   sigset_t mask;
   sigemptyset(&mask);
   sigaddset(&mask, SIGCHLD);
+  sigaddset(&mask, SIGRTMIN);
 
   while (true) {
     err = sigwait(&mask, &signum);
@@ -26,6 +47,12 @@ void* signalThread(void* args) {
       continue;
     }
 
+    // SIGRTMIN isn't a constant expression
+    if (signum == SIGRTMIN) {
+      dumpMetrics();
+      continue;
+    }
+
     switch (signum) {
       case SIGCHLD:
         spdlog::debug("Received SIGCHLD in signalThread");
@@ -52,8 +79,9 @@ void startSignalThread() {
   sigset_t mask;
   sigemptyset(&mask);
   sigaddset(&mask, SIGCHLD);
+  sigaddset(&mask, SIGRTMIN);
 
-  // Block SIGCHLD so it can be handled by the signal thread
+  // Block SIGCHLD and SIGRTMIN so they can be handled by the signal thread
   // Any threads created by this one (the main thread) should not
   // modify their signal mask to unblock SIGCHLD
   err = pthread_sigmask(SIG_BLOCK, &mask, nullptr);
@@ -26,6 +26,9 @@ waybar::modules::Battery::Battery(const std::string& id, const Bar& bar, const J
     throw std::runtime_error("Could not watch for battery plug/unplug");
   }
 #endif
+  if (tooltipEnabled()) {
+    setTooltipProducer(label_, [this] { return formatTooltip(); }, false);
+  }
   worker();
 }
 
@@ -676,28 +679,19 @@ auto waybar::modules::Battery::update() -> void {
   setBarClass(state);
   auto time_remaining_formatted = formatTimeRemaining(time_remaining);
   if (tooltipEnabled()) {
-    std::string tooltip_text_default;
-    std::string tooltip_format = "{timeTo}";
-    if (time_remaining != 0) {
-      std::string time_to = std::string("Time to ") + ((time_remaining > 0) ? "empty" : "full");
-      tooltip_text_default = time_to + ": " + time_remaining_formatted;
-    } else {
-      tooltip_text_default = status_pretty;
+    TooltipValues tooltip{.status = status,
+                          .status_pretty = status_pretty,
+                          .state = state,
+                          .capacity = capacity,
+                          .time_remaining = time_remaining,
+                          .time_remaining_formatted = time_remaining_formatted,
+                          .power = power,
+                          .cycles = cycles,
+                          .health = health};
+    if (tooltip != tooltip_) {
+      tooltip_ = std::move(tooltip);
+      invalidateTooltip();
     }
-    if (!state.empty() && config_["tooltip-format-" + status + "-" + state].isString()) {
-      tooltip_format = config_["tooltip-format-" + status + "-" + state].asString();
-    } else if (config_["tooltip-format-" + status].isString()) {
-      tooltip_format = config_["tooltip-format-" + status].asString();
-    } else if (!state.empty() && config_["tooltip-format-" + state].isString()) {
-      tooltip_format = config_["tooltip-format-" + state].asString();
-    } else if (config_["tooltip-format"].isString()) {
-      tooltip_format = config_["tooltip-format"].asString();
-    }
-    label_.set_tooltip_text(
-        fmt::format(fmt::runtime(tooltip_format), fmt::arg("timeTo", tooltip_text_default),
-                    fmt::arg("power", power), fmt::arg("capacity", capacity),
-                    fmt::arg("time", time_remaining_formatted), fmt::arg("cycles", cycles),
-                    fmt::arg("health", fmt::format("{:.3}", health))));
   }
   if (!old_status_.empty()) {
     label_.get_style_context()->remove_class(old_status_);
@@ -725,6 +719,31 @@ auto waybar::modules::Battery::update() -> void {
   ALabel::update();
 }
 
+std::string waybar::modules::Battery::formatTooltip() const {
+  const auto& t = tooltip_;
+  std::string tooltip_text_default;
+  std::string tooltip_format = "{timeTo}";
+  if (t.time_remaining != 0) {
+    std::string time_to = std::string("Time to ") + ((t.time_remaining > 0) ? "empty" : "full");
+    tooltip_text_default = time_to + ": " + t.time_remaining_formatted;
+  } else {
+    tooltip_text_default = t.status_pretty;
+  }
+  if (!t.state.empty() && config_["tooltip-format-" + t.status + "-" + t.state].isString()) {
+    tooltip_format = config_["tooltip-format-" + t.status + "-" + t.state].asString();
+  } else if (config_["tooltip-format-" + t.status].isString()) {
+    tooltip_format = config_["tooltip-format-" + t.status].asString();
+  } else if (!t.state.empty() && config_["tooltip-format-" + t.state].isString()) {
+    tooltip_format = config_["tooltip-format-" + t.state].asString();
+  } else if (config_["tooltip-format"].isString()) {
+    tooltip_format = config_["tooltip-format"].asString();
+  }
+  return fmt::format(fmt::runtime(tooltip_format), fmt::arg("timeTo", tooltip_text_default),
+                     fmt::arg("power", t.power), fmt::arg("capacity", t.capacity),
+                     fmt::arg("time", t.time_remaining_formatted), fmt::arg("cycles", t.cycles),
+                     fmt::arg("health", fmt::format("{:.3}", t.health)));
+}
+
 void waybar::modules::Battery::setBarClass(std::string& state) {
   auto classes = bar_.window.get_style_context()->list_classes();
   const std::string prefix = "battery-";
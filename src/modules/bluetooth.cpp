@@ -6,91 +6,14 @@
 #include <algorithm>
 #include <sstream>
 
-#include "util/scope_guard.hpp"
-
-namespace {
-
-using GDBusManager = std::unique_ptr<GDBusObjectManager, void (*)(GDBusObjectManager*)>;
-
-auto generateManager() -> GDBusManager {
-  GError* error = nullptr;
-  waybar::util::ScopeGuard error_deleter([error]() {
-    if (error) {
-      g_error_free(error);
-    }
-  });
-  GDBusObjectManager* manager = g_dbus_object_manager_client_new_for_bus_sync(
-      G_BUS_TYPE_SYSTEM,
-      GDBusObjectManagerClientFlags::G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_DO_NOT_AUTO_START,
-      "org.bluez", "/", NULL, NULL, NULL, NULL, &error);
-
-  if (error) {
-    spdlog::error("g_dbus_object_manager_client_new_for_bus_sync() failed: {}", error->message);
-  }
-
-  auto destructor = [](GDBusObjectManager* manager) {
-    if (manager) {
-      g_object_unref(manager);
-    }
-  };
-
-  return GDBusManager{manager, destructor};
-}
-
-auto getBoolProperty(GDBusProxy* proxy, const char* property_name) -> bool {
-  auto gvar = g_dbus_proxy_get_cached_property(proxy, property_name);
-  if (gvar) {
-    bool property_value = g_variant_get_boolean(gvar);
-    g_variant_unref(gvar);
-    return property_value;
-  }
-
-  spdlog::error("getBoolProperty() failed: doesn't have property {}", property_name);
-  return false;
-}
-
-auto getOptionalStringProperty(GDBusProxy* proxy,
-                               const char* property_name) -> std::optional<std::string> {
-  auto gvar = g_dbus_proxy_get_cached_property(proxy, property_name);
-  if (gvar) {
-    std::string property_value = g_variant_get_string(gvar, NULL);
-    g_variant_unref(gvar);
-    return property_value;
-  }
-
-  return std::nullopt;
-}
-
-auto getStringProperty(GDBusProxy* proxy, const char* property_name) -> std::string {
-  auto property_value = getOptionalStringProperty(proxy, property_name);
-  if (!property_value.has_value()) {
-    spdlog::error("getStringProperty() failed: doesn't have property {}", property_name);
-  }
-  return property_value.value_or("");
-}
-
-auto getUcharProperty(GDBusProxy* proxy, const char* property_name) -> unsigned char {
-  auto gvar = g_dbus_proxy_get_cached_property(proxy, property_name);
-  if (gvar) {
-    unsigned char property_value;
-    g_variant_get(gvar, "y", &property_value);
-    g_variant_unref(gvar);
-
-    return property_value;
-  }
-
-  spdlog::error("getUcharProperty() failed: doesn't have property {}", property_name);
-  return 0;
-}
-
-}  // namespace
+using Change = waybar::util::BluezBackend::Change;
 
 waybar::modules::Bluetooth::Bluetooth(const std::string& id, const Json::Value& config)
     : ALabel(config, "bluetooth", id, " {status}", 10),
 #ifdef WANT_RFKILL
       rfkill_{RFKILL_TYPE_BLUETOOTH},
 #endif
-      manager_(generateManager()) {
+      bluez_(util::BluezBackend::getInstance()) {
 
   if (config_["format-device-preference"].isArray()) {
     std::transform(config_["format-device-preference"].begin(),
@@ -98,27 +21,13 @@ waybar::modules::Bluetooth::Bluetooth(const std::string& id, const Json::Value&
                    std::back_inserter(device_preference_), [](auto x) { return x.asString(); });
   }
 
-  if (cur_controller_ = findCurController(); !cur_controller_) {
-    if (config_["controller-alias"].isString()) {
-      spdlog::warn("no bluetooth controller found with alias '{}'",
-                   config_["controller-alias"].asString());
-    } else {
-      spdlog::warn("no bluetooth controller found");
-    }
-    update();
-  } else {
-    // This call only make sense if a controller could be found
-    findConnectedDevices(cur_controller_->path, connected_devices_);
+  bluez_subscription_ = bluez_->subscribe(
+      [this](Change change, const std::string& path) { onBluezChanged(change, path); });
+  // The cache may already have been loaded for a bar on another output
+  if (bluez_->ready()) {
+    onBluezChanged(Change::READY, {});
   }
 
-  g_signal_connect(manager_.get(), "object-added", G_CALLBACK(onObjectAdded), this);
-  g_signal_connect(manager_.get(), "object-removed", G_CALLBACK(onObjectRemoved), this);
-  g_signal_connect(manager_.get(), "interface-proxy-properties-changed",
-                   G_CALLBACK(onInterfaceProxyPropertiesChanged), this);
-  g_signal_connect(manager_.get(), "interface-added", G_CALLBACK(onInterfaceAddedOrRemoved), this);
-  g_signal_connect(manager_.get(), "interface-removed", G_CALLBACK(onInterfaceAddedOrRemoved),
-                   this);
-
 #ifdef WANT_RFKILL
   rfkill_.on_update.connect(sigc::hide(sigc::mem_fun(*this, &Bluetooth::update)));
 #endif
@@ -126,6 +35,8 @@ waybar::modules::Bluetooth::Bluetooth(const std::string& id, const Json::Value&
   dp.emit();
 }
 
+waybar::modules::Bluetooth::~Bluetooth() { bluez_->unsubscribe(bluez_subscription_); }
+
 auto waybar::modules::Bluetooth::update() -> void {
   // focussed device is either:
   // - the first device in the device_preference_ list that is connected to the
@@ -282,196 +193,95 @@ auto waybar::modules::Bluetooth::update() -> void {
   ALabel::update();
 }
 
-auto waybar::modules::Bluetooth::onObjectAdded(GDBusObjectManager* manager, GDBusObject* object,
-                                               gpointer user_data) -> void {
-  ControllerInfo info;
-  Bluetooth* bt = static_cast<Bluetooth*>(user_data);
-
-  if (!bt->cur_controller_.has_value() && bt->getControllerProperties(object, info) &&
-      (!bt->config_["controller-alias"].isString() ||
-       bt->config_["controller-alias"].asString() == info.alias)) {
-    bt->cur_controller_ = std::move(info);
-    bt->dp.emit();
-  }
-}
-
-auto waybar::modules::Bluetooth::onObjectRemoved(GDBusObjectManager* manager, GDBusObject* object,
-                                                 gpointer user_data) -> void {
-  Bluetooth* bt = static_cast<Bluetooth*>(user_data);
-  GDBusProxy* proxy_controller;
-
-  if (!bt->cur_controller_.has_value()) {
-    return;
-  }
-
-  proxy_controller = G_DBUS_PROXY(g_dbus_object_get_interface(object, "org.bluez.Adapter1"));
-
-  if (proxy_controller != NULL) {
-    std::string object_path = g_dbus_object_get_object_path(object);
-
-    if (object_path == bt->cur_controller_->path) {
-      bt->cur_controller_ = bt->findCurController();
-      if (bt->cur_controller_.has_value()) {
-        bt->connected_devices_.clear();
-        bt->findConnectedDevices(bt->cur_controller_->path, bt->connected_devices_);
+auto waybar::modules::Bluetooth::onBluezChanged(Change change, const std::string& path) -> void {
+  bool changed = false;
+  switch (change) {
+    case Change::READY:
+      selectController();
+      if (!cur_controller_) {
+        if (config_["controller-alias"].isString()) {
+          spdlog::warn("no bluetooth controller found with alias '{}'",
+                       config_["controller-alias"].asString());
+        } else {
+          spdlog::warn("no bluetooth controller found");
+        }
       }
-      bt->dp.emit();
-    }
-
-    g_object_unref(proxy_controller);
-  }
-}
-
-// NOTE: only for when the org.bluez.Battery1 interface is added/removed after/before a device is
-// connected/disconnected
-auto waybar::modules::Bluetooth::onInterfaceAddedOrRemoved(GDBusObjectManager* manager,
-                                                           GDBusObject* object,
-                                                           GDBusInterface* interface,
-                                                           gpointer user_data) -> void {
-  std::string interface_name = g_dbus_proxy_get_interface_name(G_DBUS_PROXY(interface));
-  std::string object_path = g_dbus_proxy_get_object_path(G_DBUS_PROXY(interface));
-  if (interface_name == "org.bluez.Battery1") {
-    Bluetooth* bt = static_cast<Bluetooth*>(user_data);
-    if (bt->cur_controller_.has_value()) {
-      auto device = std::find_if(bt->connected_devices_.begin(), bt->connected_devices_.end(),
-                                 [object_path](auto d) { return d.path == object_path; });
-      if (device != bt->connected_devices_.end()) {
-        device->battery_percentage = bt->getDeviceBatteryPercentage(object);
-        bt->dp.emit();
+      changed = true;
+      break;
+    case Change::CONTROLLER_ADDED:
+      if (!cur_controller_) {
+        changed = selectController();
       }
-    }
-  }
-}
-
-auto waybar::modules::Bluetooth::onInterfaceProxyPropertiesChanged(
-    GDBusObjectManagerClient* manager, GDBusObjectProxy* object_proxy, GDBusProxy* interface_proxy,
-    GVariant* changed_properties, const gchar* const* invalidated_properties,
-    gpointer user_data) -> void {
-  std::string interface_name = g_dbus_proxy_get_interface_name(interface_proxy);
-  std::string object_path = g_dbus_object_get_object_path(G_DBUS_OBJECT(object_proxy));
-
-  Bluetooth* bt = static_cast<Bluetooth*>(user_data);
-
-  if (!bt->cur_controller_.has_value()) {
-    return;
-  }
-
-  if (interface_name == "org.bluez.Adapter1") {
-    if (object_path == bt->cur_controller_->path) {
-      bt->getControllerProperties(G_DBUS_OBJECT(object_proxy), *bt->cur_controller_);
-      bt->dp.emit();
-    }
-  } else if (interface_name == "org.bluez.Device1" || interface_name == "org.bluez.Battery1") {
-    DeviceInfo device;
-    bt->getDeviceProperties(G_DBUS_OBJECT(object_proxy), device);
-    auto cur_device = std::find_if(bt->connected_devices_.begin(), bt->connected_devices_.end(),
-                                   [device](auto d) { return d.path == device.path; });
-    if (cur_device == bt->connected_devices_.end()) {
-      if (device.connected) {
-        bt->connected_devices_.push_back(device);
-        bt->dp.emit();
+      break;
+    case Change::CONTROLLER_CHANGED:
+      if (!cur_controller_) {
+        // the alias may match now
+        changed = selectController();
+      } else if (cur_controller_->path == path) {
+        cur_controller_ = *bluez_->controller(path);
+        changed = true;
       }
-    } else {
-      if (!device.connected) {
-        bt->connected_devices_.erase(cur_device);
-      } else {
-        *cur_device = device;
+      break;
+    case Change::CONTROLLER_REMOVED:
+      if (cur_controller_ && cur_controller_->path == path) {
+        selectController();
+        changed = true;
       }
-      bt->dp.emit();
-    }
+      break;
+    case Change::DEVICE_CHANGED:
+    case Change::DEVICE_REMOVED:
+      changed = updateDevice(path);
+      break;
   }
-}
 
-auto waybar::modules::Bluetooth::getDeviceBatteryPercentage(GDBusObject* object)
-    -> std::optional<unsigned char> {
-  GDBusProxy* proxy_device_bat =
-      G_DBUS_PROXY(g_dbus_object_get_interface(object, "org.bluez.Battery1"));
-  if (proxy_device_bat != NULL) {
-    unsigned char battery_percentage = getUcharProperty(proxy_device_bat, "Percentage");
-    g_object_unref(proxy_device_bat);
-
-    return battery_percentage;
+  if (changed) {
+    dp.emit();
   }
-  return std::nullopt;
 }
 
-auto waybar::modules::Bluetooth::getDeviceProperties(GDBusObject* object,
-                                                     DeviceInfo& device_info) -> bool {
-  GDBusProxy* proxy_device = G_DBUS_PROXY(g_dbus_object_get_interface(object, "org.bluez.Device1"));
-
-  if (proxy_device != NULL) {
-    device_info.path = g_dbus_object_get_object_path(object);
-    device_info.paired_controller = getStringProperty(proxy_device, "Adapter");
-    device_info.address = getStringProperty(proxy_device, "Address");
-    device_info.address_type = getStringProperty(proxy_device, "AddressType");
-    device_info.alias = getStringProperty(proxy_device, "Alias");
-    device_info.icon = getOptionalStringProperty(proxy_device, "Icon");
-    device_info.paired = getBoolProperty(proxy_device, "Paired");
-    device_info.trusted = getBoolProperty(proxy_device, "Trusted");
-    device_info.blocked = getBoolProperty(proxy_device, "Blocked");
-    device_info.connected = getBoolProperty(proxy_device, "Connected");
-    device_info.services_resolved = getBoolProperty(proxy_device, "ServicesResolved");
+auto waybar::modules::Bluetooth::selectController() -> bool {
+  cur_controller_.reset();
+  connected_devices_.clear();
 
-    g_object_unref(proxy_device);
-
-    device_info.battery_percentage = getDeviceBatteryPercentage(object);
-
-    return true;
+  for (const auto& [path, controller] : bluez_->controllers()) {
+    if (!config_["controller-alias"].isString() ||
+        config_["controller-alias"].asString() == controller.alias) {
+      cur_controller_ = controller;
+      break;
+    }
+  }
+  if (!cur_controller_) {
+    return false;
   }
-  return false;
-}
-
-auto waybar::modules::Bluetooth::getControllerProperties(GDBusObject* object,
-                                                         ControllerInfo& controller_info) -> bool {
-  GDBusProxy* proxy_controller =
-      G_DBUS_PROXY(g_dbus_object_get_interface(object, "org.bluez.Adapter1"));
-
-  if (proxy_controller != NULL) {
-    controller_info.path = g_dbus_object_get_object_path(object);
-    controller_info.address = getStringProperty(proxy_controller, "Address");
-    controller_info.address_type = getStringProperty(proxy_controller, "AddressType");
-    controller_info.alias = getStringProperty(proxy_controller, "Alias");
-    controller_info.powered = getBoolProperty(proxy_controller, "Powered");
-    controller_info.discoverable = getBoolProperty(proxy_controller, "Discoverable");
-    controller_info.pairable = getBoolProperty(proxy_controller, "Pairable");
-    controller_info.discovering = getBoolProperty(proxy_controller, "Discovering");
-
-    g_object_unref(proxy_controller);
 
-    return true;
+  for (const auto& [path, device] : bluez_->devices()) {
+    if (device.connected && device.paired_controller == cur_controller_->path) {
+      connected_devices_.push_back(device);
+    }
   }
-  return false;
+  return true;
 }
 
-auto waybar::modules::Bluetooth::findCurController() -> std::optional<ControllerInfo> {
-  std::optional<ControllerInfo> controller_info;
-
-  GList* objects = g_dbus_object_manager_get_objects(manager_.get());
-  for (GList* l = objects; l != NULL; l = l->next) {
-    GDBusObject* object = G_DBUS_OBJECT(l->data);
-    ControllerInfo info;
-    if (getControllerProperties(object, info) &&
-        (!config_["controller-alias"].isString() ||
-         config_["controller-alias"].asString() == info.alias)) {
-      controller_info = std::move(info);
-      break;
-    }
+auto waybar::modules::Bluetooth::updateDevice(const std::string& path) -> bool {
+  if (!cur_controller_) {
+    return false;
   }
-  g_list_free_full(objects, g_object_unref);
 
-  return controller_info;
-}
+  const auto* device = bluez_->device(path);
+  bool connected =
+      device != nullptr && device->connected && device->paired_controller == cur_controller_->path;
+  auto cur_device = std::find_if(connected_devices_.begin(), connected_devices_.end(),
+                                 [&path](const auto& d) { return d.path == path; });
 
-auto waybar::modules::Bluetooth::findConnectedDevices(
-    const std::string& cur_controller_path, std::vector<DeviceInfo>& connected_devices) -> void {
-  GList* objects = g_dbus_object_manager_get_objects(manager_.get());
-  for (GList* l = objects; l != NULL; l = l->next) {
-    GDBusObject* object = G_DBUS_OBJECT(l->data);
-    DeviceInfo device;
-    if (getDeviceProperties(object, device) && device.connected &&
-        device.paired_controller == cur_controller_->path) {
-      connected_devices.push_back(device);
+  if (cur_device == connected_devices_.end()) {
+    if (!connected) {
+      return false;
     }
+    connected_devices_.push_back(*device);
+  } else if (!connected) {
+    connected_devices_.erase(cur_device);
+  } else {
+    *cur_device = *device;
   }
-  g_list_free_full(objects, g_object_unref);
+  return true;
 }
@@ -2,183 +2,63 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cstdlib>
+
 waybar::modules::Cava::Cava(const std::string& id, const Json::Value& config)
     : ALabel(config, "cava", id, "{}", 60, false, false, false) {
-  // Load waybar module config
-  char cfgPath[PATH_MAX];
-  cfgPath[0] = '\0';
-
-  if (config_["cava_config"].isString()) strcpy(cfgPath, config_["cava_config"].asString().data());
-  // Load cava config
-  error_.length = 0;
-
-  if (!load_config(cfgPath, &prm_, false, &error_)) {
-    spdlog::error("Error loading config. {0}", error_.message);
-    exit(EXIT_FAILURE);
-  }
-
-  // Override cava parameters by the user config
-  prm_.inAtty = 0;
-  prm_.output = cava::output_method::OUTPUT_RAW;
-  strcpy(prm_.data_format, "ascii");
-  strcpy(prm_.raw_target, "/dev/stdout");
-  prm_.ascii_range = config_["format-icons"].size() - 1;
-
-  prm_.bar_width = 2;
-  prm_.bar_spacing = 0;
-  prm_.bar_height = 32;
-  prm_.bar_width = 1;
-  prm_.orientation = cava::ORIENT_TOP;
-  prm_.xaxis = cava::xaxis_scale::NONE;
-  prm_.mono_opt = cava::AVERAGE;
-  prm_.autobars = 0;
-  prm_.gravity = 0;
-  prm_.integral = 1;
-
-  if (config_["framerate"].isInt()) prm_.framerate = config_["framerate"].asInt();
-  if (config_["autosens"].isInt()) prm_.autosens = config_["autosens"].asInt();
-  if (config_["sensitivity"].isInt()) prm_.sens = config_["sensitivity"].asInt();
-  if (config_["bars"].isInt()) prm_.fixedbars = config_["bars"].asInt();
-  if (config_["lower_cutoff_freq"].isNumeric())
-    prm_.lower_cut_off = config_["lower_cutoff_freq"].asLargestInt();
-  if (config_["higher_cutoff_freq"].isNumeric())
-    prm_.upper_cut_off = config_["higher_cutoff_freq"].asLargestInt();
-  if (config_["sleep_timer"].isInt()) prm_.sleep_timer = config_["sleep_timer"].asInt();
-  if (config_["method"].isString())
-    prm_.input = cava::input_method_by_name(config_["method"].asString().c_str());
-  if (config_["source"].isString()) prm_.audio_source = config_["source"].asString().data();
-  if (config_["sample_rate"].isNumeric()) prm_.samplerate = config_["sample_rate"].asLargestInt();
-  if (config_["sample_bits"].isInt()) prm_.samplebits = config_["sample_bits"].asInt();
-  if (config_["stereo"].isBool()) prm_.stereo = config_["stereo"].asBool();
-  if (config_["reverse"].isBool()) prm_.reverse = config_["reverse"].asBool();
-  if (config_["bar_delimiter"].isInt()) prm_.bar_delim = config_["bar_delimiter"].asInt();
-  if (config_["monstercat"].isBool()) prm_.monstercat = config_["monstercat"].asBool();
-  if (config_["waves"].isBool()) prm_.waves = config_["waves"].asBool();
-  if (config_["noise_reduction"].isDouble())
-    prm_.noise_reduction = config_["noise_reduction"].asDouble();
-  if (config_["input_delay"].isInt())
-    fetch_input_delay_ = std::chrono::seconds(config_["input_delay"].asInt());
   if (config_["hide_on_silence"].isBool()) hide_on_silence_ = config_["hide_on_silence"].asBool();
   if (config_["format_silent"].isString()) format_silent_ = config_["format_silent"].asString();
-  // Make cava parameters configuration
-  plan_ = new cava::cava_plan{};
 
-  audio_raw_.height = prm_.ascii_range;
-  audio_data_.format = -1;
-  audio_data_.source = new char[1 + strlen(prm_.audio_source)];
-  audio_data_.source[0] = '\0';
-  strcpy(audio_data_.source, prm_.audio_source);
+  backend_ = util::CavaBackend::getInstance(config_);
 
-  audio_data_.rate = 0;
-  audio_data_.samples_counter = 0;
-  audio_data_.channels = 2;
-  audio_data_.IEEE_FLOAT = 0;
+  if (config_["graph"].isBool()) graph_ = config_["graph"].asBool();
+  if (graph_) {
+    if (config_["graph_threshold"].isInt()) graph_threshold_ = config_["graph_threshold"].asInt();
+    if (config_["graph_spacing"].isInt()) graph_spacing_ = config_["graph_spacing"].asInt();
 
-  audio_data_.input_buffer_size = BUFFER_SIZE * audio_data_.channels;
-  audio_data_.cava_buffer_size = audio_data_.input_buffer_size * 8;
-
-  audio_data_.cava_in = new double[audio_data_.cava_buffer_size]{0.0};
-
-  audio_data_.terminate = 0;
-  audio_data_.suspendFlag = false;
-  input_source_ = get_input(&audio_data_, &prm_);
-
-  if (!input_source_) {
-    spdlog::error("cava API didn't provide input audio source method");
-    exit(EXIT_FAILURE);
+    area_.set_name(name_);
+    if (!id.empty()) {
+      area_.get_style_context()->add_class(id);
+    }
+    area_.get_style_context()->add_class(MODULE_CLASS);
+    // Default size, CSS min-width/min-height take precedence if larger
+    area_.set_size_request(backend_->getBarsCount() * (2 + graph_spacing_), -1);
+    area_.signal_draw().connect(sigc::mem_fun(*this, &Cava::onDraw));
+    event_box_.remove();
+    event_box_.add(area_);
+    area_.show();
   }
-  // Calculate delay for Update() thread
-  frame_time_milsec_ = std::chrono::milliseconds((int)(1e3 / prm_.framerate));
-
-  // Init cava plan, audio_raw structure
-  audio_raw_init(&audio_data_, &audio_raw_, &prm_, plan_);
-  if (!plan_) spdlog::error("cava plan is not provided");
-  audio_raw_.previous_frame[0] = -1;  // For first Update() call need to rePaint text message
-  // Read audio source trough cava API. Cava orginizes this process via infinity loop
-  thread_fetch_input_ = [this] {
-    thread_fetch_input_.sleep_for(fetch_input_delay_);
-    input_source_(&audio_data_);
-  };
-
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(frame_time_milsec_);
-  };
-}
 
-waybar::modules::Cava::~Cava() {
-  thread_fetch_input_.stop();
-  thread_.stop();
-  delete plan_;
-  plan_ = nullptr;
+  subscription_ = backend_->subscribe([this] { dp.emit(); });
 }
 
-void upThreadDelay(std::chrono::milliseconds& delay, std::chrono::seconds& delta) {
-  if (delta == std::chrono::seconds{0}) {
-    delta += std::chrono::seconds{1};
-    delay += delta;
-  }
-}
-
-void downThreadDelay(std::chrono::milliseconds& delay, std::chrono::seconds& delta) {
-  if (delta > std::chrono::seconds{0}) {
-    delay -= delta;
-    delta -= std::chrono::seconds{1};
-  }
-}
+waybar::modules::Cava::~Cava() { backend_->unsubscribe(subscription_); }
 
 auto waybar::modules::Cava::update() -> void {
-  if (audio_data_.suspendFlag) return;
-  silence_ = true;
-
-  for (int i{0}; i < audio_data_.input_buffer_size; ++i) {
-    if (audio_data_.cava_in[i]) {
-      silence_ = false;
-      sleep_counter_ = 0;
-      break;
-    }
-  }
+  if (!backend_->readFrame(frame_)) return;
 
-  if (silence_ && prm_.sleep_timer) {
-    if (sleep_counter_ <=
-        (int)(std::chrono::milliseconds(prm_.sleep_timer * 1s) / frame_time_milsec_)) {
-      ++sleep_counter_;
-      silence_ = false;
-    }
+  if (graph_) {
+    updateGraph();
+    return;
   }
 
-  if (!silence_) {
-    downThreadDelay(frame_time_milsec_, suspend_silence_delay_);
-    // Process: execute cava
-    pthread_mutex_lock(&audio_data_.lock);
-    cava::cava_execute(audio_data_.cava_in, audio_data_.samples_counter, audio_raw_.cava_out,
-                       plan_);
-    if (audio_data_.samples_counter > 0) audio_data_.samples_counter = 0;
-    pthread_mutex_unlock(&audio_data_.lock);
-
-    // Do transformation under raw data
-    audio_raw_fetch(&audio_raw_, &prm_, &rePaint_, plan_);
-
-    if (rePaint_ == 1) {
-      text_.clear();
-
-      for (int i{0}; i < audio_raw_.number_of_bars; ++i) {
-        audio_raw_.previous_frame[i] = audio_raw_.bars[i];
-        text_.append(
-            getIcon((audio_raw_.bars[i] > prm_.ascii_range) ? prm_.ascii_range : audio_raw_.bars[i],
-                    "", prm_.ascii_range + 1));
-        if (prm_.bar_delim != 0) text_.push_back(prm_.bar_delim);
-      }
-
-      label_.set_markup(text_);
-      label_.show();
-      ALabel::update();
-      label_.get_style_context()->add_class("updated");
+  if (!frame_.silent) {
+    const auto ascii_range = backend_->getAsciiRange();
+    const auto bar_delim = backend_->getBarDelimiter();
+    text_.clear();
+
+    for (const auto bar : frame_.bars) {
+      text_.append(getIcon(bar, "", ascii_range + 1));
+      if (bar_delim != 0) text_.push_back(bar_delim);
     }
 
+    label_.set_markup(text_);
+    label_.show();
+    ALabel::update();
+    label_.get_style_context()->add_class("updated");
     label_.get_style_context()->remove_class("silent");
   } else {
-    upThreadDelay(frame_time_milsec_, suspend_silence_delay_);
     if (hide_on_silence_)
       label_.hide();
     else if (config_["format_silent"].isString())
@@ -189,6 +69,57 @@ auto waybar::modules::Cava::update() -> void {
   }
 }
 
+void waybar::modules::Cava::updateGraph() {
+  auto style = area_.get_style_context();
+  if (frame_.silent) {
+    if (hide_on_silence_) area_.hide();
+    drawn_bars_.assign(drawn_bars_.size(), 0);
+    area_.queue_draw();
+    style->add_class("silent");
+    style->remove_class("updated");
+    return;
+  }
+
+  if (style->has_class("silent") || drawn_bars_.size() != frame_.bars.size()) {
+    // Restyle only on silence transitions instead of every frame
+    style->remove_class("silent");
+    style->add_class("updated");
+    area_.show();
+  } else {
+    // Skip frames which wouldn't be visibly different
+    int delta{0};
+    for (std::size_t i{0}; i < frame_.bars.size(); ++i)
+      delta = std::max(delta, std::abs(frame_.bars[i] - drawn_bars_[i]));
+    if (delta < graph_threshold_) return;
+  }
+
+  drawn_bars_ = frame_.bars;
+  // Invalidates the area of this widget only, no resize or relayout is needed
+  area_.queue_draw();
+}
+
+bool waybar::modules::Cava::onDraw(const Cairo::RefPtr<Cairo::Context>& cr) {
+  const auto width = area_.get_allocated_width();
+  const auto height = area_.get_allocated_height();
+  auto style = area_.get_style_context();
+  style->render_background(cr, 0, 0, width, height);
+
+  if (drawn_bars_.empty()) return true;
+
+  const auto color = style->get_color(style->get_state());
+  const auto range = backend_->getAsciiRange();
+  const double slot = static_cast<double>(width) / drawn_bars_.size();
+  const double bar_width = std::max(1.0, slot - graph_spacing_);
+
+  cr->set_source_rgba(color.get_red(), color.get_green(), color.get_blue(), color.get_alpha());
+  for (std::size_t i{0}; i < drawn_bars_.size(); ++i) {
+    const double bar_height = static_cast<double>(height) * drawn_bars_[i] / range;
+    cr->rectangle(i * slot, height - bar_height, bar_width, bar_height);
+  }
+  cr->fill();
+  return true;
+}
+
 auto waybar::modules::Cava::doAction(const std::string& name) -> void {
   if ((actionMap_[name])) {
     (this->*actionMap_[name])();
@@ -197,15 +128,4 @@ auto waybar::modules::Cava::doAction(const std::string& name) -> void {
 }
 
 // Cava actions
-void waybar::modules::Cava::pause_resume() {
-  pthread_mutex_lock(&audio_data_.lock);
-  if (audio_data_.suspendFlag) {
-    audio_data_.suspendFlag = false;
-    pthread_cond_broadcast(&audio_data_.resumeCond);
-    downThreadDelay(frame_time_milsec_, suspend_silence_delay_);
-  } else {
-    audio_data_.suspendFlag = true;
-    upThreadDelay(frame_time_milsec_, suspend_silence_delay_);
-  }
-  pthread_mutex_unlock(&audio_data_.lock);
-}
+void waybar::modules::Cava::pause_resume() { backend_->pauseResume(); }
@@ -1,6 +1,7 @@
 #include "modules/cffi.hpp"
 
 #include <dlfcn.h>
+#include <glibmm/main.h>
 #include <json/value.h>
 
 #include <algorithm>
@@ -9,6 +10,54 @@
 
 namespace waybar::modules {
 
+namespace {
+
+// Scheduler tick shared by every cffi module, so modules updating once per second wake Waybar up
+// together instead of each running its own timer.
+class SharedTick {
+ public:
+  static SharedTick& instance() {
+    static SharedTick tick;
+    return tick;
+  }
+
+  unsigned subscribe(std::function<void(uint64_t)> cb) {
+    if (subscribers_.empty()) {
+      timer_ = Glib::signal_timeout().connect_seconds(sigc::mem_fun(*this, &SharedTick::tick), 1);
+    }
+    subscribers_.emplace(next_id_, std::move(cb));
+    return next_id_++;
+  }
+
+  void unsubscribe(unsigned id) {
+    subscribers_.erase(id);
+    if (subscribers_.empty()) {
+      timer_.disconnect();
+    }
+  }
+
+ private:
+  bool tick() {
+    ++count_;
+    // Callbacks may unsubscribe themselves or others
+    for (auto it = subscribers_.begin(); it != subscribers_.end();) {
+      const auto id = it->first;
+      it->second(count_);
+      it = subscribers_.upper_bound(id);
+    }
+    return true;
+  }
+
+  std::map<unsigned, std::function<void(uint64_t)>> subscribers_;
+  unsigned next_id_ = 1;
+  uint64_t count_ = 0;
+  sigc::connection timer_;
+};
+
+CFFI* toModule(ffi::wbcffi_module* obj) { return reinterpret_cast<CFFI*>(obj); }
+
+}  // namespace
+
 CFFI::CFFI(const std::string& name, const std::string& id, const Json::Value& config)
     : AModule(config, name, id, true, true) {
   const auto dynlib_path = config_["module_path"].asString();
@@ -27,8 +76,8 @@ CFFI::CFFI(const std::string& name, const std::string& id, const Json::Value& co
     throw std::runtime_error{std::string{"Missing wbcffi_version function: "} + dlerror()};
   }
 
-  // Fetch functions
-  if (*wbcffi_version == 1) {
+  // Fetch functions. Version 2 only extends wbcffi_init_info.
+  if (*wbcffi_version == 1 || *wbcffi_version == 2) {
     // Mandatory functions
     hooks_.init = reinterpret_cast<InitFn*>(dlsym(handle, "wbcffi_init"));
     if (!hooks_.init) {
@@ -79,6 +128,22 @@ CFFI::CFFI(const std::string& name, const std::string& id, const Json::Value& co
             return dynamic_cast<Gtk::Container*>(&((CFFI*)obj)->event_box_)->gobj();
           },
       .queue_update = [](ffi::wbcffi_module* obj) { ((CFFI*)obj)->dp.emit(); },
+      .add_fd = [](ffi::wbcffi_module* obj, int fd, uint32_t events,
+                   ffi::wbcffi_fd_callback cb) { return toModule(obj)->addFd(fd, events, cb); },
+      .add_timer = [](ffi::wbcffi_module* obj, uint32_t interval_ms,
+                      ffi::wbcffi_timer_callback cb) {
+        return toModule(obj)->addTimer(interval_ms, cb);
+      },
+      .add_tick = [](ffi::wbcffi_module* obj,
+                     ffi::wbcffi_tick_callback cb) { return toModule(obj)->addTick(cb); },
+      .remove_source = [](ffi::wbcffi_module* obj,
+                          unsigned int id) { toModule(obj)->removeSource(id); },
+      .set_text = [](ffi::wbcffi_module* obj,
+                     const char* markup) { toModule(obj)->setText(markup); },
+      .set_classes =
+          [](ffi::wbcffi_module* obj, const char* const* classes, size_t classes_len) {
+            toModule(obj)->setClasses(classes, classes_len);
+          },
   };
 
   // Call init
@@ -86,6 +151,7 @@ CFFI::CFFI(const std::string& name, const std::string& id, const Json::Value& co
 
   // Handle init failures
   if (cffi_instance_ == nullptr) {
+    removeSources();
     throw std::runtime_error{"Failed to initialize C ABI module"};
   }
 }
@@ -94,6 +160,112 @@ CFFI::~CFFI() {
   if (cffi_instance_ != nullptr) {
     hooks_.deinit(cffi_instance_);
   }
+  removeSources();
+}
+
+unsigned CFFI::addSource(std::function<void()> remove) {
+  sources_.emplace(next_source_id_, std::move(remove));
+  return next_source_id_++;
+}
+
+unsigned CFFI::addFd(int fd, uint32_t events, ffi::wbcffi_fd_callback cb) {
+  if (fd < 0 || cb == nullptr) {
+    return 0;
+  }
+  auto condition = Glib::IO_ERR | Glib::IO_HUP;
+  if (events & ffi::WBCFFI_FD_READ) condition |= Glib::IO_IN | Glib::IO_PRI;
+  if (events & ffi::WBCFFI_FD_WRITE) condition |= Glib::IO_OUT;
+
+  const auto id = next_source_id_;
+  auto connection = Glib::signal_io().connect(
+      [this, id, fd, cb](Glib::IOCondition ready) {
+        uint32_t ready_events = 0;
+        if (ready & (Glib::IO_IN | Glib::IO_PRI)) ready_events |= ffi::WBCFFI_FD_READ;
+        if (ready & Glib::IO_OUT) ready_events |= ffi::WBCFFI_FD_WRITE;
+        const bool error = (ready & (Glib::IO_ERR | Glib::IO_HUP | Glib::IO_NVAL)) != 0;
+        if (error) ready_events |= ffi::WBCFFI_FD_ERROR;
+        cb(cffi_instance_, fd, ready_events);
+        if (!error) {
+          return true;
+        }
+        // Hang-ups and errors stay pending, keeping the source would spin the main loop
+        sources_.erase(id);
+        return false;
+      },
+      fd, condition);
+  return addSource([connection]() mutable { connection.disconnect(); });
+}
+
+unsigned CFFI::addTimer(uint32_t interval_ms, ffi::wbcffi_timer_callback cb) {
+  if (cb == nullptr) {
+    return 0;
+  }
+  const auto id = next_source_id_;
+  auto connection = Glib::signal_timeout().connect(
+      [this, id, cb]() {
+        if (cb(cffi_instance_) != 0) {
+          return true;
+        }
+        sources_.erase(id);
+        return false;
+      },
+      interval_ms);
+  return addSource([connection]() mutable { connection.disconnect(); });
+}
+
+unsigned CFFI::addTick(ffi::wbcffi_tick_callback cb) {
+  if (cb == nullptr) {
+    return 0;
+  }
+  auto tick_id =
+      SharedTick::instance().subscribe([this, cb](uint64_t tick) { cb(cffi_instance_, tick); });
+  return addSource([tick_id] { SharedTick::instance().unsubscribe(tick_id); });
+}
+
+void CFFI::removeSource(unsigned id) {
+  auto node = sources_.extract(id);
+  if (!node.empty()) {
+    node.mapped()();
+  }
+}
+
+void CFFI::removeSources() {
+  while (!sources_.empty()) {
+    removeSource(sources_.begin()->first);
+  }
+}
+
+Gtk::Label& CFFI::label() {
+  if (!label_) {
+    label_ = std::make_unique<Gtk::Label>();
+    label_->set_name("cffi-" + name_);
+    label_->get_style_context()->add_class(MODULE_CLASS);
+    event_box_.add(*label_);
+    label_->show();
+  }
+  return *label_;
+}
+
+void CFFI::setText(const char* markup) {
+  if (markup == nullptr) {
+    markup = "";
+  }
+  if (label_ && markup_ == markup) {
+    return;
+  }
+  markup_ = markup;
+  label().set_markup(markup_);
+}
+
+void CFFI::setClasses(const char* const* classes, size_t classes_len) {
+  auto style = label().get_style_context();
+  for (const auto& c : classes_) {
+    style->remove_class(c);
+  }
+  classes_.assign(classes, classes + classes_len);
+  for (const auto& c : classes_) {
+    style->add_class(c);
+  }
 }
 
 auto CFFI::update() -> void {
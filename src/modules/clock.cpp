@@ -18,13 +18,20 @@
 
 namespace fmt_lib = waybar::util::date::format;
 
+namespace {
+// Placeholder patterns are compiled once instead of on every tooltip/calendar rebuild
+const std::regex kTZRegex{"\\{" + waybar::modules::kTZPlaceholder + "\\}"};
+const std::regex kCldRegex{"\\{" + waybar::modules::kCldPlaceholder + "\\}"};
+const std::regex kOrdRegex{"\\{" + waybar::modules::kOrdPlaceholder + "\\}"};
+const std::regex kTodayRegex{"\\{today\\}"};
+}  // namespace
+
 waybar::modules::Clock::Clock(const std::string& id, const Json::Value& config)
     : ALabel(config, "clock", id, "{:%H:%M}", 60, false, false, true),
       m_locale_{std::locale(config_["locale"].isString() ? config_["locale"].asString() : "")},
       m_tlpFmt_{(config_["tooltip-format"].isString()) ? config_["tooltip-format"].asString() : ""},
       m_tooltip_{new Gtk::Label()},
       cldInTooltip_{m_tlpFmt_.find("{" + kCldPlaceholder + "}") != std::string::npos},
-      cldYearShift_{January / 1 / 1900},
       tzInTooltip_{m_tlpFmt_.find("{" + kTZPlaceholder + "}") != std::string::npos},
       tzCurrIdx_{0},
       ordInTooltip_{m_tlpFmt_.find("{" + kOrdPlaceholder + "}") != std::string::npos} {
@@ -75,35 +82,31 @@ waybar::modules::Clock::Clock(const std::string& id, const Json::Value& config)
       if (config_[kCldPlaceholder]["weeks-pos"].asString() == "right") cldWPos_ = WS::RIGHT;
     }
     if (config_[kCldPlaceholder]["format"]["months"].isString())
-      fmtMap_.insert({0, config_[kCldPlaceholder]["format"]["months"].asString()});
+      fmtMap_[0] = config_[kCldPlaceholder]["format"]["months"].asString();
     else
-      fmtMap_.insert({0, "{}"});
+      fmtMap_[0] = "{}";
     if (config_[kCldPlaceholder]["format"]["weekdays"].isString())
-      fmtMap_.insert({1, config_[kCldPlaceholder]["format"]["weekdays"].asString()});
+      fmtMap_[1] = config_[kCldPlaceholder]["format"]["weekdays"].asString();
     else
-      fmtMap_.insert({1, "{}"});
+      fmtMap_[1] = "{}";
 
     if (config_[kCldPlaceholder]["format"]["days"].isString())
-      fmtMap_.insert({2, config_[kCldPlaceholder]["format"]["days"].asString()});
+      fmtMap_[2] = config_[kCldPlaceholder]["format"]["days"].asString();
     else
-      fmtMap_.insert({2, "{}"});
+      fmtMap_[2] = "{}";
     if (config_[kCldPlaceholder]["format"]["today"].isString()) {
-      fmtMap_.insert({3, config_[kCldPlaceholder]["format"]["today"].asString()});
-      cldBaseDay_ =
-          year_month_day{
-              floor<days>(zoned_time{local_zone(), system_clock::now()}.get_local_time())}
-              .day();
+      fmtMap_[3] = config_[kCldPlaceholder]["format"]["today"].asString();
     } else
-      fmtMap_.insert({3, "{}"});
+      fmtMap_[3] = "{}";
     if (config_[kCldPlaceholder]["format"]["weeks"].isString() && cldWPos_ != WS::HIDDEN) {
-      fmtMap_.insert({4, std::regex_replace(config_[kCldPlaceholder]["format"]["weeks"].asString(),
-                                            std::regex("\\{\\}"),
-                                            (first_day_of_week() == Monday) ? "{:%W}" : "{:%U}")});
+      fmtMap_[4] = std::regex_replace(config_[kCldPlaceholder]["format"]["weeks"].asString(),
+                                      std::regex("\\{\\}"),
+                                      (first_day_of_week() == Monday) ? "{:%W}" : "{:%U}");
       Glib::ustring tmp{std::regex_replace(fmtMap_[4], std::regex("</?[^>]+>|\\{.*\\}"), "")};
       cldWnLen_ += tmp.size();
     } else {
       if (cldWPos_ != WS::HIDDEN)
-        fmtMap_.insert({4, (first_day_of_week() == Monday) ? "{:%W}" : "{:%U}"});
+        fmtMap_[4] = (first_day_of_week() == Monday) ? "{:%W}" : "{:%U}";
       else
         cldWnLen_ = 0;
     }
@@ -129,8 +132,7 @@ waybar::modules::Clock::Clock(const std::string& id, const Json::Value& config)
   }
 
   if (tooltipEnabled()) {
-    label_.set_has_tooltip(true);
-    label_.signal_query_tooltip().connect(sigc::mem_fun(*this, &Clock::query_tlp_cb));
+    setTooltipProducer(label_, [this] { return get_tooltip(); });
   }
 
   thread_ = [this] {
@@ -139,8 +141,11 @@ waybar::modules::Clock::Clock(const std::string& id, const Json::Value& config)
   };
 }
 
-bool waybar::modules::Clock::query_tlp_cb(int, int, bool,
-                                          const Glib::RefPtr<Gtk::Tooltip>& tooltip) {
+bool waybar::modules::Clock::handleQueryTooltip(int, int, bool,
+                                                const Glib::RefPtr<Gtk::Tooltip>& tooltip) {
+  m_tlpText_ = getTooltip();
+  if (m_tlpText_.empty()) return false;
+  m_tooltip_->set_markup(m_tlpText_);
   tooltip->set_custom(*m_tooltip_.get());
   return true;
 }
@@ -151,34 +156,36 @@ auto waybar::modules::Clock::update() -> void {
 
   label_.set_markup(fmt_lib::vformat(m_locale_, format_, fmt_lib::make_format_args(now)));
 
-  if (tooltipEnabled()) {
-    const year_month_day today{floor<days>(now.get_local_time())};
-    const auto shiftedDay{today + cldCurrShift_};
-    const zoned_time shiftedNow{
-        tz, local_days(shiftedDay) + (now.get_local_time() - floor<days>(now.get_local_time()))};
-
-    if (tzInTooltip_) tzText_ = getTZtext(now.get_sys_time());
-    if (cldInTooltip_) cldText_ = get_calendar(today, shiftedDay, tz);
-    if (ordInTooltip_) ordText_ = get_ordinal_date(shiftedDay);
-    if (tzInTooltip_ || cldInTooltip_ || ordInTooltip_) {
-      // std::vformat doesn't support named arguments.
-      m_tlpText_ =
-          std::regex_replace(m_tlpFmt_, std::regex("\\{" + kTZPlaceholder + "\\}"), tzText_);
-      m_tlpText_ = std::regex_replace(
-          m_tlpText_, std::regex("\\{" + kCldPlaceholder + "\\}"),
-          fmt_lib::vformat(m_locale_, cldText_, fmt_lib::make_format_args(shiftedNow)));
-      m_tlpText_ =
-          std::regex_replace(m_tlpText_, std::regex("\\{" + kOrdPlaceholder + "\\}"), ordText_);
-    } else {
-      m_tlpText_ = m_tlpFmt_;
-    }
+  // The tooltip is only regenerated when it's actually queried
+  if (tooltipEnabled()) invalidateTooltip();
+
+  ALabel::update();
+}
 
-    m_tlpText_ = fmt_lib::vformat(m_locale_, m_tlpText_, fmt_lib::make_format_args(now));
-    m_tooltip_->set_markup(m_tlpText_);
-    label_.trigger_tooltip_query();
+auto waybar::modules::Clock::get_tooltip() -> std::string {
+  const auto* tz = tzList_[tzCurrIdx_] != nullptr ? tzList_[tzCurrIdx_] : local_zone();
+  const zoned_time now{tz, floor<seconds>(system_clock::now())};
+  const year_month_day today{floor<days>(now.get_local_time())};
+  const auto shiftedDay{today + cldCurrShift_};
+  const zoned_time shiftedNow{
+      tz, local_days(shiftedDay) + (now.get_local_time() - floor<days>(now.get_local_time()))};
+
+  std::string text;
+  if (tzInTooltip_) tzText_ = getTZtext(now.get_sys_time());
+  if (cldInTooltip_) cldText_ = get_calendar(today, shiftedDay, tz);
+  if (ordInTooltip_) ordText_ = get_ordinal_date(shiftedDay);
+  if (tzInTooltip_ || cldInTooltip_ || ordInTooltip_) {
+    // std::vformat doesn't support named arguments.
+    text = std::regex_replace(m_tlpFmt_, kTZRegex, tzText_);
+    text = std::regex_replace(
+        text, kCldRegex,
+        fmt_lib::vformat(m_locale_, cldText_, fmt_lib::make_format_args(shiftedNow)));
+    text = std::regex_replace(text, kOrdRegex, ordText_);
+  } else {
+    text = m_tlpFmt_;
   }
 
-  ALabel::update();
+  return fmt_lib::vformat(m_locale_, text, fmt_lib::make_format_args(now));
 }
 
 auto waybar::modules::Clock::getTZtext(sys_seconds now) -> std::string {
@@ -291,33 +298,19 @@ auto getCalendarLine(const year_month_day& currDate, const year_month ym, const
 
 auto waybar::modules::Clock::get_calendar(const year_month_day& today, const year_month_day& ymd,
                                           const time_zone* tz) -> const std::string {
-  const auto firstdow{first_day_of_week()};
-  const auto maxRows{12 / cldMonCols_};
   const auto ym{ymd.year() / ymd.month()};
   const auto y{ymd.year()};
-  const auto d{ymd.day()};
+
+  // The calendar only changes with the day, the shown month(year), the mode or the time zone
+  const CldCacheKey key{today, (cldMode_ == CldMode::YEAR) ? y / January : ym, cldMode_, tz};
+  if (cldCacheKey_ == key) return cldCached_;
+
+  const auto firstdow{first_day_of_week()};
+  const auto maxRows{12 / cldMonCols_};
 
   std::ostringstream os;
   std::ostringstream tmp;
 
-  if (cldMode_ == CldMode::YEAR) {
-    if (y / month{1} / 1 == cldYearShift_)
-      if (d == cldBaseDay_ || (uint)cldBaseDay_ == 0u)
-        return cldYearCached_;
-      else
-        cldBaseDay_ = d;
-    else
-      cldYearShift_ = y / month{1} / 1;
-  }
-  if (cldMode_ == CldMode::MONTH) {
-    if (ym == cldMonShift_)
-      if (d == cldBaseDay_ || (uint)cldBaseDay_ == 0u)
-        return cldMonCached_;
-      else
-        cldBaseDay_ = d;
-    else
-      cldMonShift_ = ym;
-  }
   // Pad object
   const std::string pads(cldWnLen_, ' ');
   // Compute number of lines needed for each calendar month
@@ -399,17 +392,15 @@ auto waybar::modules::Clock::get_calendar(const year_month_day& today, const yea
   os << std::regex_replace(
       fmt_lib::vformat(m_locale_, fmtMap_[2],
                        fmt_lib::make_format_args(static_cast<const std::string_view&&>(tmp.str()))),
-      std::regex("\\{today\\}"),
+      kTodayRegex,
       fmt_lib::vformat(m_locale_, fmtMap_[3],
-                       fmt_lib::make_format_args(
-                           static_cast<const std::string_view&&>(date::format("{:L%e}", d)))));
+                       fmt_lib::make_format_args(static_cast<const std::string_view&&>(
+                           date::format("{:L%e}", today.day())))));
 
-  if (cldMode_ == CldMode::YEAR)
-    cldYearCached_ = os.str();
-  else
-    cldMonCached_ = os.str();
+  cldCacheKey_ = key;
+  cldCached_ = os.str();
 
-  return os.str();
+  return cldCached_;
 }
 
 auto waybar::modules::Clock::local_zone() -> const time_zone* {
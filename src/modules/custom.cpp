@@ -1,7 +1,14 @@
 #include "modules/custom.hpp"
 
+#include <poll.h>
 #include <spdlog/spdlog.h>
+#include <unistd.h>
 
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#include "util/metrics.hpp"
 #include "util/scope_guard.hpp"
 
 waybar::modules::Custom::Custom(const std::string& name, const std::string& id,
@@ -13,10 +20,20 @@ waybar::modules::Custom::Custom(const std::string& name, const std::string& id,
       tooltip_format_enabled_{config_["tooltip-format"].isString()},
       percentage_(0),
       fp_(nullptr),
-      pid_(-1) {
+      pid_(-1),
+      stream_(config_["return-type"].asString() == "json-stream"),
+      persistent_in_(-1),
+      persistent_timeout_(config_["timeout"].isNumeric()
+                              ? static_cast<int64_t>(config_["timeout"].asDouble() * 1000)
+                              : 10000),
+      persistent_reason_("interval"),
+      exec_metric_(util::metrics::histogram(AModule::name_, "exec_us")) {
   dp.emit();
-  if (!config_["signal"].empty() && config_["interval"].empty() &&
-      config_["restart-interval"].empty()) {
+  if (config_["persistent"].isBool() && config_["persistent"].asBool() &&
+      config_["exec"].isString() && (interval_.count() > 0 || !config_["signal"].empty())) {
+    persistentWorker();
+  } else if (!config_["signal"].empty() && config_["interval"].empty() &&
+             config_["restart-interval"].empty()) {
     waitingWorker();
   } else if (interval_.count() > 0) {
     delayWorker();
@@ -26,11 +43,19 @@ waybar::modules::Custom::Custom(const std::string& name, const std::string& id,
 }
 
 waybar::modules::Custom::~Custom() {
+  // The worker may be using the script and its pipes, and stops a persistent script itself when a
+  // request fails; let it finish before tearing them down
+  thread_.stop();
+  thread_.join();
   if (pid_ != -1) {
     killpg(pid_, SIGTERM);
     waitpid(pid_, NULL, 0);
     pid_ = -1;
   }
+  if (persistent_in_ != -1) {
+    ::close(persistent_in_);
+    persistent_in_ = -1;
+  }
 }
 
 void waybar::modules::Custom::delayWorker() {
@@ -45,7 +70,13 @@ void waybar::modules::Custom::delayWorker() {
     }
     if (can_update) {
       if (config_["exec"].isString()) {
-        output_ = util::command::exec(config_["exec"].asString(), output_name_);
+        {
+          util::metrics::ScopedTimer timer(exec_metric_);
+          output_ = util::command::exec(config_["exec"].asString(), output_name_);
+        }
+        if (stream_) {
+          applyStreamOutput(output_.out);
+        }
       }
       dp.emit();
     }
@@ -61,46 +92,163 @@ void waybar::modules::Custom::continuousWorker() {
     throw std::runtime_error("Unable to open " + cmd);
   }
   thread_ = [this, cmd] {
-    char* buff = nullptr;
-    waybar::util::ScopeGuard buff_deleter([buff]() {
-      if (buff) {
-        free(buff);
-      }
-    });
-    size_t len = 0;
-    if (getline(&buff, &len, fp_) == -1) {
-      int exit_code = 1;
-      if (fp_) {
-        exit_code = WEXITSTATUS(util::command::close(fp_, pid_));
-        fp_ = nullptr;
-      }
-      if (exit_code != 0) {
-        output_ = {exit_code, ""};
-        dp.emit();
-        spdlog::error("{} stopped unexpectedly, is it endless?", name_);
-      }
-      if (config_["restart-interval"].isUInt()) {
-        pid_ = -1;
-        thread_.sleep_for(std::chrono::seconds(config_["restart-interval"].asUInt()));
-        fp_ = util::command::open(cmd, pid_, output_name_);
-        if (!fp_) {
-          throw std::runtime_error("Unable to open " + cmd);
-        }
-      } else {
-        thread_.stop();
-        return;
+    if (stream_ ? readStream() : readLine()) {
+      return;
+    }
+    int exit_code = 1;
+    if (fp_) {
+      exit_code = WEXITSTATUS(util::command::close(fp_, pid_));
+      fp_ = nullptr;
+    }
+    if (exit_code != 0) {
+      output_ = {exit_code, ""};
+      dp.emit();
+      spdlog::error("{} stopped unexpectedly, is it endless?", name_);
+    }
+    if (config_["restart-interval"].isUInt()) {
+      pid_ = -1;
+      thread_.sleep_for(std::chrono::seconds(config_["restart-interval"].asUInt()));
+      fp_ = util::command::open(cmd, pid_, output_name_);
+      if (!fp_) {
+        throw std::runtime_error("Unable to open " + cmd);
       }
     } else {
-      std::string output = buff;
+      thread_.stop();
+    }
+  };
+}
 
-      // Remove last newline
-      if (!output.empty() && output[output.length() - 1] == '\n') {
-        output.erase(output.length() - 1);
-      }
-      output_ = {0, output};
+// Reads one line of the continuous script, returns false once it exited
+bool waybar::modules::Custom::readLine() {
+  char* buff = nullptr;
+  waybar::util::ScopeGuard buff_deleter([&buff]() {
+    if (buff) {
+      free(buff);
+    }
+  });
+  size_t len = 0;
+  if (getline(&buff, &len, fp_) == -1) {
+    return false;
+  }
+  std::string output = buff;
+
+  // Remove last newline
+  if (!output.empty() && output[output.length() - 1] == '\n') {
+    output.erase(output.length() - 1);
+  }
+  output_ = {0, output};
+  dp.emit();
+  return true;
+}
+
+// Applies everything the script wrote since the last read, so a burst of lines costs one redraw.
+// Returns false once the script exited.
+bool waybar::modules::Custom::readStream() {
+  char buff[4096];
+  ssize_t len = read(fileno(fp_), buff, sizeof(buff));
+  if (len < 0 && errno == EINTR) {
+    return true;
+  }
+  if (len <= 0) {
+    // Don't lose a last line without a newline
+    bool changed = applyStreamLine(stream_buffer_);
+    stream_buffer_.clear();
+    if (changed) {
       dp.emit();
     }
+    return false;
+  }
+
+  stream_buffer_.append(buff, len);
+  bool changed = false;
+  size_t start = 0;
+  for (size_t end; (end = stream_buffer_.find('\n', start)) != std::string::npos; start = end + 1) {
+    changed |= applyStreamLine(std::string_view(stream_buffer_).substr(start, end - start));
+  }
+  stream_buffer_.erase(0, start);
+  // Also redraw if the script was restarted after failing
+  if (changed || output_.exit_code != 0) {
+    output_ = {0, ""};
+    dp.emit();
+  }
+  return true;
+}
+
+bool waybar::modules::Custom::applyStreamOutput(const std::string& output) {
+  bool changed = false;
+  std::string_view rest = output;
+  while (!rest.empty()) {
+    auto end = rest.find('\n');
+    changed |= applyStreamLine(rest.substr(0, end));
+    rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+  }
+  return changed;
+}
+
+// Merges the fields present on `line` into the stream state, returns whether anything changed
+bool waybar::modules::Custom::applyStreamLine(std::string_view line) {
+  if (!line.empty() && line.back() == '\r') {
+    line.remove_suffix(1);
+  }
+  if (line.empty()) {
+    return false;
+  }
+  if (!stream_reader_.parse(line)) {
+    spdlog::warn("{}: ignoring invalid json-stream line: {}", name_, line);
+    return false;
+  }
+
+  using Type = util::FlatJsonValue::Type;
+  const bool escape = config_["escape"].isBool() && config_["escape"].asBool();
+  auto assign = [](auto& field, auto&& value) {
+    if (field == value) {
+      return false;
+    }
+    field = std::forward<decltype(value)>(value);
+    return true;
   };
+  auto text = [escape](const util::FlatJsonValue& value) -> std::string {
+    if (value.type != Type::STRING) {
+      return {};
+    }
+    return escape ? std::string(Glib::Markup::escape_text(value.string)) : value.string;
+  };
+
+  std::lock_guard<std::mutex> lock(stream_mutex_);
+  bool changed = !stream_state_.received;
+  stream_state_.received = true;
+  for (const auto& [key, value] : stream_reader_.members()) {
+    if (key == "text") {
+      changed |= assign(stream_state_.text, text(value));
+    } else if (key == "alt") {
+      changed |= assign(stream_state_.alt, text(value));
+    } else if (key == "tooltip") {
+      changed |= assign(stream_state_.tooltip, text(value));
+    } else if (key == "class") {
+      if (value.type == Type::STRING) {
+        changed |= assign(stream_state_.classes, std::vector<std::string>{value.string});
+      } else if (value.type == Type::STRING_ARRAY) {
+        changed |= assign(stream_state_.classes, value.strings);
+      } else {
+        changed |= assign(stream_state_.classes, std::vector<std::string>{});
+      }
+    } else if (key == "percentage") {
+      int percentage = value.type == Type::NUMBER ? (int)lround(value.number) : 0;
+      changed |= assign(stream_state_.percentage, percentage);
+    }
+  }
+  return changed;
+}
+
+// Copies the stream state for rendering, returns false if the script didn't print anything yet
+bool waybar::modules::Custom::loadStreamState() {
+  std::lock_guard<std::mutex> lock(stream_mutex_);
+  text_ = stream_state_.text;
+  alt_ = stream_state_.alt;
+  tooltip_ = stream_state_.tooltip;
+  class_ = stream_state_.classes;
+  percentage_ = stream_state_.percentage;
+  return stream_state_.received;
 }
 
 void waybar::modules::Custom::waitingWorker() {
@@ -115,7 +263,13 @@ void waybar::modules::Custom::waitingWorker() {
     }
     if (can_update) {
       if (config_["exec"].isString()) {
-        output_ = util::command::exec(config_["exec"].asString(), output_name_);
+        {
+          util::metrics::ScopedTimer timer(exec_metric_);
+          output_ = util::command::exec(config_["exec"].asString(), output_name_);
+        }
+        if (stream_) {
+          applyStreamOutput(output_.out);
+        }
       }
       dp.emit();
     }
@@ -123,14 +277,126 @@ void waybar::modules::Custom::waitingWorker() {
   };
 }
 
+void waybar::modules::Custom::persistentWorker() {
+  thread_ = [this] {
+    const char* reason = persistent_reason_.exchange("interval");
+    // A script that exited or stopped answering is started again on the next request
+    if (fp_ == nullptr && !startPersistent()) {
+      dp.emit();
+    } else if (!requestPersistent(reason)) {
+      stopPersistent();
+      output_ = {1, ""};
+      dp.emit();
+    } else {
+      dp.emit();
+    }
+    if (interval_.count() > 0) {
+      thread_.sleep_for(interval_);
+    } else {
+      thread_.sleep();
+    }
+  };
+}
+
+bool waybar::modules::Custom::startPersistent() {
+  if (config_["exec-if"].isString()) {
+    output_ = util::command::execNoRead(config_["exec-if"].asString());
+    if (output_.exit_code != 0) {
+      return false;
+    }
+  }
+
+  // Writing to a script that died must fail with EPIPE instead of killing Waybar
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+  pid_ = -1;
+  stream_buffer_.clear();
+  fp_ = util::command::open(config_["exec"].asString(), pid_, output_name_, &persistent_in_);
+  if (!fp_) {
+    output_ = {1, ""};
+    return false;
+  }
+  return true;
+}
+
+// Writes `reason` as a request line and waits for the one line answer
+bool waybar::modules::Custom::requestPersistent(const char* reason) {
+  util::metrics::ScopedTimer timer(exec_metric_);
+  const std::string request = std::string(reason) + '\n';
+  if (write(persistent_in_, request.data(), request.size()) !=
+      static_cast<ssize_t>(request.size())) {
+    spdlog::error("{}: unable to send a request to the script: {}", name_, strerror(errno));
+    return false;
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + persistent_timeout_;
+  size_t end;
+  while ((end = stream_buffer_.find('\n')) == std::string::npos) {
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    pollfd pfd = {.fd = fileno(fp_), .events = POLLIN, .revents = 0};
+    int ret = remaining.count() > 0 ? poll(&pfd, 1, remaining.count()) : 0;
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret == 0) {
+      spdlog::warn("{}: no answer within {}ms, restarting the script", name_,
+                   persistent_timeout_.count());
+      return false;
+    }
+    char buff[4096];
+    ssize_t len = ret < 0 ? -1 : read(pfd.fd, buff, sizeof(buff));
+    if (len < 0 && errno == EINTR) {
+      continue;
+    }
+    if (len <= 0) {
+      spdlog::error("{} stopped unexpectedly, is it persistent?", name_);
+      return false;
+    }
+    stream_buffer_.append(buff, len);
+  }
+
+  std::string output = stream_buffer_.substr(0, end);
+  stream_buffer_.erase(0, end + 1);
+  if (stream_) {
+    applyStreamLine(output);
+  }
+  output_ = {0, output};
+  return true;
+}
+
+void waybar::modules::Custom::stopPersistent() {
+  // A cancellation between closing and resetting a descriptor would leave it to be closed twice
+  util::CancellationGuard cancel_lock;
+  if (persistent_in_ != -1) {
+    ::close(persistent_in_);
+    persistent_in_ = -1;
+  }
+  if (fp_) {
+    if (pid_ != -1) {
+      killpg(pid_, SIGTERM);
+      util::command::close(fp_, pid_);
+    } else {
+      fclose(fp_);
+    }
+    fp_ = nullptr;
+    pid_ = -1;
+  }
+}
+
 void waybar::modules::Custom::refresh(int sig) {
   if (sig == SIGRTMIN + config_["signal"].asInt()) {
+    persistent_reason_ = "signal";
     thread_.wake_up();
   }
 }
 
 void waybar::modules::Custom::handleEvent() {
   if (!config_["exec-on-event"].isBool() || config_["exec-on-event"].asBool()) {
+    persistent_reason_ = "event";
     thread_.wake_up();
   }
 }
@@ -149,14 +415,17 @@ bool waybar::modules::Custom::handleToggle(GdkEventButton* const& e) {
 
 auto waybar::modules::Custom::update() -> void {
   // Hide label if output is empty
+  const bool has_output = stream_ ? loadStreamState() : !output_.out.empty();
   if ((config_["exec"].isString() || config_["exec-if"].isString()) &&
-      (output_.out.empty() || output_.exit_code != 0)) {
+      (!has_output || output_.exit_code != 0)) {
     event_box_.hide();
   } else {
-    if (config_["return-type"].asString() == "json") {
-      parseOutputJson();
-    } else {
-      parseOutputRaw();
+    if (!stream_) {
+      if (config_["return-type"].asString() == "json") {
+        parseOutputJson();
+      } else {
+        parseOutputRaw();
+      }
     }
 
     try {
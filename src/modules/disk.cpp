@@ -14,6 +14,9 @@ waybar::modules::Disk::Disk(const std::string& id, const Json::Value& config)
   if (config["unit"].isString()) {
     unit_ = config["unit"].asString();
   }
+  if (tooltipEnabled()) {
+    setTooltipProducer(label_, [this] { return formatTooltip(); }, false);
+  }
 }
 
 auto waybar::modules::Disk::update() -> void {
@@ -77,21 +80,37 @@ auto waybar::modules::Disk::update() -> void {
   }
 
   if (tooltipEnabled()) {
-    std::string tooltip_format = "{used} used out of {total} on {path} ({percentage_used}%)";
-    if (config_["tooltip-format"].isString()) {
-      tooltip_format = config_["tooltip-format"].asString();
+    TooltipValues tooltip{.free = free,
+                          .used = used,
+                          .total = total,
+                          .percentage_free = stats.f_bavail * 100 / stats.f_blocks,
+                          .percentage_used = percentage_used,
+                          .specific_free = specific_free,
+                          .specific_used = specific_used,
+                          .specific_total = specific_total};
+    if (tooltip != tooltip_) {
+      tooltip_ = std::move(tooltip);
+      invalidateTooltip();
     }
-    label_.set_tooltip_text(fmt::format(
-        fmt::runtime(tooltip_format), stats.f_bavail * 100 / stats.f_blocks, fmt::arg("free", free),
-        fmt::arg("percentage_free", stats.f_bavail * 100 / stats.f_blocks), fmt::arg("used", used),
-        fmt::arg("percentage_used", percentage_used), fmt::arg("total", total),
-        fmt::arg("path", path_), fmt::arg("specific_free", specific_free),
-        fmt::arg("specific_used", specific_used), fmt::arg("specific_total", specific_total)));
   }
   // Call parent update
   ALabel::update();
 }
 
+std::string waybar::modules::Disk::formatTooltip() const {
+  const auto& t = tooltip_;
+  std::string tooltip_format = "{used} used out of {total} on {path} ({percentage_used}%)";
+  if (config_["tooltip-format"].isString()) {
+    tooltip_format = config_["tooltip-format"].asString();
+  }
+  return fmt::format(fmt::runtime(tooltip_format), t.percentage_free, fmt::arg("free", t.free),
+                     fmt::arg("percentage_free", t.percentage_free), fmt::arg("used", t.used),
+                     fmt::arg("percentage_used", t.percentage_used), fmt::arg("total", t.total),
+                     fmt::arg("path", path_), fmt::arg("specific_free", t.specific_free),
+                     fmt::arg("specific_used", t.specific_used),
+                     fmt::arg("specific_total", t.specific_total));
+}
+
 float waybar::modules::Disk::calc_specific_divisor(std::string divisor) {
   if (divisor == "kB") {
     return 1000.0;
@@ -73,7 +73,7 @@ static const wl_registry_listener registry_listener_impl = {.global = handle_glo
                                                             .global_remove = handle_global_remove};
 
 Window::Window(const std::string &id, const Bar &bar, const Json::Value &config)
-    : AAppIconLabel(config, "window", id, "{}", 0, true), bar_(bar) {
+    : AAppIconLabel(config, "window", id, "{}", 0, true), bar_(bar), rewrite_(config["rewrite"]) {
   struct wl_display *display = Client::inst()->wl_display;
   struct wl_registry *registry = wl_display_get_registry(display);
 
@@ -106,10 +106,9 @@ void Window::handle_layout_symbol(const char *layout_symbol) { layout_symbol_ =
 void Window::handle_layout(const uint32_t layout) { layout_ = layout; }
 
 void Window::handle_frame() {
-  label_.set_markup(waybar::util::rewriteString(
-      fmt::format(fmt::runtime(format_), fmt::arg("title", title_),
-                  fmt::arg("layout", layout_symbol_), fmt::arg("app_id", appid_)),
-      config_["rewrite"]));
+  label_.set_markup(
+      rewrite_.apply(fmt::format(fmt::runtime(format_), fmt::arg("title", title_),
+                                 fmt::arg("layout", layout_symbol_), fmt::arg("app_id", appid_))));
   updateAppIconName(appid_, "");
   updateAppIcon();
   if (tooltipEnabled()) {
@@ -18,11 +18,16 @@
 #include "glibmm/varianttype.h"
 #include "gtkmm/label.h"
 #include "gtkmm/tooltip.h"
+#include "util/dbus.hpp"
 #include "util/gtk_icon.hpp"
 
 namespace waybar::modules {
 Gamemode::Gamemode(const std::string& id, const Json::Value& config)
-    : AModule(config, "gamemode", id), box_(Gtk::ORIENTATION_HORIZONTAL, 0), icon_(), label_() {
+    : AModule(config, "gamemode", id),
+      box_(Gtk::ORIENTATION_HORIZONTAL, 0),
+      icon_(),
+      label_(),
+      cancellable_(Gio::Cancellable::create()) {
   box_.pack_start(icon_);
   box_.pack_start(label_);
   box_.set_name(name_);
@@ -87,28 +92,31 @@ Gamemode::Gamemode(const std::string& id, const Json::Value& config)
       Gio::DBus::BusNameWatcherFlags::BUS_NAME_WATCHER_FLAGS_AUTO_START);
 
   // Connect to gamemode
-  gamemode_proxy = Gio::DBus::Proxy::create_for_bus_sync(Gio::DBus::BusType::BUS_TYPE_SESSION,
-                                                         dbus_name, dbus_obj_path, dbus_interface);
-  if (!gamemode_proxy) {
-    throw std::runtime_error("Unable to connect to gamemode DBus!...");
-  } else {
-    gamemode_proxy->signal_signal().connect(sigc::mem_fun(*this, &Gamemode::notify_cb));
-  }
+  util::dbus::createProxy(Gio::DBus::BusType::BUS_TYPE_SESSION, dbus_name, dbus_obj_path,
+                          dbus_interface, cancellable_,
+                          [this](const Glib::RefPtr<Gio::DBus::Proxy>& proxy) {
+                            gamemode_proxy = proxy;
+                            gamemode_signal = gamemode_proxy->signal_signal().connect(
+                                sigc::mem_fun(*this, &Gamemode::notify_cb));
+                            getData();
+                          });
 
   // Connect to Login1 PrepareForSleep signal
-  system_connection = Gio::DBus::Connection::get_sync(Gio::DBus::BusType::BUS_TYPE_SYSTEM);
-  if (!system_connection) {
-    throw std::runtime_error("Unable to connect to the SYSTEM Bus!...");
-  } else {
-    login1_id = system_connection->signal_subscribe(
-        sigc::mem_fun(*this, &Gamemode::prepareForSleep_cb), "org.freedesktop.login1",
-        "org.freedesktop.login1.Manager", "PrepareForSleep", "/org/freedesktop/login1");
-  }
+  util::dbus::getConnection(
+      Gio::DBus::BusType::BUS_TYPE_SYSTEM, cancellable_,
+      [this](const Glib::RefPtr<Gio::DBus::Connection>& connection) {
+        system_connection = connection;
+        login1_id = system_connection->signal_subscribe(
+            sigc::mem_fun(*this, &Gamemode::prepareForSleep_cb), "org.freedesktop.login1",
+            "org.freedesktop.login1.Manager", "PrepareForSleep", "/org/freedesktop/login1");
+      });
 
   event_box_.signal_button_press_event().connect(sigc::mem_fun(*this, &Gamemode::handleToggle));
 }
 
 Gamemode::~Gamemode() {
+  cancellable_->cancel();
+  gamemode_signal.disconnect();
   if (gamemode_proxy) gamemode_proxy.reset();
   if (gamemodeWatcher_id > 0) {
     Gio::DBus::unwatch_name(gamemodeWatcher_id);
@@ -120,35 +128,35 @@ Gamemode::~Gamemode() {
   }
 }
 
-// Gets the DBus ClientCount
+// Requests the DBus ClientCount, the module is redrawn once it arrives
 void Gamemode::getData() {
-  if (gamemodeRunning && gamemode_proxy) {
-    try {
-      // Get game count
-      auto parameters = Glib::VariantContainerBase(
-          g_variant_new("(ss)", dbus_get_interface.c_str(), "ClientCount"));
-      Glib::VariantContainerBase data = gamemode_proxy->call_sync("Get", parameters);
-      if (data && data.is_of_type(Glib::VariantType("(v)"))) {
-        Glib::VariantBase variant;
-        g_variant_get(data.gobj_copy(), "(v)", &variant);
-        if (variant && variant.is_of_type(Glib::VARIANT_TYPE_INT32)) {
-          g_variant_get(variant.gobj_copy(), "i", &gameCount);
-          return;
-        }
-      }
-    } catch (Glib::Error& e) {
-      spdlog::error("Gamemode Error {}", e.what().c_str());
-    }
+  if (!gamemodeRunning || !gamemode_proxy) {
+    gameCount = 0;
+    dp.emit();
+    return;
+  }
+  util::dbus::getProperty(gamemode_proxy, dbus_get_interface, "ClientCount", cancellable_,
+                          [this](const Glib::VariantBase& value) { setGameCount(value); });
+}
+
+void Gamemode::setGameCount(const Glib::VariantBase& value) {
+  if (value.is_of_type(Glib::VARIANT_TYPE_INT32)) {
+    gameCount = Glib::VariantBase::cast_dynamic<Glib::Variant<gint32>>(value).get();
+  } else {
+    gameCount = 0;
   }
-  gameCount = 0;
+  dp.emit();
 }
 
 // Whenever the DBus ClientCount changes
 void Gamemode::notify_cb(const Glib::ustring& sender_name, const Glib::ustring& signal_name,
                          const Glib::VariantContainerBase& arguments) {
   if (signal_name == "PropertiesChanged") {
-    getData();
-    dp.emit();
+    if (auto count = util::dbus::changedProperty(arguments, "ClientCount")) {
+      setGameCount(*count);
+    } else {
+      getData();
+    }
   }
 }
 
@@ -163,7 +171,6 @@ void Gamemode::prepareForSleep_cb(const Glib::RefPtr<Gio::DBus::Connection>& con
     g_variant_get(parameters.gobj_copy(), "(b)", &sleeping);
     if (!sleeping) {
       getData();
-      dp.emit();
     }
   }
 }
@@ -174,7 +181,6 @@ void Gamemode::appear(const Glib::RefPtr<Gio::DBus::Connection>& connection,
   gamemodeRunning = true;
   event_box_.set_visible(true);
   getData();
-  dp.emit();
 }
 // When the gamemode name disappears
 void Gamemode::disappear(const Glib::RefPtr<Gio::DBus::Connection>& connection,
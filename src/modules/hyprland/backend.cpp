@@ -13,6 +13,8 @@
 #include <string>
 #include <thread>
 
+#include "util/metrics.hpp"
+
 namespace waybar::modules::hyprland {
 
 std::filesystem::path IPC::socketFolder_;
@@ -41,10 +43,23 @@ std::filesystem::path IPC::getSocketFolder(const char* instanceSig) {
   return socketFolder_;
 }
 
+IPC::~IPC() {
+  {
+    std::lock_guard lock(socketMutex_);
+    stopping_ = true;
+    if (socketfd_ != -1) {
+      shutdown(socketfd_, SHUT_RDWR);
+    }
+  }
+  if (ipcThread_.joinable()) {
+    ipcThread_.join();
+  }
+}
+
 void IPC::startIPC() {
   // will start IPC and relay events to parseIPC
 
-  std::thread([&]() {
+  ipcThread_ = std::thread([this]() {
     // check for hyprland
     const char* his = getenv("HYPRLAND_INSTANCE_SIGNATURE");
 
@@ -65,6 +80,22 @@ void IPC::startIPC() {
       return;
     }
 
+    {
+      std::lock_guard lock(socketMutex_);
+      if (stopping_) {
+        close(socketfd);
+        return;
+      }
+      socketfd_ = socketfd;
+    }
+    const auto closeSocket = [this](int fd) {
+      {
+        std::lock_guard lock(socketMutex_);
+        socketfd_ = -1;
+      }
+      close(fd);
+    };
+
     addr.sun_family = AF_UNIX;
 
     auto socketPath = IPC::getSocketFolder(his) / ".socket2.sock";
@@ -76,10 +107,16 @@ void IPC::startIPC() {
 
     if (connect(socketfd, (struct sockaddr*)&addr, l) == -1) {
       spdlog::error("Hyprland IPC: Unable to connect?");
+      closeSocket(socketfd);
       return;
     }
 
+    // Events from now on are queued on the socket, so they apply on top of the loaded state
+    loadState();
+
     auto* file = fdopen(socketfd, "r");
+    auto* ipcBytes = util::metrics::histogram("hyprland", "ipc_bytes");
+    auto* ipcDispatch = util::metrics::histogram("hyprland", "ipc_dispatch_us");
 
     while (true) {
       std::array<char, 1024> buffer;  // Hyprland socket2 events are max 1024 bytes
@@ -87,6 +124,11 @@ void IPC::startIPC() {
       auto* receivedCharPtr = fgets(buffer.data(), buffer.size(), file);
 
       if (receivedCharPtr == nullptr) {
+        std::unique_lock lock(socketMutex_);
+        if (stopping_) {
+          break;
+        }
+        lock.unlock();
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
         continue;
       }
@@ -94,8 +136,12 @@ void IPC::startIPC() {
       std::string messageReceived(buffer.data());
       messageReceived = messageReceived.substr(0, messageReceived.find_first_of('\n'));
       spdlog::debug("hyprland IPC received {}", messageReceived);
+      if (ipcBytes != nullptr) {
+        ipcBytes->record(messageReceived.size());
+      }
 
       try {
+        util::metrics::ScopedTimer timer(ipcDispatch);
         parseIPC(messageReceived);
       } catch (std::exception& e) {
         spdlog::warn("Failed to parse IPC message: {}, reason: {}", messageReceived, e.what());
@@ -105,17 +151,63 @@ void IPC::startIPC() {
 
       std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
-  }).detach();
+
+    // fclose() closes the socket
+    {
+      std::lock_guard lock(socketMutex_);
+      socketfd_ = -1;
+    }
+    fclose(file);
+  });
 }
 
-void IPC::parseIPC(const std::string& ev) {
-  std::string request = ev.substr(0, ev.find_first_of('>'));
-  std::unique_lock lock(callbackMutex_);
+IPCEvent IPCEvent::parse(std::string_view line) {
+  IPCEvent event;
+  auto separator = line.find(">>");
+  event.name = line.substr(0, separator);
+  if (separator == std::string_view::npos) {
+    return event;
+  }
 
-  for (auto& [eventname, handler] : callbacks_) {
-    if (eventname == request) {
-      handler->onEvent(ev);
+  event.payload = line.substr(separator + 2);
+  size_t begin = 0;
+  while (true) {
+    auto comma = event.payload.find(',', begin);
+    event.args.push_back(event.payload.substr(begin, comma - begin));
+    if (comma == std::string_view::npos) {
+      break;
     }
+    begin = comma + 1;
+  }
+  return event;
+}
+
+std::string_view IPCEvent::argsFrom(size_t i) const {
+  if (i >= args.size()) {
+    return {};
+  }
+  return payload.substr(args[i].data() - payload.data());
+}
+
+void IPC::parseIPC(const std::string& ev) {
+  auto event = IPCEvent::parse(ev);
+  updateState(event);
+
+  std::lock_guard dispatchLock(dispatchMutex_);
+  dispatchThread_ = std::this_thread::get_id();
+
+  std::shared_ptr<const Callbacks> callbacks;
+  {
+    std::lock_guard lock(callbackMutex_);
+    callbacks = callbacks_;
+  }
+
+  auto handlers = callbacks->find(event.name);
+  if (handlers == callbacks->end()) {
+    return;
+  }
+  for (auto* handler : handlers->second) {
+    handler->onEvent(event);
   }
 }
 
@@ -125,7 +217,9 @@ void IPC::registerForIPC(const std::string& ev, EventHandler* ev_handler) {
   }
 
   std::unique_lock lock(callbackMutex_);
-  callbacks_.emplace_back(ev, ev_handler);
+  auto callbacks = std::make_shared<Callbacks>(*callbacks_);
+  (*callbacks)[ev].push_back(ev_handler);
+  callbacks_ = std::move(callbacks);
 }
 
 void IPC::unregisterForIPC(EventHandler* ev_handler) {
@@ -133,15 +227,135 @@ void IPC::unregisterForIPC(EventHandler* ev_handler) {
     return;
   }
 
-  std::unique_lock lock(callbackMutex_);
+  {
+    std::unique_lock lock(callbackMutex_);
+    auto callbacks = std::make_shared<Callbacks>(*callbacks_);
+    for (auto it = callbacks->begin(); it != callbacks->end();) {
+      std::erase(it->second, ev_handler);
+      it = it->second.empty() ? callbacks->erase(it) : std::next(it);
+    }
+    callbacks_ = std::move(callbacks);
+  }
+
+  // The handler may still be receiving an event dispatched from the previous registrations; wait
+  // for it unless it is unregistering from inside its own onEvent()
+  if (dispatchThread_ != std::this_thread::get_id()) {
+    std::lock_guard dispatchLock(dispatchMutex_);
+  }
+}
+
+std::shared_ptr<const State> IPC::state() const {
+  std::lock_guard lock(stateMutex_);
+  return state_;
+}
+
+void IPC::publish(WindowIndex windows) {
+  auto next = std::make_shared<State>();
+  next->windows_ = std::move(windows);
+  std::lock_guard lock(stateMutex_);
+  next->generation_ = state_->generation_ + 1;
+  state_ = std::move(next);
+}
+
+void IPC::loadState() {
+  Json::Value workspaces;
+  try {
+    workspaces = getSocket1JsonReply("workspaces");
+  } catch (const std::exception& e) {
+    spdlog::warn("Hyprland IPC: failed to load workspaces: {}", e.what());
+  }
+  {
+    std::lock_guard lock(updateMutex_);
+    for (const auto& workspace : workspaces) {
+      workspaceNames_[std::to_string(workspace["id"].asInt())] = workspace["name"].asString();
+    }
+  }
+  resyncWindows();
+}
+
+void IPC::resyncWindows() {
+  Json::Value clients;
+  try {
+    clients = getSocket1JsonReply("clients");
+  } catch (const std::exception& e) {
+    spdlog::warn("Hyprland IPC: failed to load windows: {}", e.what());
+    return;
+  }
+  resyncWindows(clients);
+}
+
+void IPC::resyncWindows(const Json::Value& clients) {
+  if (!clients.isArray()) {
+    return;
+  }
+  spdlog::debug("Hyprland IPC: reloading windows");
+  WindowIndex windows;
+  windows.rebuild(clients);
+  std::lock_guard lock(updateMutex_);
+  publish(std::move(windows));
+}
+
+void IPC::updateState(const IPCEvent& event) {
+  const auto& name = event.name;
+  const auto& args = event.args;
+  bool resync = false;
+  {
+    std::lock_guard lock(updateMutex_);
+    if (name == "createworkspacev2" && args.size() >= 2) {
+      workspaceNames_[std::string(args[0])] = std::string(event.argsFrom(1));
+      return;
+    }
+    if (name == "destroyworkspacev2" && !args.empty()) {
+      workspaceNames_.erase(std::string(args[0]));
+      return;
+    }
+    if (name != "openwindow" && name != "closewindow" && name != "movewindowv2" &&
+        name != "windowtitlev2" && name != "renameworkspace") {
+      return;
+    }
 
-  for (auto it = callbacks_.begin(); it != callbacks_.end();) {
-    auto& [eventname, handler] = *it;
-    if (handler == ev_handler) {
-      callbacks_.erase(it++);
-    } else {
-      ++it;
+    // Shares the windows with the published version until one of them changes
+    auto windows = state()->windows();
+    bool changed = false;
+    if (name == "openwindow" && args.size() >= 4) {
+      // openwindow>>ADDR,WSNAME,CLASS,TITLE
+      windows.insert(std::string(args[0]), std::string(args[1]), std::string(args[2]),
+                     std::string(event.argsFrom(3)));
+      changed = true;
+    } else if (name == "closewindow" && !args.empty()) {
+      changed = windows.erase(std::string(event.payload)).has_value();
+    } else if (name == "movewindowv2" && args.size() >= 3) {
+      // movewindowv2>>ADDR,WSID,WSNAME
+      std::string addr(args[0]);
+      if (const auto* window = windows.find(addr); window != nullptr) {
+        windows.insert(addr, std::string(event.argsFrom(2)), window->windowClass,
+                       window->windowTitle);
+        changed = true;
+      } else {
+        resync = true;
+      }
+    } else if (name == "windowtitlev2" && args.size() >= 2) {
+      // windowtitlev2>>ADDR,TITLE
+      changed = windows.setTitle(std::string(args[0]), std::string(event.argsFrom(1)));
+    } else if (name == "renameworkspace" && args.size() >= 2) {
+      // renameworkspace>>WSID,NEWNAME
+      std::string newName(event.argsFrom(1));
+      auto& oldName = workspaceNames_[std::string(args[0])];
+      if (!oldName.empty()) {
+        windows.renameWorkspace(oldName, newName);
+        changed = true;
+      } else {
+        // Created before the names were loaded, its windows are listed under an unknown name
+        resync = true;
+      }
+      oldName = std::move(newName);
     }
+    if (changed) {
+      publish(std::move(windows));
+    }
+  }
+  if (resync) {
+    resyncWindows();
   }
 }
 
@@ -67,10 +67,14 @@ auto Language::update() -> void {
   ALabel::update();
 }
 
-void Language::onEvent(const std::string& ev) {
+void Language::onEvent(const IPCEvent& ev) {
   std::lock_guard<std::mutex> lg(mutex_);
-  std::string kbName(begin(ev) + ev.find_last_of('>') + 1, begin(ev) + ev.find_first_of(','));
-  auto layoutName = ev.substr(ev.find_last_of(',') + 1);
+  // activelayout>>KEYBOARDNAME,LAYOUTNAME
+  if (ev.args.size() < 2) {
+    return;
+  }
+  std::string kbName(ev.args.front());
+  std::string layoutName(ev.args.back());
 
   if (config_.isMember("keyboard-name") && kbName != config_["keyboard-name"].asString())
     return;  // ignore
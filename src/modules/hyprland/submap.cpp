@@ -65,15 +65,14 @@ auto Submap::update() -> void {
   ALabel::update();
 }
 
-void Submap::onEvent(const std::string& ev) {
+void Submap::onEvent(const IPCEvent& ev) {
   std::lock_guard<std::mutex> lg(mutex_);
 
-  if (ev.find("submap") == std::string::npos) {
+  if (ev.name != "submap") {
     return;
   }
 
-  auto submapName = ev.substr(ev.find_last_of('>') + 1);
-  submapName = waybar::util::sanitize_string(submapName);
+  auto submapName = waybar::util::sanitize_string(std::string(ev.payload));
 
   if (!submap_.empty()) {
     label_.get_style_context()->remove_class(submap_);
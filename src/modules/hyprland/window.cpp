@@ -15,7 +15,9 @@
 namespace waybar::modules::hyprland {
 
 Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
-    : AAppIconLabel(config, "window", id, "{title}", 0, true), bar_(bar) {
+    : AAppIconLabel(config, "window", id, "{title}", 0, true),
+      bar_(bar),
+      rewrite_(config["rewrite"]) {
   modulesReady = true;
   separateOutputs_ = config["separate-outputs"].asBool();
 
@@ -52,12 +54,11 @@ auto Window::update() -> void {
 
   if (!format_.empty()) {
     label_.show();
-    label_.set_markup(waybar::util::rewriteString(
-        fmt::format(fmt::runtime(format_), fmt::arg("title", windowName),
-                    fmt::arg("initialTitle", windowData_.initial_title),
-                    fmt::arg("class", windowData_.class_name),
-                    fmt::arg("initialClass", windowData_.initial_class_name)),
-        config_["rewrite"]));
+    label_.set_markup(rewrite_.apply(fmt::format(
+        fmt::runtime(format_), fmt::arg("title", windowName),
+        fmt::arg("initialTitle", windowData_.initial_title),
+        fmt::arg("class", windowData_.class_name),
+        fmt::arg("initialClass", windowData_.initial_class_name))));
   } else {
     label_.hide();
   }
@@ -214,7 +215,7 @@ void Window::queryActiveWorkspace() {
   }
 }
 
-void Window::onEvent(const std::string& ev) {
+void Window::onEvent(const IPCEvent& ev) {
   queryActiveWorkspace();
 
   dp.emit();
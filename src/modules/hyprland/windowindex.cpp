@@ -0,0 +1,116 @@
+#include "modules/hyprland/windowindex.hpp"
+
+#include <charconv>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace waybar::modules::hyprland {
+
+namespace {
+
+// Window addresses are pointers printed in hex. Hyprland's JSON prefixes them with "0x", its
+// events don't.
+std::optional<uint64_t> addressKey(std::string_view address) {
+  if (address.starts_with("0x")) {
+    address.remove_prefix(2);
+  }
+  uint64_t key = 0;
+  const auto* end = address.data() + address.size();
+  auto [ptr, ec] = std::from_chars(address.data(), end, key, 16);
+  if (address.empty() || ec != std::errc() || ptr != end) {
+    return std::nullopt;
+  }
+  return key;
+}
+
+}  // namespace
+
+std::string WindowIndex::workspaceKey(std::string const &name) {
+  return name.starts_with("special:") ? name.substr(8) : name;
+}
+
+void WindowIndex::insert(WindowAddress const &addr, std::string const &workspace_name,
+                         std::string window_class, std::string window_title) {
+  auto key = addressKey(addr);
+  if (!key.has_value()) {
+    return;
+  }
+  erase(addr);
+  auto workspaceName = workspaceKey(workspace_name);
+  ++m_counts[workspaceName];
+  m_windows.set(*key, {std::move(workspaceName), std::move(window_class), std::move(window_title)});
+}
+
+std::optional<std::string> WindowIndex::erase(WindowAddress const &addr) {
+  auto key = addressKey(addr);
+  const auto *window = key.has_value() ? m_windows.find(*key) : nullptr;
+  if (window == nullptr) {
+    return std::nullopt;
+  }
+
+  auto workspaceName = window->workspaceName;
+  m_windows.erase(*key);
+  if (auto count = m_counts.find(workspaceName);
+      count != m_counts.end() && --count->second == 0) {
+    m_counts.erase(count);
+  }
+  return workspaceName;
+}
+
+const WindowIndex::Window *WindowIndex::find(WindowAddress const &addr) const {
+  auto key = addressKey(addr);
+  return key.has_value() ? m_windows.find(*key) : nullptr;
+}
+
+bool WindowIndex::setTitle(WindowAddress const &addr, std::string window_title) {
+  auto key = addressKey(addr);
+  const auto *window = key.has_value() ? m_windows.find(*key) : nullptr;
+  if (window == nullptr) {
+    return false;
+  }
+  auto updated = *window;
+  updated.windowTitle = std::move(window_title);
+  m_windows.set(*key, std::move(updated));
+  return true;
+}
+
+void WindowIndex::renameWorkspace(std::string const &old_name, std::string const &new_name) {
+  const auto oldKey = workspaceKey(old_name);
+  const auto newKey = workspaceKey(new_name);
+  auto count = m_counts.find(oldKey);
+  if (oldKey == newKey || count == m_counts.end()) {
+    return;
+  }
+
+  const auto moved = count->second;
+  m_counts.erase(count);
+  m_counts[newKey] += moved;
+  // Renames are rare, a scan is cheaper than keeping a per-workspace list on every event
+  std::vector<std::pair<uint64_t, Window>> renamed;
+  m_windows.forEach([&](uint64_t key, const Window &window) {
+    if (window.workspaceName == oldKey) {
+      renamed.emplace_back(key, window);
+    }
+  });
+  for (auto &[key, window] : renamed) {
+    window.workspaceName = newKey;
+    m_windows.set(key, std::move(window));
+  }
+}
+
+uint32_t WindowIndex::windowCount(std::string const &workspace_name) const {
+  auto count = m_counts.find(workspaceKey(workspace_name));
+  return count != m_counts.end() ? count->second : 0;
+}
+
+void WindowIndex::rebuild(Json::Value const &clients_json) {
+  m_windows = {};
+  m_counts.clear();
+  for (const auto &client : clients_json) {
+    insert(client["address"].asString(), client["workspace"]["name"].asString(),
+           client["class"].asString(), client["title"].asString());
+  }
+}
+
+}  // namespace waybar::modules::hyprland
@@ -69,14 +69,9 @@ void Workspaces::createWorkspace(Json::Value const &workspace_data,
   spdlog::debug("Creating workspace {}", workspaceName);
 
   // avoid recreating existing workspaces
-  auto workspace = std::find_if(
-      m_workspaces.begin(), m_workspaces.end(),
-      [workspaceName](std::unique_ptr<Workspace> const &w) {
-        return (workspaceName.starts_with("special:") && workspaceName.substr(8) == w->name()) ||
-               workspaceName == w->name();
-      });
+  auto *workspace = findWorkspace(WindowIndex::workspaceKey(workspaceName));
 
-  if (workspace != m_workspaces.end()) {
+  if (workspace != nullptr) {
     // don't recreate workspace, but update persistency if necessary
     const auto keys = workspace_data.getMemberNames();
 
@@ -84,14 +79,14 @@ void Workspaces::createWorkspace(Json::Value const &workspace_data,
     if (std::find(keys.begin(), keys.end(), k) != keys.end()) {
       spdlog::debug("Set dynamic persistency of workspace {} to: {}", workspaceName,
                     workspace_data[k].asBool() ? "true" : "false");
-      (*workspace)->setPersistentRule(workspace_data[k].asBool());
+      workspace->setPersistentRule(workspace_data[k].asBool());
     }
 
     k = "persistent-config";
     if (std::find(keys.begin(), keys.end(), k) != keys.end()) {
       spdlog::debug("Set config persistency of workspace {} to: {}", workspaceName,
                     workspace_data[k].asBool() ? "true" : "false");
-      (*workspace)->setPersistentConfig(workspace_data[k].asBool());
+      workspace->setPersistentConfig(workspace_data[k].asBool());
     }
 
     return;
@@ -128,7 +123,10 @@ void Workspaces::doUpdate() {
   removeWorkspacesToRemove();
   createWorkspacesToCreate();
   updateWorkspaceStates();
-  updateWindowCount();
+  // Counts only change with the windows, createWorkspacesToCreate() counts for new workspaces
+  if (gIPC->state()->generation() != m_windowCountGeneration) {
+    updateWindowCount();
+  }
   sortWorkspaces();
 
   bool anyWindowCreated = updateWindowsToCreate();
@@ -187,6 +185,8 @@ void Workspaces::initializeWorkspaces() {
   // get all current workspaces
   auto const workspacesJson = gIPC->getSocket1JsonReply("workspaces");
   auto const clientsJson = gIPC->getSocket1JsonReply("clients");
+  gIPC->resyncWindows(clientsJson);
+  m_state = gIPC->state();
 
   for (Json::Value workspaceJson : workspacesJson) {
     std::string workspaceName = workspaceJson["name"].asString();
@@ -311,10 +311,10 @@ void Workspaces::loadPersistentWorkspacesFromWorkspaceRules(const Json::Value &c
   }
 }
 
-void Workspaces::onEvent(const std::string &ev) {
+void Workspaces::onEvent(const IPCEvent &ev) {
   std::lock_guard<std::mutex> lock(m_mutex);
-  std::string eventName(begin(ev), begin(ev) + ev.find_first_of('>'));
-  std::string payload = ev.substr(eventName.size() + 2);
+  auto const &eventName = ev.name;
+  std::string payload(ev.payload);
 
   if (eventName == "workspace") {
     onWorkspaceActivated(payload);
@@ -329,21 +329,23 @@ void Workspaces::onEvent(const std::string &ev) {
   } else if (eventName == "moveworkspace") {
     onWorkspaceMoved(payload);
   } else if (eventName == "openwindow") {
-    onWindowOpened(payload);
+    onWindowOpened(ev);
   } else if (eventName == "closewindow") {
     onWindowClosed(payload);
-  } else if (eventName == "movewindow") {
-    onWindowMoved(payload);
+  } else if (eventName == "movewindowv2") {
+    onWindowMoved(ev);
   } else if (eventName == "urgent") {
     setUrgentWorkspace(payload);
   } else if (eventName == "renameworkspace") {
     onWorkspaceRenamed(payload);
-  } else if (eventName == "windowtitle") {
-    onWindowTitleEvent(payload);
+  } else if (eventName == "windowtitlev2") {
+    onWindowTitleEvent(ev);
   } else if (eventName == "configreloaded") {
     onConfigReloaded();
   }
 
+  // The windows as of this event, the next one finds where closed and moved windows were here
+  m_state = gIPC->state();
   dp.emit();
 }
 
@@ -423,6 +425,11 @@ void Workspaces::onWorkspaceRenamed(std::string const &payload) {
       if (workspace->name() == m_activeWorkspaceName) {
         m_activeWorkspaceName = newName;
       }
+      for (auto &window : m_windowsToCreate) {
+        if (window.getWorkspaceName() == workspace->name()) {
+          window.moveToWorksace(newName);
+        }
+      }
       workspace->setName(newName);
       break;
     }
@@ -442,29 +449,31 @@ void Workspaces::onMonitorFocused(std::string const &payload) {
   }
 }
 
-void Workspaces::onWindowOpened(std::string const &payload) {
-  spdlog::trace("Window opened: {}", payload);
-  updateWindowCount();
-  size_t lastCommaIdx = 0;
-  size_t nextCommaIdx = payload.find(',');
-  std::string windowAddress = payload.substr(lastCommaIdx, nextCommaIdx - lastCommaIdx);
-
-  lastCommaIdx = nextCommaIdx;
-  nextCommaIdx = payload.find(',', nextCommaIdx + 1);
-  std::string workspaceName = payload.substr(lastCommaIdx + 1, nextCommaIdx - lastCommaIdx - 1);
-
-  lastCommaIdx = nextCommaIdx;
-  nextCommaIdx = payload.find(',', nextCommaIdx + 1);
-  std::string windowClass = payload.substr(lastCommaIdx + 1, nextCommaIdx - lastCommaIdx - 1);
-
-  std::string windowTitle = payload.substr(nextCommaIdx + 1, payload.length() - nextCommaIdx);
+void Workspaces::onWindowOpened(IPCEvent const &ev) {
+  spdlog::trace("Window opened: {}", ev.payload);
+  // openwindow>>ADDR,WSNAME,CLASS,TITLE
+  if (ev.args.size() < 4) {
+    spdlog::warn("Malformed openwindow event: {}", ev.payload);
+    return;
+  }
+  std::string windowAddress(ev.args[0]);
+  std::string workspaceName(ev.args[1]);
+  std::string windowClass(ev.args[2]);
+  std::string windowTitle(ev.argsFrom(3));
 
   m_windowsToCreate.emplace_back(workspaceName, windowAddress, windowClass, windowTitle);
 }
 
 void Workspaces::onWindowClosed(std::string const &addr) {
   spdlog::trace("Window closed: {}", addr);
-  updateWindowCount();
+  // The state no longer has the window, the version of the previous event knows where it was
+  if (const auto *window = m_state->windows().find(addr); window != nullptr) {
+    if (auto *workspace = findWorkspace(window->workspaceName); workspace != nullptr) {
+      workspace->closeWindow(addr);
+      return;
+    }
+  }
+
   for (auto &workspace : m_workspaces) {
     if (workspace->closeWindow(addr)) {
       break;
@@ -472,14 +481,21 @@ void Workspaces::onWindowClosed(std::string const &addr) {
   }
 }
 
-void Workspaces::onWindowMoved(std::string const &payload) {
-  spdlog::trace("Window moved: {}", payload);
-  updateWindowCount();
-  size_t lastCommaIdx = 0;
-  size_t nextCommaIdx = payload.find(',');
-  std::string windowAddress = payload.substr(lastCommaIdx, nextCommaIdx - lastCommaIdx);
+void Workspaces::onWindowMoved(IPCEvent const &ev) {
+  spdlog::trace("Window moved: {}", ev.payload);
+  // movewindowv2>>ADDR,WSID,WSNAME
+  if (ev.args.size() < 3) {
+    spdlog::warn("Malformed movewindowv2 event: {}", ev.payload);
+    return;
+  }
+  std::string windowAddress(ev.args[0]);
+  std::string workspaceName(ev.argsFrom(2));
 
-  std::string workspaceName = payload.substr(nextCommaIdx + 1, payload.length() - nextCommaIdx);
+  // The state already has the window on its new workspace
+  std::optional<std::string> oldWorkspaceName;
+  if (const auto *window = m_state->windows().find(windowAddress); window != nullptr) {
+    oldWorkspaceName = window->workspaceName;
+  }
 
   std::string windowRepr;
 
@@ -493,10 +509,15 @@ void Workspaces::onWindowMoved(std::string const &payload) {
   }
 
   // Take the window's representation from the old workspace...
-  for (auto &workspace : m_workspaces) {
-    if (auto windowAddr = workspace->closeWindow(windowAddress); windowAddr != std::nullopt) {
-      windowRepr = windowAddr.value();
-      break;
+  auto *oldWorkspace = oldWorkspaceName.has_value() ? findWorkspace(*oldWorkspaceName) : nullptr;
+  if (oldWorkspace != nullptr) {
+    windowRepr = oldWorkspace->closeWindow(windowAddress).value_or("");
+  } else {
+    for (auto &workspace : m_workspaces) {
+      if (auto windowAddr = workspace->closeWindow(windowAddress); windowAddr != std::nullopt) {
+        windowRepr = windowAddr.value();
+        break;
+      }
     }
   }
 
@@ -511,17 +532,24 @@ void Workspaces::onWindowMoved(std::string const &payload) {
   }
 }
 
-void Workspaces::onWindowTitleEvent(std::string const &payload) {
-  spdlog::trace("Window title changed: {}", payload);
+void Workspaces::onWindowTitleEvent(IPCEvent const &ev) {
+  spdlog::trace("Window title changed: {}", ev.payload);
+  // windowtitlev2>>ADDR,TITLE
+  if (ev.args.size() < 2) {
+    spdlog::warn("Malformed windowtitlev2 event: {}", ev.payload);
+    return;
+  }
+  std::string windowAddress(ev.args[0]);
+  std::string windowTitle(ev.argsFrom(1));
   std::optional<std::function<void(WindowCreationPayload)>> inserter;
 
   // If the window was an orphan, rename it at the orphan's vector
-  if (m_orphanWindowMap.contains(payload)) {
+  if (m_orphanWindowMap.contains(windowAddress)) {
     inserter = [this](WindowCreationPayload wcp) { this->registerOrphanWindow(std::move(wcp)); };
   } else {
-    auto windowWorkspace =
-        std::find_if(m_workspaces.begin(), m_workspaces.end(),
-                     [payload](auto &workspace) { return workspace->containsWindow(payload); });
+    auto windowWorkspace = std::find_if(
+        m_workspaces.begin(), m_workspaces.end(),
+        [&windowAddress](auto &workspace) { return workspace->containsWindow(windowAddress); });
 
     // If the window exists on a workspace, rename it at the workspace's window
     // map
@@ -530,9 +558,10 @@ void Workspaces::onWindowTitleEvent(std::string const &payload) {
         (*windowWorkspace)->insertWindow(std::move(wcp));
       };
     } else {
-      auto queuedWindow = std::find_if(
-          m_windowsToCreate.begin(), m_windowsToCreate.end(),
-          [payload](auto &windowPayload) { return windowPayload.getAddress() == payload; });
+      auto queuedWindow = std::find_if(m_windowsToCreate.begin(), m_windowsToCreate.end(),
+                                       [&windowAddress](auto &windowPayload) {
+                                         return windowPayload.getAddress() == windowAddress;
+                                       });
 
       // If the window was queued, rename it in the queue
       if (queuedWindow != m_windowsToCreate.end()) {
@@ -541,18 +570,18 @@ void Workspaces::onWindowTitleEvent(std::string const &payload) {
     }
   }
 
-  if (inserter.has_value()) {
-    Json::Value clientsData = gIPC->getSocket1JsonReply("clients");
-    std::string jsonWindowAddress = fmt::format("0x{}", payload);
-
-    auto client =
-        std::find_if(clientsData.begin(), clientsData.end(), [jsonWindowAddress](auto &client) {
-          return client["address"].asString() == jsonWindowAddress;
-        });
-
-    if (!client->empty()) {
-      (*inserter)({*client});
-    }
+  if (!inserter.has_value()) {
+    return;
+  }
+  auto state = gIPC->state();
+  const auto *window = state->windows().find(windowAddress);
+  if (window == nullptr) {
+    gIPC->resyncWindows();
+    state = gIPC->state();
+    window = state->windows().find(windowAddress);
+  }
+  if (window != nullptr) {
+    (*inserter)({window->workspaceName, windowAddress, window->windowClass, windowTitle});
   }
 }
 
@@ -669,15 +698,15 @@ auto Workspaces::registerIpc() -> void {
   gIPC->registerForIPC("renameworkspace", this);
   gIPC->registerForIPC("openwindow", this);
   gIPC->registerForIPC("closewindow", this);
-  gIPC->registerForIPC("movewindow", this);
+  gIPC->registerForIPC("movewindowv2", this);
   gIPC->registerForIPC("urgent", this);
   gIPC->registerForIPC("configreloaded", this);
 
   if (windowRewriteConfigUsesTitle()) {
     spdlog::info(
-        "Registering for Hyprland's 'windowtitle' events because a user-defined window "
+        "Registering for Hyprland's 'windowtitlev2' events because a user-defined window "
         "rewrite rule uses the 'title' field.");
-    gIPC->registerForIPC("windowtitle", this);
+    gIPC->registerForIPC("windowtitlev2", this);
   }
 }
 
@@ -707,6 +736,7 @@ void Workspaces::removeWorkspace(std::string const &name) {
 
   m_box.remove(workspace->get()->button());
   m_workspaces.erase(workspace);
+  reindexWorkspaces();
 }
 
 void Workspaces::setCurrentMonitorId() {
@@ -785,50 +815,49 @@ void Workspaces::sortWorkspaces() {
   for (size_t i = 0; i < m_workspaces.size(); ++i) {
     m_box.reorder_child(m_workspaces[i]->button(), i);
   }
+  reindexWorkspaces();
 }
 
 void Workspaces::setUrgentWorkspace(std::string const &windowaddress) {
-  const Json::Value clientsJson = gIPC->getSocket1JsonReply("clients");
-  int workspaceId = -1;
+  auto state = gIPC->state();
+  const auto *window = state->windows().find(windowaddress);
+  if (window == nullptr) {
+    gIPC->resyncWindows();
+    state = gIPC->state();
+    window = state->windows().find(windowaddress);
+  }
+  if (window == nullptr) {
+    return;
+  }
 
-  for (Json::Value clientJson : clientsJson) {
-    if (clientJson["address"].asString().ends_with(windowaddress)) {
-      workspaceId = clientJson["workspace"]["id"].asInt();
-      break;
-    }
+  if (auto *workspace = findWorkspace(window->workspaceName); workspace != nullptr) {
+    workspace->setUrgent();
   }
+}
 
-  auto workspace =
-      std::find_if(m_workspaces.begin(), m_workspaces.end(),
-                   [workspaceId](std::unique_ptr<Workspace> &x) { return x->id() == workspaceId; });
-  if (workspace != m_workspaces.end()) {
-    workspace->get()->setUrgent();
+void Workspaces::reindexWorkspaces() {
+  m_workspaceIndex.clear();
+  for (auto &workspace : m_workspaces) {
+    m_workspaceIndex.emplace(workspace->name(), workspace.get());
   }
 }
 
+Workspace *Workspaces::findWorkspace(std::string const &name) {
+  auto workspace = m_workspaceIndex.find(name);
+  return workspace != m_workspaceIndex.end() ? workspace->second : nullptr;
+}
+
 auto Workspaces::update() -> void {
   doUpdate();
   AModule::update();
 }
 
 void Workspaces::updateWindowCount() {
-  const Json::Value workspacesJson = gIPC->getSocket1JsonReply("workspaces");
+  auto state = gIPC->state();
   for (auto &workspace : m_workspaces) {
-    auto workspaceJson =
-        std::find_if(workspacesJson.begin(), workspacesJson.end(), [&](Json::Value const &x) {
-          return x["name"].asString() == workspace->name() ||
-                 (workspace->isSpecial() && x["name"].asString() == "special:" + workspace->name());
-        });
-    uint32_t count = 0;
-    if (workspaceJson != workspacesJson.end()) {
-      try {
-        count = (*workspaceJson)["windows"].asUInt();
-      } catch (const std::exception &e) {
-        spdlog::error("Failed to update window count: {}", e.what());
-      }
-    }
-    workspace->setWindows(count);
+    workspace->setWindows(state->windows().windowCount(workspace->name()));
   }
+  m_windowCountGeneration = state->generation();
 }
 
 bool Workspaces::updateWindowsToCreate() {
@@ -6,6 +6,9 @@ waybar::modules::Memory::Memory(const std::string& id, const Json::Value& config
     dp.emit();
     thread_.sleep_for(interval_);
   };
+  if (tooltipEnabled()) {
+    setTooltipProducer(label_, [this] { return formatTooltip(); }, false);
+  }
 }
 
 auto waybar::modules::Memory::update() -> void {
@@ -66,17 +69,17 @@ auto waybar::modules::Memory::update() -> void {
     }
 
     if (tooltipEnabled()) {
-      if (config_["tooltip-format"].isString()) {
-        auto tooltip_format = config_["tooltip-format"].asString();
-        label_.set_tooltip_text(fmt::format(
-            fmt::runtime(tooltip_format), used_ram_percentage,
-            fmt::arg("total", total_ram_gigabytes), fmt::arg("swapTotal", total_swap_gigabytes),
-            fmt::arg("percentage", used_ram_percentage),
-            fmt::arg("swapPercentage", used_swap_percentage), fmt::arg("used", used_ram_gigabytes),
-            fmt::arg("swapUsed", used_swap_gigabytes), fmt::arg("avail", available_ram_gigabytes),
-            fmt::arg("swapAvail", available_swap_gigabytes)));
-      } else {
-        label_.set_tooltip_text(fmt::format("{:.{}f}GiB used", used_ram_gigabytes, 1));
+      TooltipValues tooltip{.total_ram_gigabytes = total_ram_gigabytes,
+                            .total_swap_gigabytes = total_swap_gigabytes,
+                            .used_ram_percentage = used_ram_percentage,
+                            .used_swap_percentage = used_swap_percentage,
+                            .used_ram_gigabytes = used_ram_gigabytes,
+                            .used_swap_gigabytes = used_swap_gigabytes,
+                            .available_ram_gigabytes = available_ram_gigabytes,
+                            .available_swap_gigabytes = available_swap_gigabytes};
+      if (tooltip != tooltip_) {
+        tooltip_ = tooltip;
+        invalidateTooltip();
       }
     }
   } else {
@@ -85,3 +88,17 @@ auto waybar::modules::Memory::update() -> void {
   // Call parent update
   ALabel::update();
 }
+
+std::string waybar::modules::Memory::formatTooltip() const {
+  const auto& t = tooltip_;
+  if (!config_["tooltip-format"].isString()) {
+    return fmt::format("{:.{}f}GiB used", t.used_ram_gigabytes, 1);
+  }
+  auto tooltip_format = config_["tooltip-format"].asString();
+  return fmt::format(
+      fmt::runtime(tooltip_format), t.used_ram_percentage, fmt::arg("total", t.total_ram_gigabytes),
+      fmt::arg("swapTotal", t.total_swap_gigabytes), fmt::arg("percentage", t.used_ram_percentage),
+      fmt::arg("swapPercentage", t.used_swap_percentage), fmt::arg("used", t.used_ram_gigabytes),
+      fmt::arg("swapUsed", t.used_swap_gigabytes), fmt::arg("avail", t.available_ram_gigabytes),
+      fmt::arg("swapAvail", t.available_swap_gigabytes));
+}
@@ -1,15 +1,19 @@
 #include "modules/network.hpp"
 
+#include <fcntl.h>
 #include <linux/if.h>
 #include <spdlog/spdlog.h>
 #include <sys/eventfd.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <cassert>
-#include <fstream>
+#include <cstring>
 #include <optional>
-#include <sstream>
+#include <string_view>
 
 #include "util/format.hpp"
+#include "util/netdev.hpp"
 #ifdef WANT_RFKILL
 #include "util/rfkill.hpp"
 #endif
@@ -19,62 +23,34 @@ using namespace waybar::util;
 constexpr const char *DEFAULT_FORMAT = "{ifname}";
 }  // namespace
 
-constexpr const char *NETDEV_FILE =
-    "/proc/net/dev";  // std::ifstream does not take std::string_view as param
+constexpr const char *NETDEV_FILE = "/proc/net/dev";
 std::optional<std::pair<unsigned long long, unsigned long long>>
 waybar::modules::Network::readBandwidthUsage() {
-  std::ifstream netdev(NETDEV_FILE);
-  if (!netdev) {
-    spdlog::warn("Failed to open netdev file {}", NETDEV_FILE);
-    return {};
-  }
-
-  std::string line;
-  // skip the headers (first two lines)
-  std::getline(netdev, line);
-  std::getline(netdev, line);
-
-  unsigned long long receivedBytes = 0ull;
-  unsigned long long transmittedBytes = 0ull;
-  while (std::getline(netdev, line)) {
-    std::istringstream iss(line);
-
-    std::string ifacename;
-    iss >> ifacename;      // ifacename contains "eth0:"
-    ifacename.pop_back();  // remove trailing ':'
-    if (ifacename != ifname_) {
-      continue;
+  if (netdev_fd_ < 0) {
+    netdev_fd_ = open(NETDEV_FILE, O_RDONLY | O_CLOEXEC);
+    if (netdev_fd_ < 0) {
+      spdlog::warn("Failed to open netdev file {}", NETDEV_FILE);
+      return {};
     }
+  }
 
-    // The rest of the line consists of whitespace separated counts divided
-    // into two groups (receive and transmit). Each group has the following
-    // columns: bytes, packets, errs, drop, fifo, frame, compressed, multicast
-    //
-    // We only care about the bytes count, so we'll just ignore the 7 other
-    // columns.
-    unsigned long long r = 0ull;
-    unsigned long long t = 0ull;
-    // Read received bytes
-    iss >> r;
-    // Skip all the other columns in the received group
-    for (int colsToSkip = 7; colsToSkip > 0; colsToSkip--) {
-      // skip whitespace between columns
-      while (iss.peek() == ' ') {
-        iss.ignore();
-      }
-      // skip the irrelevant column
-      while (iss.peek() != ' ') {
-        iss.ignore();
-      }
+  // Re-read the whole file from the kept open descriptor into the reusable buffer
+  size_t len = 0;
+  while (true) {
+    if (netdev_buf_.size() - len < 1024) {
+      netdev_buf_.resize(std::max<size_t>(4096, netdev_buf_.size() * 2));
     }
-    // Read transmit bytes
-    iss >> t;
-
-    receivedBytes += r;
-    transmittedBytes += t;
+    auto n = pread(netdev_fd_, netdev_buf_.data() + len, netdev_buf_.size() - len, len);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      spdlog::warn("Failed to read netdev file {}: {}", NETDEV_FILE, strerror(errno));
+      return {};
+    }
+    if (n == 0) break;
+    len += n;
   }
 
-  return {{receivedBytes, transmittedBytes}};
+  return util::parseNetdevBytes(std::string_view(netdev_buf_.data(), len), ifname_);
 }
 
 waybar::modules::Network::Network(const std::string &id, const Json::Value &config)
@@ -125,6 +101,10 @@ waybar::modules::Network::Network(const std::string &id, const Json::Value &conf
   createEventSocket();
   createInfoSocket();
 
+  if (tooltipEnabled()) {
+    setTooltipProducer(label_, [this] { return formatTooltip(); });
+  }
+
   dp.emit();
   // Ask for a dump of interfaces and then addresses to populate our
   // information. First the interface dump, and once done, the callback
@@ -134,6 +114,9 @@ waybar::modules::Network::Network(const std::string &id, const Json::Value &conf
 }
 
 waybar::modules::Network::~Network() {
+  if (netdev_fd_ > -1) {
+    close(netdev_fd_);
+  }
   if (ev_fd_ > -1) {
     close(ev_fd_);
   }
@@ -362,32 +345,27 @@ auto waybar::modules::Network::update() -> void {
     if (tooltip_format.empty() && config_["tooltip-format"].isString()) {
       tooltip_format = config_["tooltip-format"].asString();
     }
-    if (!tooltip_format.empty()) {
-      auto tooltip_text = fmt::format(
-          fmt::runtime(tooltip_format), fmt::arg("essid", essid_), fmt::arg("bssid", bssid_),
-          fmt::arg("signaldBm", signal_strength_dbm_), fmt::arg("signalStrength", signal_strength_),
-          fmt::arg("signalStrengthApp", signal_strength_app_), fmt::arg("ifname", ifname_),
-          fmt::arg("netmask", netmask_), fmt::arg("ipaddr", ipaddr_), fmt::arg("gwaddr", gwaddr_),
-          fmt::arg("cidr", cidr_), fmt::arg("frequency", fmt::format("{:.1f}", frequency_)),
-          fmt::arg("icon", getIcon(signal_strength_, state_)),
-          fmt::arg("bandwidthDownBits",
-                   pow_format(bandwidth_down * 8ull / interval_.count(), "b/s")),
-          fmt::arg("bandwidthUpBits", pow_format(bandwidth_up * 8ull / interval_.count(), "b/s")),
-          fmt::arg("bandwidthTotalBits",
-                   pow_format((bandwidth_up + bandwidth_down) * 8ull / interval_.count(), "b/s")),
-          fmt::arg("bandwidthDownOctets", pow_format(bandwidth_down / interval_.count(), "o/s")),
-          fmt::arg("bandwidthUpOctets", pow_format(bandwidth_up / interval_.count(), "o/s")),
-          fmt::arg("bandwidthTotalOctets",
-                   pow_format((bandwidth_up + bandwidth_down) / interval_.count(), "o/s")),
-          fmt::arg("bandwidthDownBytes", pow_format(bandwidth_down / interval_.count(), "B/s")),
-          fmt::arg("bandwidthUpBytes", pow_format(bandwidth_up / interval_.count(), "B/s")),
-          fmt::arg("bandwidthTotalBytes",
-                   pow_format((bandwidth_up + bandwidth_down) / interval_.count(), "B/s")));
-      if (label_.get_tooltip_text() != tooltip_text) {
-        label_.set_tooltip_markup(tooltip_text);
-      }
-    } else if (label_.get_tooltip_text() != text) {
-      label_.set_tooltip_markup(text);
+    // The producer may run synchronously from invalidateTooltip() while mutex_ is held, so it
+    // only reads this copy, which is owned by the main thread
+    TooltipValues tooltip{.format = std::move(tooltip_format),
+                          .text = text,
+                          .essid = essid_,
+                          .bssid = bssid_,
+                          .signal_strength_dbm = signal_strength_dbm_,
+                          .signal_strength = signal_strength_,
+                          .signal_strength_app = signal_strength_app_,
+                          .ifname = ifname_,
+                          .netmask = netmask_,
+                          .ipaddr = ipaddr_,
+                          .gwaddr = gwaddr_,
+                          .cidr = cidr_,
+                          .frequency = frequency_,
+                          .icon = getIcon(signal_strength_, state_),
+                          .bandwidth_down = bandwidth_down,
+                          .bandwidth_up = bandwidth_up};
+    if (tooltip != tooltip_) {
+      tooltip_ = std::move(tooltip);
+      invalidateTooltip();
     }
   }
 
@@ -395,6 +373,33 @@ auto waybar::modules::Network::update() -> void {
   ALabel::update();
 }
 
+std::string waybar::modules::Network::formatTooltip() const {
+  const auto &t = tooltip_;
+  if (t.format.empty()) {
+    return t.text;
+  }
+  const auto interval = interval_.count();
+  return fmt::format(
+      fmt::runtime(t.format), fmt::arg("essid", t.essid), fmt::arg("bssid", t.bssid),
+      fmt::arg("signaldBm", t.signal_strength_dbm), fmt::arg("signalStrength", t.signal_strength),
+      fmt::arg("signalStrengthApp", t.signal_strength_app), fmt::arg("ifname", t.ifname),
+      fmt::arg("netmask", t.netmask), fmt::arg("ipaddr", t.ipaddr), fmt::arg("gwaddr", t.gwaddr),
+      fmt::arg("cidr", t.cidr), fmt::arg("frequency", fmt::format("{:.1f}", t.frequency)),
+      fmt::arg("icon", t.icon),
+      fmt::arg("bandwidthDownBits", pow_format(t.bandwidth_down * 8ull / interval, "b/s")),
+      fmt::arg("bandwidthUpBits", pow_format(t.bandwidth_up * 8ull / interval, "b/s")),
+      fmt::arg("bandwidthTotalBits",
+               pow_format((t.bandwidth_up + t.bandwidth_down) * 8ull / interval, "b/s")),
+      fmt::arg("bandwidthDownOctets", pow_format(t.bandwidth_down / interval, "o/s")),
+      fmt::arg("bandwidthUpOctets", pow_format(t.bandwidth_up / interval, "o/s")),
+      fmt::arg("bandwidthTotalOctets",
+               pow_format((t.bandwidth_up + t.bandwidth_down) / interval, "o/s")),
+      fmt::arg("bandwidthDownBytes", pow_format(t.bandwidth_down / interval, "B/s")),
+      fmt::arg("bandwidthUpBytes", pow_format(t.bandwidth_up / interval, "B/s")),
+      fmt::arg("bandwidthTotalBytes",
+               pow_format((t.bandwidth_up + t.bandwidth_down) / interval, "B/s")));
+}
+
 bool waybar::modules::Network::checkInterface(std::string name) {
   if (config_["interface"].isString()) {
     return config_["interface"].asString() == name ||
@@ -9,6 +9,9 @@
 #include <sys/un.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
 #include <iostream>
 #include <string>
 #include <thread>
@@ -17,6 +20,7 @@
 #include "giomm/dataoutputstream.h"
 #include "giomm/unixinputstream.h"
 #include "giomm/unixoutputstream.h"
+#include "util/metrics.hpp"
 
 namespace waybar::modules::niri {
 
@@ -82,10 +86,16 @@ void IPC::startIPC() {
       return;
     }
 
+    auto *ipcBytes = util::metrics::histogram("niri", "ipc_bytes");
+    auto *ipcDispatch = util::metrics::histogram("niri", "ipc_dispatch_us");
     while (istream->read_line(line)) {
       spdlog::debug("Niri IPC: received {}", line);
+      if (ipcBytes != nullptr) {
+        ipcBytes->record(line.size());
+      }
 
       try {
+        util::metrics::ScopedTimer timer(ipcDispatch);
         parseIPC(line);
       } catch (std::exception &e) {
         spdlog::warn("Failed to parse IPC message: {}, reason: {}", line, e.what());
@@ -98,111 +108,298 @@ void IPC::startIPC() {
   }).detach();
 }
 
+void StateChanges::merge(const StateChanges &other) {
+  allWorkspaces = allWorkspaces || other.allWorkspaces;
+  allWindows = allWindows || other.allWindows;
+  workspaces.insert(workspaces.end(), other.workspaces.begin(), other.workspaces.end());
+  windows.insert(windows.end(), other.windows.begin(), other.windows.end());
+}
+
+void StateChanges::clear() {
+  allWorkspaces = false;
+  allWindows = false;
+  workspaces.clear();
+  windows.clear();
+}
+
+bool StateChanges::empty() const {
+  return !allWorkspaces && !allWindows && workspaces.empty() && windows.empty();
+}
+
+const std::string *IPC::internOutput(const Json::Value &output) {
+  if (!output.isString()) return nullptr;
+  return &*outputs_.insert(output.asString()).first;
+}
+
+WorkspaceState IPC::parseWorkspace(const Json::Value &ws) {
+  WorkspaceState workspace{
+      .id = ws["id"].asUInt64(),
+      .idx = ws["idx"].asUInt(),
+      .name = std::nullopt,
+      .output = internOutput(ws["output"]),
+      .isActive = ws["is_active"].asBool(),
+      .isFocused = ws["is_focused"].asBool(),
+      .activeWindowId = std::nullopt,
+  };
+  if (ws["name"].isString()) workspace.name = ws["name"].asString();
+  if (!ws["active_window_id"].isNull()) {
+    workspace.activeWindowId = ws["active_window_id"].asUInt64();
+  }
+  return workspace;
+}
+
+WindowState IPC::parseWindow(const Json::Value &win) {
+  WindowState window{
+      .id = win["id"].asUInt64(),
+      .title = win["title"].asString(),
+      .appId = win["app_id"].asString(),
+      .workspaceId = std::nullopt,
+      .isFocused = win["is_focused"].asBool(),
+  };
+  if (!win["workspace_id"].isNull()) window.workspaceId = win["workspace_id"].asUInt64();
+  return window;
+}
+
+void IPC::setWorkspaces(WorkspaceTable &table, const Json::Value &workspaces,
+                        StateChanges &changes) {
+  for (const auto &value : workspaces) {
+    auto ws = parseWorkspace(value);
+    if (ws.isActive && ws.output) table.activeByOutput[*ws.output] = ws.id;
+    if (ws.isFocused) table.focused = ws.id;
+    table.order.push_back(ws.id);
+    table.byId.emplace(ws.id, std::move(ws));
+  }
+
+  std::sort(table.order.begin(), table.order.end(), [&table](auto a, auto b) {
+    const auto &aWs = table.byId.at(a);
+    const auto &bWs = table.byId.at(b);
+    const auto &aOutput = aWs.output ? *aWs.output : std::string();
+    const auto &bOutput = bWs.output ? *bWs.output : std::string();
+    if (aOutput == bOutput) return aWs.idx < bWs.idx;
+    return aOutput < bOutput;
+  });
+
+  changes.allWorkspaces = true;
+}
+
+void IPC::activateWorkspace(WorkspaceTable &table, uint64_t id, bool focused,
+                            StateChanges &changes) {
+  auto it = table.byId.find(id);
+  if (it == table.byId.end()) {
+    spdlog::error("Activated unknown workspace");
+    return;
+  }
+  auto &ws = it->second;
+
+  // Only the previously active (and focused) workspaces change along with the activated one
+  if (ws.output) {
+    auto [active, inserted] = table.activeByOutput.try_emplace(*ws.output, id);
+    if (!inserted && active->second != id) {
+      if (auto prev = table.byId.find(active->second); prev != table.byId.end()) {
+        prev->second.isActive = false;
+        changes.workspaces.push_back(active->second);
+      }
+      active->second = id;
+    }
+  }
+  ws.isActive = true;
+
+  if (focused) {
+    if (table.focused && *table.focused != id) {
+      if (auto prev = table.byId.find(*table.focused); prev != table.byId.end()) {
+        prev->second.isFocused = false;
+        changes.workspaces.push_back(*table.focused);
+      }
+    }
+    table.focused = id;
+    ws.isFocused = true;
+  }
+
+  changes.workspaces.push_back(id);
+}
+
+void IPC::countWindow(WindowTable &table, const WindowState &window, int delta) {
+  if (!window.workspaceId) return;
+  const auto *current = table.countByWorkspace.find(*window.workspaceId);
+  const unsigned count = (current != nullptr ? *current : 0) + delta;
+  if (count == 0)
+    table.countByWorkspace.erase(*window.workspaceId);
+  else
+    table.countByWorkspace.set(*window.workspaceId, count);
+}
+
+void IPC::setWindows(WindowTable &table, const Json::Value &windows, StateChanges &changes) {
+  for (const auto &value : windows) {
+    auto window = parseWindow(value);
+    if (window.isFocused) table.focused = window.id;
+    countWindow(table, window, 1);
+    table.byId.set(window.id, std::move(window));
+  }
+
+  changes.allWindows = true;
+}
+
+void IPC::setWindow(WindowTable &table, WindowState window, StateChanges &changes) {
+  const auto id = window.id;
+  if (window.isFocused)
+    focusWindow(table, id, changes);
+  else if (table.focused == id)
+    table.focused.reset();
+
+  if (const auto *previous = table.byId.find(id); previous != nullptr) {
+    if (previous->workspaceId != window.workspaceId) {
+      countWindow(table, *previous, -1);
+      countWindow(table, window, 1);
+    }
+  } else {
+    countWindow(table, window, 1);
+  }
+  table.byId.set(id, std::move(window));
+
+  changes.windows.push_back(id);
+}
+
+void IPC::removeWindow(WindowTable &table, uint64_t id, StateChanges &changes) {
+  const auto *window = table.byId.find(id);
+  if (window == nullptr) {
+    spdlog::error("Unknown window closed");
+    return;
+  }
+
+  countWindow(table, *window, -1);
+  table.byId.erase(id);
+  if (table.focused == id) table.focused.reset();
+
+  changes.windows.push_back(id);
+}
+
+void IPC::focusWindow(WindowTable &table, std::optional<uint64_t> id, StateChanges &changes) {
+  if (table.focused == id) return;
+
+  const auto setFocused = [&](uint64_t windowId, bool focused) {
+    if (const auto *window = table.byId.find(windowId); window != nullptr) {
+      auto updated = *window;
+      updated.isFocused = focused;
+      table.byId.set(windowId, std::move(updated));
+      changes.windows.push_back(windowId);
+    }
+  };
+  if (table.focused) setFocused(*table.focused, false);
+  table.focused = id;
+  if (id) setFocused(*id, true);
+}
+
 void IPC::parseIPC(const std::string &line) {
   const auto ev = parser_.parse(line);
   const auto members = ev.getMemberNames();
   if (members.size() != 1) throw std::runtime_error("Event must have a single member");
 
-  {
-    auto lock = lockData();
-
-    if (const auto &payload = ev["WorkspacesChanged"]) {
-      workspaces_.clear();
-      const auto &values = payload["workspaces"];
-      std::copy(values.begin(), values.end(), std::back_inserter(workspaces_));
-
-      std::sort(workspaces_.begin(), workspaces_.end(), [](const auto &a, const auto &b) {
-        const auto &aOutput = a["output"].asString();
-        const auto &bOutput = b["output"].asString();
-        const auto aIdx = a["idx"].asUInt();
-        const auto bIdx = b["idx"].asUInt();
-        if (aOutput == bOutput) return aIdx < bIdx;
-        return aOutput < bOutput;
-      });
-    } else if (const auto &payload = ev["WorkspaceActivated"]) {
-      const auto id = payload["id"].asUInt64();
-      const auto focused = payload["focused"].asBool();
-      auto it = std::find_if(workspaces_.begin(), workspaces_.end(),
-                             [id](const auto &ws) { return ws["id"].asUInt64() == id; });
-      if (it != workspaces_.end()) {
-        const auto &ws = *it;
-        const auto &output = ws["output"].asString();
-        for (auto &ws : workspaces_) {
-          const auto got_activated = (ws["id"].asUInt64() == id);
-          if (ws["output"] == output) ws["is_active"] = got_activated;
-
-          if (focused) ws["is_focused"] = got_activated;
-        }
-      } else {
-        spdlog::error("Activated unknown workspace");
-      }
-    } else if (const auto &payload = ev["WorkspaceActiveWindowChanged"]) {
-      const auto workspaceId = payload["workspace_id"].asUInt64();
-      auto it = std::find_if(workspaces_.begin(), workspaces_.end(), [workspaceId](const auto &ws) {
-        return ws["id"].asUInt64() == workspaceId;
-      });
-      if (it != workspaces_.end()) {
-        auto &ws = *it;
-        ws["active_window_id"] = payload["active_window_id"];
-      } else {
-        spdlog::error("Active window changed on unknown workspace");
-      }
-    } else if (const auto &payload = ev["KeyboardLayoutsChanged"]) {
-      const auto &layouts = payload["keyboard_layouts"];
-      const auto &names = layouts["names"];
-      keyboardLayoutCurrent_ = layouts["current_idx"].asUInt();
-
-      keyboardLayoutNames_.clear();
-      for (const auto &fullName : names) keyboardLayoutNames_.push_back(fullName.asString());
-    } else if (const auto &payload = ev["KeyboardLayoutSwitched"]) {
-      keyboardLayoutCurrent_ = payload["idx"].asUInt();
-    } else if (const auto &payload = ev["WindowsChanged"]) {
-      windows_.clear();
-      const auto &values = payload["windows"];
-      std::copy(values.begin(), values.end(), std::back_inserter(windows_));
-    } else if (const auto &payload = ev["WindowOpenedOrChanged"]) {
-      const auto &window = payload["window"];
-      const auto id = window["id"].asUInt64();
-      auto it = std::find_if(windows_.begin(), windows_.end(),
-                             [id](const auto &win) { return win["id"].asUInt64() == id; });
-      if (it == windows_.end()) {
-        windows_.push_back(window);
-
-        if (window["is_focused"].asBool()) {
-          for (auto &win : windows_) {
-            win["is_focused"] = win["id"].asUInt64() == id;
-          }
-        }
-      } else {
-        *it = window;
-      }
-    } else if (const auto &payload = ev["WindowClosed"]) {
-      const auto id = payload["id"].asUInt64();
-      auto it = std::find_if(windows_.begin(), windows_.end(),
-                             [id](const auto &win) { return win["id"].asUInt64() == id; });
-      if (it != windows_.end()) {
-        windows_.erase(it);
-      } else {
-        spdlog::error("Unknown window closed");
-      }
-    } else if (const auto &payload = ev["WindowFocusChanged"]) {
-      const auto focused = !payload["id"].isNull();
-      const auto id = payload["id"].asUInt64();
-      for (auto &win : windows_) {
-        win["is_focused"] = focused && win["id"].asUInt64() == id;
-      }
+  // This thread is the only writer: build the next version from the current one, copying only
+  // the tables the event modifies, then publish it. Copying a WindowTable only copies the roots of
+  // its maps.
+  auto next = std::make_shared<State>(*state());
+  StateChanges changes;
+
+  if (const auto &payload = ev["WorkspacesChanged"]) {
+    auto table = std::make_shared<WorkspaceTable>();
+    setWorkspaces(*table, payload["workspaces"], changes);
+    next->workspaces_ = std::move(table);
+  } else if (const auto &payload = ev["WorkspaceActivated"]) {
+    auto table = std::make_shared<WorkspaceTable>(*next->workspaces_);
+    activateWorkspace(*table, payload["id"].asUInt64(), payload["focused"].asBool(), changes);
+    next->workspaces_ = std::move(table);
+  } else if (const auto &payload = ev["WorkspaceActiveWindowChanged"]) {
+    const auto workspaceId = payload["workspace_id"].asUInt64();
+    auto table = std::make_shared<WorkspaceTable>(*next->workspaces_);
+    auto it = table->byId.find(workspaceId);
+    if (it != table->byId.end()) {
+      const auto &activeWindowId = payload["active_window_id"];
+      if (activeWindowId.isNull())
+        it->second.activeWindowId.reset();
+      else
+        it->second.activeWindowId = activeWindowId.asUInt64();
+      changes.workspaces.push_back(workspaceId);
+      next->workspaces_ = std::move(table);
+    } else {
+      spdlog::error("Active window changed on unknown workspace");
     }
+  } else if (const auto &payload = ev["KeyboardLayoutsChanged"]) {
+    const auto &layouts = payload["keyboard_layouts"];
+    auto table = std::make_shared<KeyboardLayouts>();
+    table->current = layouts["current_idx"].asUInt();
+    for (const auto &fullName : layouts["names"]) table->names.push_back(fullName.asString());
+    next->layouts_ = std::move(table);
+  } else if (const auto &payload = ev["KeyboardLayoutSwitched"]) {
+    auto table = std::make_shared<KeyboardLayouts>(*next->layouts_);
+    table->current = payload["idx"].asUInt();
+    next->layouts_ = std::move(table);
+  } else if (const auto &payload = ev["WindowsChanged"]) {
+    auto table = std::make_shared<WindowTable>();
+    setWindows(*table, payload["windows"], changes);
+    next->windows_ = std::move(table);
+  } else if (const auto &payload = ev["WindowOpenedOrChanged"]) {
+    auto table = std::make_shared<WindowTable>(*next->windows_);
+    setWindow(*table, parseWindow(payload["window"]), changes);
+    next->windows_ = std::move(table);
+  } else if (const auto &payload = ev["WindowClosed"]) {
+    auto table = std::make_shared<WindowTable>(*next->windows_);
+    removeWindow(*table, payload["id"].asUInt64(), changes);
+    next->windows_ = std::move(table);
+  } else if (const auto &payload = ev["WindowFocusChanged"]) {
+    std::optional<uint64_t> id;
+    if (!payload["id"].isNull()) id = payload["id"].asUInt64();
+    auto table = std::make_shared<WindowTable>(*next->windows_);
+    focusWindow(*table, id, changes);
+    next->windows_ = std::move(table);
+  }
+
+  ++next->generation_;
+  {
+    std::lock_guard lock(stateMutex_);
+    state_ = std::move(next);
   }
 
   std::unique_lock lock(callbackMutex_);
 
   for (auto &[eventname, handler] : callbacks_) {
     if (eventname == members[0]) {
+      if (!changes.empty()) handler->onStateChanged(changes);
       handler->onEvent(ev);
     }
   }
 }
 
+std::shared_ptr<const State> IPC::state() const {
+  std::lock_guard lock(stateMutex_);
+  return state_;
+}
+
+State::State()
+    : workspaces_(std::make_shared<WorkspaceTable>()),
+      windows_(std::make_shared<WindowTable>()),
+      layouts_(std::make_shared<KeyboardLayouts>()) {}
+
+const WorkspaceState *State::workspace(uint64_t id) const {
+  auto it = workspaces_->byId.find(id);
+  return it == workspaces_->byId.end() ? nullptr : &it->second;
+}
+
+const WorkspaceState *State::focusedWorkspace() const {
+  return workspaces_->focused ? workspace(*workspaces_->focused) : nullptr;
+}
+
+const WorkspaceState *State::activeWorkspace(const std::string &output) const {
+  auto it = workspaces_->activeByOutput.find(output);
+  return it == workspaces_->activeByOutput.end() ? nullptr : workspace(it->second);
+}
+
+const WindowState *State::window(uint64_t id) const { return windows_->byId.find(id); }
+
+unsigned State::windowCount(uint64_t workspaceId) const {
+  const auto *count = windows_->countByWorkspace.find(workspaceId);
+  return count != nullptr ? *count : 0;
+}
+
 void IPC::registerForIPC(const std::string &ev, EventHandler *ev_handler) {
   if (ev_handler == nullptr) {
     return;
@@ -230,32 +427,77 @@ void IPC::unregisterForIPC(EventHandler *ev_handler) {
 }
 
 Json::Value IPC::send(const Json::Value &request) {
+  // Niri needs the request on a single line.
+  static const auto builder = [] {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return builder;
+  }();
+  const auto line = Json::writeString(builder, request) + '\n';
+
   int socketfd = connectToSocket();
   if (socketfd == -1) throw std::runtime_error("Niri is not running");
 
-  auto unix_istream = Gio::UnixInputStream::create(socketfd, true);
-  auto unix_ostream = Gio::UnixOutputStream::create(socketfd, false);
-  auto istream = Gio::DataInputStream::create(unix_istream);
-  auto ostream = Gio::DataOutputStream::create(unix_ostream);
-
-  // Niri needs the request on a single line.
-  Json::StreamWriterBuilder builder;
-  builder["indentation"] = "";
-  std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-  std::ostringstream oss;
-  writer->write(request, &oss);
-  oss << '\n';
-
-  if (!ostream->put_string(oss.str()) || !ostream->flush())
-    throw std::runtime_error("error writing to niri socket");
+  // Plain blocking I/O: the request is tiny and the reply is a single line.
+  for (size_t written = 0; written < line.size();) {
+    const auto res = write(socketfd, line.data() + written, line.size() - written);
+    if (res < 0 && errno == EINTR) continue;
+    if (res <= 0) {
+      close(socketfd);
+      throw std::runtime_error("error writing to niri socket");
+    }
+    written += res;
+  }
 
-  std::string line;
-  if (!istream->read_line(line)) throw std::runtime_error("error reading from niri socket");
+  std::string reply;
+  std::array<char, 4096> buffer;
+  while (reply.find('\n') == std::string::npos) {
+    const auto res = read(socketfd, buffer.data(), buffer.size());
+    if (res < 0 && errno == EINTR) continue;
+    if (res <= 0) break;
+    reply.append(buffer.data(), res);
+  }
+  close(socketfd);
+  if (reply.empty()) throw std::runtime_error("error reading from niri socket");
 
-  std::istringstream iss(std::move(line));
+  std::istringstream iss(reply.substr(0, reply.find('\n')));
   Json::Value response;
   iss >> response;
   return response;
 }
 
+void IPC::sendAsync(Json::Value request, std::function<void(const Json::Value &)> onReply) {
+  std::lock_guard lock(requestMutex_);
+  requests_.emplace_back(std::move(request), std::move(onReply));
+  if (!requestThreadStarted_) {
+    requestThreadStarted_ = true;
+    requestThread_ = [this] { processRequests(); };
+  }
+  requestThread_.wake_up();
+}
+
+void IPC::processRequests() {
+  std::deque<std::pair<Json::Value, std::function<void(const Json::Value &)>>> requests;
+  {
+    std::lock_guard lock(requestMutex_);
+    requests.swap(requests_);
+  }
+  if (requests.empty()) {
+    requestThread_.sleep();
+    return;
+  }
+
+  for (const auto &[request, onReply] : requests) {
+    try {
+      const auto reply = send(request);
+      if (reply.isMember("Err")) {
+        spdlog::warn("Niri IPC: request failed: {}", reply["Err"].asString());
+      }
+      if (onReply) onReply(reply);
+    } catch (const std::exception &e) {
+      spdlog::error("Niri IPC: request failed: {}", e.what());
+    }
+  }
+}
+
 }  // namespace waybar::modules::niri
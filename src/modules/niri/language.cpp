@@ -28,13 +28,13 @@ Language::~Language() {
 }
 
 void Language::updateFromIPC() {
+  const auto state = gIPC->state();
   std::lock_guard<std::mutex> lock(mutex_);
-  auto ipcLock = gIPC->lockData();
 
   layouts_.clear();
-  for (const auto &fullName : gIPC->keyboardLayoutNames()) layouts_.push_back(getLayout(fullName));
+  for (const auto &fullName : state->keyboardLayoutNames()) layouts_.push_back(getLayout(fullName));
 
-  current_idx_ = gIPC->keyboardLayoutCurrent();
+  current_idx_ = state->keyboardLayoutCurrent();
 }
 
 /**
@@ -91,9 +91,9 @@ void Language::onEvent(const Json::Value &ev) {
   if (ev["KeyboardLayoutsChanged"]) {
     updateFromIPC();
   } else if (ev["KeyboardLayoutSwitched"]) {
+    const auto state = gIPC->state();
     std::lock_guard<std::mutex> lock(mutex_);
-    auto ipcLock = gIPC->lockData();
-    current_idx_ = gIPC->keyboardLayoutCurrent();
+    current_idx_ = state->keyboardLayoutCurrent();
   }
 
   dp.emit();
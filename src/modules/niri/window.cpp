@@ -10,7 +10,9 @@
 namespace waybar::modules::niri {
 
 Window::Window(const std::string &id, const Bar &bar, const Json::Value &config)
-    : AAppIconLabel(config, "window", id, "{title}", 0, true), bar_(bar) {
+    : AAppIconLabel(config, "window", id, "{title}", 0, true),
+      bar_(bar),
+      rewrite_(config["rewrite"]) {
   if (!gIPC) gIPC = std::make_unique<IPC>();
 
   gIPC->registerForIPC("WindowsChanged", this);
@@ -26,54 +28,35 @@ Window::~Window() { gIPC->unregisterForIPC(this); }
 void Window::onEvent(const Json::Value &ev) { dp.emit(); }
 
 void Window::doUpdate() {
-  auto ipcLock = gIPC->lockData();
+  const auto state = gIPC->state();
+  // Nothing changed since the last update
+  if (state->generation() == generation_) return;
+  generation_ = state->generation();
 
-  const auto &windows = gIPC->windows();
-  const auto &workspaces = gIPC->workspaces();
+  const auto *ws = config_["separate-outputs"].asBool() ? state->activeWorkspace(bar_.output->name)
+                                                        : state->focusedWorkspace();
 
-  const auto separateOutputs = config_["separate-outputs"].asBool();
-  const auto ws_it = std::find_if(workspaces.cbegin(), workspaces.cend(), [&](const auto &ws) {
-    if (separateOutputs) {
-      return ws["is_active"].asBool() && ws["output"].asString() == bar_.output->name;
-    }
-
-    return ws["is_focused"].asBool();
-  });
-
-  std::vector<Json::Value>::const_iterator it;
-  if (ws_it == workspaces.cend() || (*ws_it)["active_window_id"].isNull()) {
-    it = windows.cend();
-  } else {
-    const auto id = (*ws_it)["active_window_id"].asUInt64();
-    it = std::find_if(windows.cbegin(), windows.cend(),
-                      [id](const auto &win) { return win["id"].asUInt64() == id; });
-  }
-
-  setClass("empty", ws_it == workspaces.cend() || (*ws_it)["active_window_id"].isNull());
+  const WindowState *window = nullptr;
+  if (ws != nullptr && ws->activeWindowId) window = state->window(*ws->activeWindowId);
 
-  if (it != windows.cend()) {
-    const auto &window = *it;
+  setClass("empty", ws == nullptr || !ws->activeWindowId);
 
-    const auto title = window["title"].asString();
-    const auto appId = window["app_id"].asString();
+  if (window != nullptr) {
+    const auto &title = window->title;
+    const auto &appId = window->appId;
     const auto sanitizedTitle = waybar::util::sanitize_string(title);
     const auto sanitizedAppId = waybar::util::sanitize_string(appId);
 
     label_.show();
-    label_.set_markup(waybar::util::rewriteString(
-        fmt::format(fmt::runtime(format_), fmt::arg("title", sanitizedTitle),
-                    fmt::arg("app_id", sanitizedAppId)),
-        config_["rewrite"]));
+    label_.set_markup(rewrite_.apply(fmt::format(fmt::runtime(format_),
+                                                 fmt::arg("title", sanitizedTitle),
+                                                 fmt::arg("app_id", sanitizedAppId))));
 
     updateAppIconName(appId, "");
 
     if (tooltipEnabled()) label_.set_tooltip_text(title);
 
-    const auto id = window["id"].asUInt64();
-    const auto workspaceId = window["workspace_id"].asUInt64();
-    const auto isSolo = std::none_of(windows.cbegin(), windows.cend(), [&](const auto &win) {
-      return win["id"].asUInt64() != id && win["workspace_id"].asUInt64() == workspaceId;
-    });
+    const auto isSolo = window->workspaceId && state->windowCount(*window->workspaceId) == 1;
     setClass("solo", isSolo);
     if (!appId.empty()) setClass(appId, isSolo);
 
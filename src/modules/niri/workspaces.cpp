@@ -28,23 +28,48 @@ Workspaces::~Workspaces() { gIPC->unregisterForIPC(this); }
 
 void Workspaces::onEvent(const Json::Value &ev) { dp.emit(); }
 
+void Workspaces::onStateChanged(const StateChanges &changes) {
+  std::lock_guard lock(changesMutex_);
+  pendingChanges_.merge(changes);
+}
+
+bool Workspaces::isShown(const WorkspaceState &ws) const {
+  return config_["all-outputs"].asBool() || (ws.output && *ws.output == bar_.output->name);
+}
+
 void Workspaces::doUpdate() {
-  auto ipcLock = gIPC->lockData();
+  // Take the changes before the snapshot: changes are delivered after their state is published,
+  // so the snapshot is at least as new as every change taken here.
+  StateChanges changes;
+  {
+    std::lock_guard lock(changesMutex_);
+    std::swap(changes, pendingChanges_);
+  }
+  if (changes.empty()) return;
+
+  const auto state = gIPC->state();
+
+  // Activation and active window changes only touch a few workspaces, update their buttons only.
+  if (!changes.allWorkspaces) {
+    for (const auto id : changes.workspaces) {
+      const auto *ws = state->workspace(id);
+      auto bit = buttons_.find(id);
+      if (ws != nullptr && bit != buttons_.end()) updateButton(bit->second, *ws);
+    }
+    return;
+  }
 
   const auto alloutputs = config_["all-outputs"].asBool();
-  std::vector<Json::Value> my_workspaces;
-  const auto &workspaces = gIPC->workspaces();
-  std::copy_if(workspaces.cbegin(), workspaces.cend(), std::back_inserter(my_workspaces),
-               [&](const auto &ws) {
-                 if (alloutputs) return true;
-                 return ws["output"].asString() == bar_.output->name;
-               });
+  std::vector<const WorkspaceState *> my_workspaces;
+  for (const auto id : state->workspaceOrder()) {
+    const auto *ws = state->workspace(id);
+    if (isShown(*ws)) my_workspaces.push_back(ws);
+  }
 
   // Remove buttons for removed workspaces.
   for (auto it = buttons_.begin(); it != buttons_.end();) {
-    auto ws = std::find_if(my_workspaces.begin(), my_workspaces.end(),
-                           [it](const auto &ws) { return ws["id"].asUInt64() == it->first; });
-    if (ws == my_workspaces.end()) {
+    const auto *ws = state->workspace(it->first);
+    if (ws == nullptr || !isShown(*ws)) {
       it = buttons_.erase(it);
     } else {
       ++it;
@@ -52,76 +77,76 @@ void Workspaces::doUpdate() {
   }
 
   // Add buttons for new workspaces, update existing ones.
-  for (const auto &ws : my_workspaces) {
-    auto bit = buttons_.find(ws["id"].asUInt64());
-    auto &button = bit == buttons_.end() ? addButton(ws) : bit->second;
-    auto style_context = button.get_style_context();
+  for (const auto *ws : my_workspaces) {
+    auto bit = buttons_.find(ws->id);
+    auto &button = bit == buttons_.end() ? addButton(*ws) : bit->second;
+    updateButton(button, *ws);
+  }
 
-    if (ws["is_focused"].asBool())
-      style_context->add_class("focused");
-    else
-      style_context->remove_class("focused");
+  // Refresh the button order.
+  for (auto it = my_workspaces.cbegin(); it != my_workspaces.cend(); ++it) {
+    const auto *ws = *it;
 
-    if (ws["is_active"].asBool())
-      style_context->add_class("active");
-    else
-      style_context->remove_class("active");
+    auto pos = ws->idx - 1;
+    if (alloutputs) pos = it - my_workspaces.cbegin();
 
-    if (ws["output"]) {
-      if (ws["output"].asString() == bar_.output->name)
-        style_context->add_class("current_output");
-      else
-        style_context->remove_class("current_output");
-    } else {
-      style_context->remove_class("current_output");
-    }
+    auto &button = buttons_[ws->id];
+    box_.reorder_child(button, pos);
+  }
+}
 
-    if (ws["active_window_id"].isNull())
-      style_context->add_class("empty");
-    else
-      style_context->remove_class("empty");
+void Workspaces::updateButton(Gtk::Button &button, const WorkspaceState &ws) {
+  auto style_context = button.get_style_context();
 
-    std::string name;
-    if (ws["name"]) {
-      name = ws["name"].asString();
-    } else {
-      name = std::to_string(ws["idx"].asUInt());
-    }
-    button.set_name("niri-workspace-" + name);
-
-    if (config_["format"].isString()) {
-      auto format = config_["format"].asString();
-      name = fmt::format(fmt::runtime(format), fmt::arg("icon", getIcon(name, ws)),
-                         fmt::arg("value", name), fmt::arg("name", ws["name"].asString()),
-                         fmt::arg("index", ws["idx"].asUInt()),
-                         fmt::arg("output", ws["output"].asString()));
-    }
-    if (!config_["disable-markup"].asBool()) {
-      static_cast<Gtk::Label *>(button.get_children()[0])->set_markup(name);
-    } else {
-      button.set_label(name);
-    }
+  if (ws.isFocused)
+    style_context->add_class("focused");
+  else
+    style_context->remove_class("focused");
 
-    if (config_["current-only"].asBool()) {
-      const auto *property = alloutputs ? "is_focused" : "is_active";
-      if (ws[property].asBool())
-        button.show();
-      else
-        button.hide();
-    } else {
-      button.show();
-    }
-  }
+  if (ws.isActive)
+    style_context->add_class("active");
+  else
+    style_context->remove_class("active");
 
-  // Refresh the button order.
-  for (auto it = my_workspaces.cbegin(); it != my_workspaces.cend(); ++it) {
-    const auto &ws = *it;
+  if (ws.output && *ws.output == bar_.output->name)
+    style_context->add_class("current_output");
+  else
+    style_context->remove_class("current_output");
 
-    auto pos = ws["idx"].asUInt() - 1;
-    if (alloutputs) pos = it - my_workspaces.cbegin();
+  if (!ws.activeWindowId)
+    style_context->add_class("empty");
+  else
+    style_context->remove_class("empty");
 
-    auto &button = buttons_[ws["id"].asUInt64()];
-    box_.reorder_child(button, pos);
+  std::string name;
+  if (ws.name) {
+    name = *ws.name;
+  } else {
+    name = std::to_string(ws.idx);
+  }
+  button.set_name("niri-workspace-" + name);
+
+  if (config_["format"].isString()) {
+    auto format = config_["format"].asString();
+    name = fmt::format(fmt::runtime(format), fmt::arg("icon", getIcon(name, ws)),
+                       fmt::arg("value", name), fmt::arg("name", ws.name.value_or("")),
+                       fmt::arg("index", ws.idx),
+                       fmt::arg("output", ws.output ? *ws.output : std::string()));
+  }
+  if (!config_["disable-markup"].asBool()) {
+    static_cast<Gtk::Label *>(button.get_children()[0])->set_markup(name);
+  } else {
+    button.set_label(name);
+  }
+
+  if (config_["current-only"].asBool()) {
+    const auto shown = config_["all-outputs"].asBool() ? ws.isFocused : ws.isActive;
+    if (shown)
+      button.show();
+    else
+      button.hide();
+  } else {
+    button.show();
   }
 }
 
@@ -130,52 +155,48 @@ void Workspaces::update() {
   AModule::update();
 }
 
-Gtk::Button &Workspaces::addButton(const Json::Value &ws) {
+Gtk::Button &Workspaces::addButton(const WorkspaceState &ws) {
   std::string name;
-  if (ws["name"]) {
-    name = ws["name"].asString();
+  if (ws.name) {
+    name = *ws.name;
   } else {
-    name = std::to_string(ws["idx"].asUInt());
+    name = std::to_string(ws.idx);
   }
 
-  auto pair = buttons_.emplace(ws["id"].asUInt64(), name);
+  auto pair = buttons_.emplace(ws.id, name);
   auto &&button = pair.first->second;
   box_.pack_start(button, false, false, 0);
   button.set_relief(Gtk::RELIEF_NONE);
   if (!config_["disable-click"].asBool()) {
-    const auto id = ws["id"].asUInt64();
+    const auto id = ws.id;
     button.signal_pressed().connect([=] {
-      try {
-        // {"Action":{"FocusWorkspace":{"reference":{"Id":1}}}}
-        Json::Value request(Json::objectValue);
-        auto &action = (request["Action"] = Json::Value(Json::objectValue));
-        auto &focusWorkspace = (action["FocusWorkspace"] = Json::Value(Json::objectValue));
-        auto &reference = (focusWorkspace["reference"] = Json::Value(Json::objectValue));
-        reference["Id"] = id;
-
-        IPC::send(request);
-      } catch (const std::exception &e) {
-        spdlog::error("Error switching workspace: {}", e.what());
-      }
+      // {"Action":{"FocusWorkspace":{"reference":{"Id":1}}}}
+      Json::Value request(Json::objectValue);
+      auto &action = (request["Action"] = Json::Value(Json::objectValue));
+      auto &focusWorkspace = (action["FocusWorkspace"] = Json::Value(Json::objectValue));
+      auto &reference = (focusWorkspace["reference"] = Json::Value(Json::objectValue));
+      reference["Id"] = id;
+
+      gIPC->sendAsync(std::move(request));
     });
   }
   return button;
 }
 
-std::string Workspaces::getIcon(const std::string &value, const Json::Value &ws) {
+std::string Workspaces::getIcon(const std::string &value, const WorkspaceState &ws) {
   const auto &icons = config_["format-icons"];
   if (!icons) return value;
 
-  if (ws["is_focused"].asBool() && icons["focused"]) return icons["focused"].asString();
+  if (ws.isFocused && icons["focused"]) return icons["focused"].asString();
 
-  if (ws["is_active"].asBool() && icons["active"]) return icons["active"].asString();
+  if (ws.isActive && icons["active"]) return icons["active"].asString();
 
-  if (ws["name"]) {
-    const auto &name = ws["name"].asString();
+  if (ws.name) {
+    const auto &name = *ws.name;
     if (icons[name]) return icons[name].asString();
   }
 
-  const auto idx = ws["idx"].asString();
+  const auto idx = std::to_string(ws.idx);
   if (icons[idx]) return icons[idx].asString();
 
   if (icons["default"]) return icons["default"].asString();
@@ -5,17 +5,22 @@
 #include <glibmm/variant.h>
 #include <spdlog/spdlog.h>
 
+#include "util/dbus.hpp"
+
 namespace waybar::modules {
 
 PowerProfilesDaemon::PowerProfilesDaemon(const std::string& id, const Json::Value& config)
-    : ALabel(config, "power-profiles-daemon", id, "{icon}", 0, false, true), connected_(false) {
+    : ALabel(config, "power-profiles-daemon", id, "{icon}", 0, false, true),
+      connected_(false),
+      cancellable_(Gio::Cancellable::create()) {
   if (config_["tooltip-format"].isString()) {
     tooltipFormat_ = config_["tooltip-format"].asString();
   } else {
     tooltipFormat_ = "Power profile: {profile}\nDriver: {driver}";
   }
   // Fasten your seatbelt, we're up for quite a ride. The rest of the
-  // init is performed asynchronously. There's 2 callbacks involved.
+  // init is performed asynchronously. There's 2 callbacks involved,
+  // both dropped if the module is destroyed before they run.
   // Here's the overall idea:
   // 1. Async connect to the system bus.
   // 2. In the system bus connect callback, try to call
@@ -40,48 +45,38 @@ PowerProfilesDaemon::PowerProfilesDaemon(const std::string& id, const Json::Valu
   //
   // Revisit this in 2026, systems should be updated by then.
 
-  Gio::DBus::Proxy::create_for_bus(Gio::DBus::BusType::BUS_TYPE_SYSTEM, "net.hadess.PowerProfiles",
-                                   "/net/hadess/PowerProfiles", "net.hadess.PowerProfiles",
-                                   sigc::mem_fun(*this, &PowerProfilesDaemon::busConnectedCb));
+  util::dbus::createProxy(Gio::DBus::BusType::BUS_TYPE_SYSTEM, "net.hadess.PowerProfiles",
+                          "/net/hadess/PowerProfiles", "net.hadess.PowerProfiles", cancellable_,
+                          sigc::mem_fun(*this, &PowerProfilesDaemon::busConnectedCb));
   // Schedule update to set the initial visibility
   dp.emit();
 }
 
-void PowerProfilesDaemon::busConnectedCb(Glib::RefPtr<Gio::AsyncResult>& r) {
-  try {
-    powerProfilesProxy_ = Gio::DBus::Proxy::create_for_bus_finish(r);
-    using GetAllProfilesVar = Glib::Variant<std::tuple<Glib::ustring>>;
-    auto callArgs = GetAllProfilesVar::create(std::make_tuple("net.hadess.PowerProfiles"));
-    powerProfilesProxy_->call("org.freedesktop.DBus.Properties.GetAll",
-                              sigc::mem_fun(*this, &PowerProfilesDaemon::getAllPropsCb), callArgs);
-    // Connect active profile callback
-  } catch (const std::exception& e) {
-    spdlog::error("Failed to create the power profiles daemon DBus proxy: {}", e.what());
-  } catch (const Glib::Error& e) {
-    spdlog::error("Failed to create the power profiles daemon DBus proxy: {}",
-                  std::string(e.what()));
-  }
+PowerProfilesDaemon::~PowerProfilesDaemon() {
+  cancellable_->cancel();
+  propertiesChanged_.disconnect();
+}
+
+void PowerProfilesDaemon::busConnectedCb(const Glib::RefPtr<Gio::DBus::Proxy>& proxy) {
+  powerProfilesProxy_ = proxy;
+  using GetAllProfilesVar = Glib::Variant<std::tuple<Glib::ustring>>;
+  auto callArgs = GetAllProfilesVar::create(std::make_tuple("net.hadess.PowerProfiles"));
+  util::dbus::call(powerProfilesProxy_, "org.freedesktop.DBus.Properties.GetAll", callArgs,
+                   cancellable_, sigc::mem_fun(*this, &PowerProfilesDaemon::getAllPropsCb));
 }
 
 // Callback for the GetAll call.
 //
 // We're abusing this call to make sure power-profiles-daemon is
 // available on the host. We're not really using
-void PowerProfilesDaemon::getAllPropsCb(Glib::RefPtr<Gio::AsyncResult>& r) {
-  try {
-    auto _ = powerProfilesProxy_->call_finish(r);
-    // Power-profiles-daemon responded something, we can assume it's
-    // available, we can safely attach the activeProfile monitoring
-    // now.
-    connected_ = true;
-    powerProfilesProxy_->signal_properties_changed().connect(
-        sigc::mem_fun(*this, &PowerProfilesDaemon::profileChangedCb));
-    populateInitState();
-  } catch (const std::exception& err) {
-    spdlog::error("Failed to query power-profiles-daemon via dbus: {}", err.what());
-  } catch (const Glib::Error& err) {
-    spdlog::error("Failed to query power-profiles-daemon via dbus: {}", std::string(err.what()));
-  }
+void PowerProfilesDaemon::getAllPropsCb(const Glib::VariantContainerBase& /*reply*/) {
+  // Power-profiles-daemon responded something, we can assume it's
+  // available, we can safely attach the activeProfile monitoring
+  // now.
+  connected_ = true;
+  propertiesChanged_ = powerProfilesProxy_->signal_properties_changed().connect(
+      sigc::mem_fun(*this, &PowerProfilesDaemon::profileChangedCb));
+  populateInitState();
 }
 
 void PowerProfilesDaemon::populateInitState() {
@@ -193,21 +188,10 @@ bool PowerProfilesDaemon::handleToggle(GdkEventButton* const& e) {
     VarStr activeProfileVariant = VarStr::create(activeProfile_->name);
     auto callArgs = SetPowerProfileVar::create(
         std::make_tuple("net.hadess.PowerProfiles", "ActiveProfile", activeProfileVariant));
-    powerProfilesProxy_->call("org.freedesktop.DBus.Properties.Set",
-                              sigc::mem_fun(*this, &PowerProfilesDaemon::setPropCb), callArgs);
+    util::dbus::call(powerProfilesProxy_, "org.freedesktop.DBus.Properties.Set", callArgs,
+                     cancellable_, [this](const Glib::VariantContainerBase&) { dp.emit(); });
   }
   return true;
 }
 
-void PowerProfilesDaemon::setPropCb(Glib::RefPtr<Gio::AsyncResult>& r) {
-  try {
-    auto _ = powerProfilesProxy_->call_finish(r);
-    dp.emit();
-  } catch (const std::exception& e) {
-    spdlog::error("Failed to set the active power profile: {}", e.what());
-  } catch (const Glib::Error& e) {
-    spdlog::error("Failed to set the active power profile: {}", std::string(e.what()));
-  }
-}
-
 }  // namespace waybar::modules
@@ -7,7 +7,9 @@
 
 namespace waybar::modules::sway {
 
-Ipc::Ipc() {
+Ipc::Ipc()
+    : ipc_bytes_(util::metrics::histogram("sway", "ipc_bytes")),
+      ipc_dispatch_(util::metrics::histogram("sway", "ipc_dispatch_us")) {
   const std::string& socketPath = getSocketPath();
   fd_ = open(socketPath);
   fd_event_ = open(socketPath);
@@ -151,6 +153,10 @@ void Ipc::subscribe(const std::string& payload) {
 
 void Ipc::handleEvent() {
   const auto res = Ipc::recv(fd_event_);
+  if (ipc_bytes_ != nullptr) {
+    ipc_bytes_->record(res.payload.size());
+  }
+  util::metrics::ScopedTimer timer(ipc_dispatch_);
   signal_event.emit(res);
 }
 
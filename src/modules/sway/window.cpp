@@ -17,7 +17,10 @@
 namespace waybar::modules::sway {
 
 Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
-    : AAppIconLabel(config, "window", id, "{}", 0, true), bar_(bar), windowId_(-1) {
+    : AAppIconLabel(config, "window", id, "{}", 0, true),
+      bar_(bar),
+      windowId_(-1),
+      rewrite_(config["rewrite"]) {
   ipc_.subscribe(R"(["window","workspace"])");
   ipc_.signal_event.connect(sigc::mem_fun(*this, &Window::onEvent));
   ipc_.signal_cmd.connect(sigc::mem_fun(*this, &Window::onCmd));
@@ -94,10 +97,9 @@ auto Window::update() -> void {
     old_app_id_ = app_id_;
   }
 
-  label_.set_markup(waybar::util::rewriteString(
-      fmt::format(fmt::runtime(format_), fmt::arg("title", window_), fmt::arg("app_id", app_id_),
-                  fmt::arg("shell", shell_)),
-      config_["rewrite"]));
+  label_.set_markup(
+      rewrite_.apply(fmt::format(fmt::runtime(format_), fmt::arg("title", window_),
+                                 fmt::arg("app_id", app_id_), fmt::arg("shell", shell_))));
   if (tooltipEnabled()) {
     label_.set_tooltip_text(window_);
   }
@@ -6,6 +6,8 @@
 
 #include <cstdint>
 
+#include "util/dbus.hpp"
+
 static const unsigned UPDATE_DEBOUNCE_TIME_MS = 1000;
 
 namespace waybar::modules {
@@ -14,9 +16,11 @@ SystemdFailedUnits::SystemdFailedUnits(const std::string& id, const Json::Value&
     : ALabel(config, "systemd-failed-units", id, "{nr_failed} failed", 1),
       hide_on_ok(true),
       update_pending(false),
+      reload_pending(false),
       nr_failed_system(0),
       nr_failed_user(0),
-      last_status() {
+      last_status(),
+      cancellable(Gio::Cancellable::create()) {
   if (config["hide-on-ok"].isBool()) {
     hide_on_ok = config["hide-on-ok"].asBool();
   }
@@ -28,73 +32,95 @@ SystemdFailedUnits::SystemdFailedUnits(const std::string& id, const Json::Value&
 
   /* Default to enable both "system" and "user". */
   if (!config["system"].isBool() || config["system"].asBool()) {
-    system_proxy = Gio::DBus::Proxy::create_for_bus_sync(
-        Gio::DBus::BusType::BUS_TYPE_SYSTEM, "org.freedesktop.systemd1",
-        "/org/freedesktop/systemd1", "org.freedesktop.DBus.Properties");
-    if (!system_proxy) {
-      throw std::runtime_error("Unable to connect to systemwide systemd DBus!");
-    }
-    system_proxy->signal_signal().connect(sigc::mem_fun(*this, &SystemdFailedUnits::notify_cb));
+    connectBus(Gio::DBus::BusType::BUS_TYPE_SYSTEM, system_proxy, system_signal, nr_failed_system);
   }
   if (!config["user"].isBool() || config["user"].asBool()) {
-    user_proxy = Gio::DBus::Proxy::create_for_bus_sync(
-        Gio::DBus::BusType::BUS_TYPE_SESSION, "org.freedesktop.systemd1",
-        "/org/freedesktop/systemd1", "org.freedesktop.DBus.Properties");
-    if (!user_proxy) {
-      throw std::runtime_error("Unable to connect to user systemd DBus!");
-    }
-    user_proxy->signal_signal().connect(sigc::mem_fun(*this, &SystemdFailedUnits::notify_cb));
+    connectBus(Gio::DBus::BusType::BUS_TYPE_SESSION, user_proxy, user_signal, nr_failed_user);
   }
 
-  updateData();
   /* Always update for the first time. */
   dp.emit();
 }
 
 SystemdFailedUnits::~SystemdFailedUnits() {
+  cancellable->cancel();
+  update_timeout.disconnect();
+  system_signal.disconnect();
+  user_signal.disconnect();
   if (system_proxy) system_proxy.reset();
   if (user_proxy) user_proxy.reset();
 }
 
+void SystemdFailedUnits::connectBus(Gio::DBus::BusType bus_type,
+                                    Glib::RefPtr<Gio::DBus::Proxy>& proxy,
+                                    sigc::connection& signal, uint32_t& nr_failed) {
+  util::dbus::createProxy(
+      bus_type, "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
+      "org.freedesktop.DBus.Properties", cancellable,
+      [this, &proxy, &signal, &nr_failed](const Glib::RefPtr<Gio::DBus::Proxy>& created) {
+        proxy = created;
+        signal = proxy->signal_signal().connect(
+            sigc::bind(sigc::mem_fun(*this, &SystemdFailedUnits::notify_cb), &nr_failed));
+        load(proxy, nr_failed);
+      });
+}
+
 auto SystemdFailedUnits::notify_cb(const Glib::ustring& sender_name,
                                    const Glib::ustring& signal_name,
-                                   const Glib::VariantContainerBase& arguments) -> void {
-  if (signal_name == "PropertiesChanged" && !update_pending) {
-    update_pending = true;
-    /* The fail count may fluctuate due to restarting. */
-    Glib::signal_timeout().connect_once(sigc::mem_fun(*this, &SystemdFailedUnits::updateData),
-                                        UPDATE_DEBOUNCE_TIME_MS);
+                                   const Glib::VariantContainerBase& arguments,
+                                   uint32_t* nr_failed) -> void {
+  if (signal_name != "PropertiesChanged") {
+    return;
+  }
+
+  /* systemd usually sends the new count along, only ask for it when it doesn't. */
+  auto value = util::dbus::changedProperty(arguments, "NFailedUnits");
+  if (value && value->is_of_type(Glib::VARIANT_TYPE_UINT32)) {
+    *nr_failed = Glib::VariantBase::cast_dynamic<Glib::Variant<uint32_t>>(*value).get();
+    scheduleUpdate(false);
+  } else {
+    scheduleUpdate(true);
   }
 }
 
+void SystemdFailedUnits::scheduleUpdate(bool reload) {
+  reload_pending = reload_pending || reload;
+  if (update_pending) {
+    return;
+  }
+  update_pending = true;
+  /* The fail count may fluctuate due to restarting. */
+  update_timeout = Glib::signal_timeout().connect(
+      [this] {
+        updateData();
+        return false;
+      },
+      UPDATE_DEBOUNCE_TIME_MS);
+}
+
+void SystemdFailedUnits::load(const Glib::RefPtr<Gio::DBus::Proxy>& proxy, uint32_t& nr_failed) {
+  util::dbus::getProperty(proxy, "org.freedesktop.systemd1.Manager", "NFailedUnits", cancellable,
+                          [this, &nr_failed](const Glib::VariantBase& value) {
+                            if (value.is_of_type(Glib::VARIANT_TYPE_UINT32)) {
+                              nr_failed =
+                                  Glib::VariantBase::cast_dynamic<Glib::Variant<uint32_t>>(value)
+                                      .get();
+                              dp.emit();
+                            }
+                          });
+}
+
 void SystemdFailedUnits::updateData() {
   update_pending = false;
 
-  auto load = [](const char* kind, Glib::RefPtr<Gio::DBus::Proxy>& proxy) -> uint32_t {
-    try {
-      auto parameters = Glib::VariantContainerBase(
-          g_variant_new("(ss)", "org.freedesktop.systemd1.Manager", "NFailedUnits"));
-      Glib::VariantContainerBase data = proxy->call_sync("Get", parameters);
-      if (data && data.is_of_type(Glib::VariantType("(v)"))) {
-        Glib::VariantBase variant;
-        g_variant_get(data.gobj_copy(), "(v)", &variant);
-        if (variant && variant.is_of_type(Glib::VARIANT_TYPE_UINT32)) {
-          uint32_t value = 0;
-          g_variant_get(variant.gobj_copy(), "u", &value);
-          return value;
-        }
-      }
-    } catch (Glib::Error& e) {
-      spdlog::error("Failed to get {} failed units: {}", kind, e.what().c_str());
+  if (reload_pending) {
+    reload_pending = false;
+    if (system_proxy) {
+      load(system_proxy, nr_failed_system);
+    }
+    if (user_proxy) {
+      load(user_proxy, nr_failed_user);
     }
-    return 0;
-  };
-
-  if (system_proxy) {
-    nr_failed_system = load("systemwide", system_proxy);
-  }
-  if (user_proxy) {
-    nr_failed_user = load("user", user_proxy);
   }
   dp.emit();
 }
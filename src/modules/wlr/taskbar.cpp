@@ -383,7 +383,9 @@ std::string Task::state_string(bool shortened) const {
 }
 
 void Task::handle_title(const char *title) {
+  if (title_ == title) return;
   title_ = title;
+  dirty_ = true;
   hide_if_ignored();
 }
 
@@ -416,6 +418,7 @@ void Task::handle_app_id(const char *app_id) {
     spdlog::debug(fmt::format("Task ({}) overwriting app_id '{}' with '{}'", id_, app_id_, app_id));
   }
   app_id_ = app_id;
+  dirty_ = true;
   hide_if_ignored();
 
   auto ids_replace_map = tbar_->app_ids_replace_map();
@@ -474,6 +477,8 @@ void Task::handle_output_enter(struct wl_output *output) {
     tbar_->add_button(button);
     button.show();
     button_visible_ = true;
+    /* Make sure the next done event places and labels the new button */
+    dirty_ = true;
     spdlog::debug("{} now visible on {}", repr(), bar_.output->name);
   }
 }
@@ -491,20 +496,24 @@ void Task::handle_output_leave(struct wl_output *output) {
 }
 
 void Task::handle_state(struct wl_array *state) {
-  state_ = 0;
+  uint32_t new_state = 0;
   size_t size = state->size / sizeof(uint32_t);
   for (size_t i = 0; i < size; ++i) {
     auto entry = static_cast<uint32_t *>(state->data)[i];
-    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MAXIMIZED) state_ |= MAXIMIZED;
-    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MINIMIZED) state_ |= MINIMIZED;
-    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED) state_ |= ACTIVE;
-    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_FULLSCREEN) state_ |= FULLSCREEN;
+    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MAXIMIZED) new_state |= MAXIMIZED;
+    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MINIMIZED) new_state |= MINIMIZED;
+    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED) new_state |= ACTIVE;
+    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_FULLSCREEN) new_state |= FULLSCREEN;
+  }
+  if (new_state != state_) {
+    state_ = new_state;
+    dirty_ = true;
   }
 }
 
 void Task::handle_done() {
-  spdlog::debug("{} changed", repr());
-
+  /* The state classes are cheap to apply and don't depend on dirty_, which the bar update may
+   * have cleared between a state event and its done */
   if (state_ & MAXIMIZED) {
     button.get_style_context()->add_class("maximized");
   } else if (!(state_ & MAXIMIZED)) {
@@ -532,6 +541,10 @@ void Task::handle_done() {
   if (config_["active-first"].isBool() && config_["active-first"].asBool() && active())
     tbar_->move_button(button, 0);
 
+  /* Nothing the labels display has changed since the last update */
+  if (!dirty_) return;
+
+  spdlog::debug("{} changed", repr());
   tbar_->dp.emit();
 }
 
@@ -639,6 +652,7 @@ bool Task::operator==(const Task &o) const { return o.id_ == id_; }
 bool Task::operator!=(const Task &o) const { return o.id_ != id_; }
 
 void Task::update() {
+  dirty_ = false;
   bool markup = config_["markup"].isBool() ? config_["markup"].asBool() : false;
   std::string title = title_;
   std::string name = name_;
@@ -654,7 +668,7 @@ void Task::update() {
                     fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
                     fmt::arg("short_state", state_string(true)));
 
-    txt = waybar::util::rewriteString(txt, config_["rewrite"]);
+    txt = tbar_->rewrite_rules().apply(txt);
 
     if (markup)
       text_before_.set_markup(txt);
@@ -668,7 +682,7 @@ void Task::update() {
                     fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
                     fmt::arg("short_state", state_string(true)));
 
-    txt = waybar::util::rewriteString(txt, config_["rewrite"]);
+    txt = tbar_->rewrite_rules().apply(txt);
 
     if (markup)
       text_after_.set_markup(txt);
@@ -721,26 +735,11 @@ void Task::fullscreen(bool set) {
 void Task::close() { zwlr_foreign_toplevel_handle_v1_close(handle_); }
 
 /* Taskbar class implementation */
-static void handle_global(void *data, struct wl_registry *registry, uint32_t name,
-                          const char *interface, uint32_t version) {
-  if (std::strcmp(interface, zwlr_foreign_toplevel_manager_v1_interface.name) == 0) {
-    static_cast<Taskbar *>(data)->register_manager(registry, name, version);
-  } else if (std::strcmp(interface, wl_seat_interface.name) == 0) {
-    static_cast<Taskbar *>(data)->register_seat(registry, name, version);
-  }
-}
-
-static void handle_global_remove(void *data, struct wl_registry *registry, uint32_t name) {
-  /* Nothing to do here */
-}
-
-static const wl_registry_listener registry_listener_impl = {.global = handle_global,
-                                                            .global_remove = handle_global_remove};
-
 Taskbar::Taskbar(const std::string &id, const waybar::Bar &bar, const Json::Value &config)
     : waybar::AModule(config, "taskbar", id, false, false),
       bar_(bar),
       box_{bar.orientation, 0},
+      rewrite_{config["rewrite"]},
       manager_{nullptr},
       seat_{nullptr} {
   box_.set_name("taskbar");
@@ -751,21 +750,6 @@ Taskbar::Taskbar(const std::string &id, const waybar::Bar &bar, const Json::Valu
   box_.get_style_context()->add_class("empty");
   event_box_.add(box_);
 
-  struct wl_display *display = Client::inst()->wl_display;
-  struct wl_registry *registry = wl_display_get_registry(display);
-
-  wl_registry_add_listener(registry, &registry_listener_impl, this);
-  wl_display_roundtrip(display);
-
-  if (!manager_) {
-    spdlog::error("Failed to register as toplevel manager");
-    return;
-  }
-  if (!seat_) {
-    spdlog::error("Failed to get wayland seat");
-    return;
-  }
-
   /* Get the configured icon theme if specified */
   if (config_["icon-theme"].isArray()) {
     for (auto &c : config_["icon-theme"]) {
@@ -805,12 +789,37 @@ Taskbar::Taskbar(const std::string &id, const waybar::Bar &bar, const Json::Valu
 
   icon_themes_.push_back(Gtk::IconTheme::get_default());
 
-  for (auto &t : tasks_) {
-    t->handle_app_id(t->app_id().c_str());
+  /*
+   * Bind through the registry shared by all modules. The globals were already announced during
+   * startup, so no roundtrip is needed and the toplevels arrive from the main loop after the
+   * configuration above is loaded.
+   */
+  auto *client = Client::inst();
+  global_subscriptions_.push_back(client->subscribeGlobal(
+      wl_seat_interface.name, [this](struct wl_registry *registry, const auto &global) {
+        register_seat(registry, global.name, global.version);
+      }));
+  global_subscriptions_.push_back(client->subscribeGlobal(
+      zwlr_foreign_toplevel_manager_v1_interface.name,
+      [this](struct wl_registry *registry, const auto &global) {
+        register_manager(registry, global.name, global.version);
+      }));
+
+  if (!manager_) {
+    spdlog::error("Failed to register as toplevel manager");
+    return;
+  }
+  if (!seat_) {
+    spdlog::error("Failed to get wayland seat");
+    return;
   }
 }
 
 Taskbar::~Taskbar() {
+  for (auto id : global_subscriptions_) {
+    Client::inst()->unsubscribeGlobal(id);
+  }
+
   if (manager_) {
     struct wl_display *display = Client::inst()->wl_display;
     /*
@@ -831,23 +840,37 @@ Taskbar::~Taskbar() {
 
 void Taskbar::update() {
   for (auto &t : tasks_) {
-    t->update();
+    if (t->dirty()) t->update();
   }
 
   if (config_["sort-by-app-id"].asBool()) {
-    std::stable_sort(tasks_.begin(), tasks_.end(),
-                     [](const std::unique_ptr<Task> &a, const std::unique_ptr<Task> &b) {
-                       return a->app_id() < b->app_id();
-                     });
-
-    for (unsigned long i = 0; i < tasks_.size(); i++) {
-      move_button(tasks_[i]->button, i);
-    }
+    sort_buttons();
   }
 
   AModule::update();
 }
 
+void Taskbar::sort_buttons() {
+  auto by_app_id = [](const TaskPtr &a, const TaskPtr &b) { return a->app_id() < b->app_id(); };
+  if (!std::is_sorted(tasks_.begin(), tasks_.end(), by_app_id)) {
+    std::stable_sort(tasks_.begin(), tasks_.end(), by_app_id);
+  }
+
+  /* Only move the buttons that are not at their sorted position yet */
+  auto children = box_.get_children();
+  size_t pos = 0;
+  for (auto &t : tasks_) {
+    if (t->button.get_parent() != &box_) continue;
+    if (pos >= children.size() || children[pos] != &t->button) {
+      auto it = std::find(children.begin() + pos, children.end(), &t->button);
+      if (it != children.end()) children.erase(it);
+      children.insert(children.begin() + pos, &t->button);
+      move_button(t->button, pos);
+    }
+    ++pos;
+  }
+}
+
 static void tm_handle_toplevel(void *data, struct zwlr_foreign_toplevel_manager_v1 *manager,
                                struct zwlr_foreign_toplevel_handle_v1 *tl_handle) {
   return static_cast<Taskbar *>(data)->handle_toplevel_create(tl_handle);
@@ -949,4 +972,6 @@ const std::map<std::string, std::string> &Taskbar::app_ids_replace_map() const {
   return app_ids_replace_map_;
 }
 
+util::RewriteRuleSet &Taskbar::rewrite_rules() { return rewrite_; }
+
 } /* namespace waybar::modules::wlr */
@@ -55,7 +55,7 @@ WorkspaceManager::WorkspaceManager(const std::string &id, const waybar::Bar &bar
   box_.get_style_context()->add_class(MODULE_CLASS);
   event_box_.add(box_);
 
-  add_registry_listener(this);
+  registry_listener_ = add_registry_listener(this);
   if (!workspace_manager_) {
     return;
   }
@@ -162,6 +162,8 @@ auto WorkspaceManager::update() -> void {
 }
 
 WorkspaceManager::~WorkspaceManager() {
+  remove_registry_listener(registry_listener_);
+
   if (!workspace_manager_) {
     return;
   }
@@ -9,28 +9,15 @@
 
 namespace waybar::modules::wlr {
 
-static void handle_global(void *data, wl_registry *registry, uint32_t name, const char *interface,
-                          uint32_t version) {
-  if (std::strcmp(interface, zext_workspace_manager_v1_interface.name) == 0) {
-    static_cast<WorkspaceManager *>(data)->register_manager(registry, name, version);
-  }
-}
-
-static void handle_global_remove(void *data, wl_registry *registry, uint32_t name) {
-  /* Nothing to do here */
+int add_registry_listener(WorkspaceManager *workspace_manager) {
+  return Client::inst()->subscribeGlobal(
+      zext_workspace_manager_v1_interface.name,
+      [workspace_manager](wl_registry *registry, const Client::WaylandGlobal &global) {
+        workspace_manager->register_manager(registry, global.name, global.version);
+      });
 }
 
-static const wl_registry_listener registry_listener_impl = {.global = handle_global,
-                                                            .global_remove = handle_global_remove};
-
-void add_registry_listener(void *data) {
-  wl_display *display = Client::inst()->wl_display;
-  wl_registry *registry = wl_display_get_registry(display);
-
-  wl_registry_add_listener(registry, &registry_listener_impl, data);
-  wl_display_roundtrip(display);
-  wl_display_roundtrip(display);
-}
+void remove_registry_listener(int id) { Client::inst()->unsubscribeGlobal(id); }
 
 static void workspace_manager_handle_workspace_group(
     void *data, zext_workspace_manager_v1 *_, zext_workspace_group_handle_v1 *workspace_group) {
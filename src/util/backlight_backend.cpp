@@ -8,6 +8,8 @@
 #include <optional>
 #include <utility>
 
+#include "util/dbus.hpp"
+
 namespace {
 class FileDescriptor {
  public:
@@ -142,7 +144,10 @@ void BacklightDevice::set_powered(bool powered) { powered_ = powered; }
 
 BacklightBackend::BacklightBackend(std::chrono::milliseconds interval,
                                    std::function<void()> on_updated_cb)
-    : on_updated_cb_(std::move(on_updated_cb)), polling_interval_(interval), previous_best_({}) {
+    : on_updated_cb_(std::move(on_updated_cb)),
+      polling_interval_(interval),
+      previous_best_({}),
+      login_cancellable_(Gio::Cancellable::create()) {
   std::unique_ptr<udev, UdevDeleter> udev_check{udev_new()};
   check_nn(udev_check.get(), "Udev check new failed");
   enumerate_devices(devices_, udev_check.get());
@@ -151,9 +156,10 @@ BacklightBackend::BacklightBackend(std::chrono::milliseconds interval,
   }
 
   // Connect to the login interface
-  login_proxy_ = Gio::DBus::Proxy::create_for_bus_sync(
-      Gio::DBus::BusType::BUS_TYPE_SYSTEM, "org.freedesktop.login1",
-      "/org/freedesktop/login1/session/self", "org.freedesktop.login1.Session");
+  dbus::createProxy(Gio::DBus::BusType::BUS_TYPE_SYSTEM, "org.freedesktop.login1",
+                    "/org/freedesktop/login1/session/self", "org.freedesktop.login1.Session",
+                    login_cancellable_,
+                    [this](const Glib::RefPtr<Gio::DBus::Proxy> &proxy) { login_proxy_ = proxy; });
 
   udev_thread_ = [this] {
     std::unique_ptr<udev, UdevDeleter> udev{udev_new()};
@@ -210,6 +216,8 @@ BacklightBackend::BacklightBackend(std::chrono::milliseconds interval,
   };
 }
 
+BacklightBackend::~BacklightBackend() { login_cancellable_->cancel(); }
+
 const BacklightDevice *BacklightBackend::best_device(const std::vector<BacklightDevice> &devices,
                                                      std::string_view preferred_device) {
   const auto found = std::find_if(
@@ -270,7 +278,9 @@ void BacklightBackend::set_brightness_internal(const std::string &device_name, i
   auto call_args = Glib::VariantContainerBase(
       g_variant_new("(ssu)", "backlight", device_name.c_str(), brightness));
 
-  login_proxy_->call_sync("SetBrightness", call_args);
+  if (login_proxy_) {
+    dbus::call(login_proxy_, "SetBrightness", call_args, login_cancellable_);
+  }
 }
 
 int BacklightBackend::get_scaled_brightness(const std::string &preferred_device) {
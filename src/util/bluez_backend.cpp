@@ -0,0 +1,306 @@
+#include "util/bluez_backend.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <string_view>
+
+namespace waybar::util {
+
+namespace {
+
+constexpr auto ADAPTER_INTERFACE = "org.bluez.Adapter1";
+constexpr auto DEVICE_INTERFACE = "org.bluez.Device1";
+constexpr auto BATTERY_INTERFACE = "org.bluez.Battery1";
+
+auto getProxy(GDBusObject* object, const char* interface_name) -> GDBusProxy* {
+  return G_DBUS_PROXY(g_dbus_object_get_interface(object, interface_name));
+}
+
+// Accepts both strings and object paths, BlueZ uses the latter for Device1.Adapter
+auto getString(GVariant* value) -> std::string {
+  if (g_variant_is_of_type(value, G_VARIANT_TYPE_STRING) ||
+      g_variant_is_of_type(value, G_VARIANT_TYPE_OBJECT_PATH)) {
+    return g_variant_get_string(value, nullptr);
+  }
+  return {};
+}
+
+auto getBool(GVariant* value) -> bool {
+  return g_variant_is_of_type(value, G_VARIANT_TYPE_BOOLEAN) && g_variant_get_boolean(value);
+}
+
+void applyControllerProperty(BluezBackend::ControllerInfo& info, std::string_view name,
+                             GVariant* value) {
+  if (name == "Address") {
+    info.address = getString(value);
+  } else if (name == "AddressType") {
+    info.address_type = getString(value);
+  } else if (name == "Alias") {
+    info.alias = getString(value);
+  } else if (name == "Powered") {
+    info.powered = getBool(value);
+  } else if (name == "Discoverable") {
+    info.discoverable = getBool(value);
+  } else if (name == "Pairable") {
+    info.pairable = getBool(value);
+  } else if (name == "Discovering") {
+    info.discovering = getBool(value);
+  }
+}
+
+void applyDeviceProperty(BluezBackend::DeviceInfo& info, std::string_view name, GVariant* value) {
+  if (name == "Adapter") {
+    info.paired_controller = getString(value);
+  } else if (name == "Address") {
+    info.address = getString(value);
+  } else if (name == "AddressType") {
+    info.address_type = getString(value);
+  } else if (name == "Alias") {
+    info.alias = getString(value);
+  } else if (name == "Icon") {
+    info.icon = getString(value);
+  } else if (name == "Paired") {
+    info.paired = getBool(value);
+  } else if (name == "Trusted") {
+    info.trusted = getBool(value);
+  } else if (name == "Blocked") {
+    info.blocked = getBool(value);
+  } else if (name == "Connected") {
+    info.connected = getBool(value);
+  } else if (name == "ServicesResolved") {
+    info.services_resolved = getBool(value);
+  }
+}
+
+void applyBatteryProperty(BluezBackend::DeviceInfo& info, std::string_view name,
+                          GVariant* value) {
+  if (name == "Percentage" && g_variant_is_of_type(value, G_VARIANT_TYPE_BYTE)) {
+    info.battery_percentage = g_variant_get_byte(value);
+  }
+}
+
+template <typename Record, typename Apply>
+void loadCachedProperties(GDBusProxy* proxy, Record& record, Apply apply) {
+  gchar** names = g_dbus_proxy_get_cached_property_names(proxy);
+  if (names == nullptr) {
+    return;
+  }
+  for (gchar** name = names; *name != nullptr; ++name) {
+    if (GVariant* value = g_dbus_proxy_get_cached_property(proxy, *name); value != nullptr) {
+      apply(record, *name, value);
+      g_variant_unref(value);
+    }
+  }
+  g_strfreev(names);
+}
+
+template <typename Record, typename Apply>
+void loadChangedProperties(GVariant* changed_properties, Record& record, Apply apply) {
+  GVariantIter iter;
+  const gchar* name;
+  GVariant* value;
+  g_variant_iter_init(&iter, changed_properties);
+  while (g_variant_iter_next(&iter, "{&sv}", &name, &value)) {
+    apply(record, name, value);
+    g_variant_unref(value);
+  }
+}
+
+}  // namespace
+
+std::shared_ptr<BluezBackend> BluezBackend::getInstance() {
+  static std::weak_ptr<BluezBackend> instance;
+
+  auto backend = instance.lock();
+  if (!backend) {
+    private_constructor_tag tag;
+    backend = std::make_shared<BluezBackend>(tag);
+    instance = backend;
+  }
+  return backend;
+}
+
+BluezBackend::BluezBackend(private_constructor_tag tag) : cancellable_(g_cancellable_new()) {
+  g_dbus_object_manager_client_new_for_bus(
+      G_BUS_TYPE_SYSTEM,
+      GDBusObjectManagerClientFlags::G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_DO_NOT_AUTO_START,
+      "org.bluez", "/", NULL, NULL, NULL, cancellable_, onManagerReady, this);
+}
+
+BluezBackend::~BluezBackend() {
+  g_cancellable_cancel(cancellable_);
+  g_object_unref(cancellable_);
+  if (manager_ != nullptr) {
+    g_signal_handlers_disconnect_by_data(manager_, this);
+    g_object_unref(manager_);
+  }
+}
+
+const BluezBackend::ControllerInfo* BluezBackend::controller(const std::string& path) const {
+  auto it = controllers_.find(path);
+  return it != controllers_.end() ? &it->second : nullptr;
+}
+
+const BluezBackend::DeviceInfo* BluezBackend::device(const std::string& path) const {
+  auto it = devices_.find(path);
+  return it != devices_.end() ? &it->second : nullptr;
+}
+
+int BluezBackend::subscribe(Callback cb) {
+  subscribers_.emplace(next_subscriber_id_, std::move(cb));
+  return next_subscriber_id_++;
+}
+
+void BluezBackend::unsubscribe(int id) { subscribers_.erase(id); }
+
+void BluezBackend::notify(Change change, const std::string& path) {
+  for (const auto& [id, cb] : subscribers_) {
+    cb(change, path);
+  }
+}
+
+void BluezBackend::onManagerReady(GObject* /*source*/, GAsyncResult* res, gpointer user_data) {
+  GError* error = nullptr;
+  GDBusObjectManager* manager = g_dbus_object_manager_client_new_for_bus_finish(res, &error);
+  if (error != nullptr) {
+    // On cancellation the backend is already gone, don't touch user_data
+    if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      spdlog::error("g_dbus_object_manager_client_new_for_bus() failed: {}", error->message);
+    }
+    g_error_free(error);
+    return;
+  }
+
+  auto* self = static_cast<BluezBackend*>(user_data);
+
+  // Subscribers only hear about the initial objects through READY
+  GList* objects = g_dbus_object_manager_get_objects(manager);
+  for (GList* l = objects; l != NULL; l = l->next) {
+    self->loadObject(G_DBUS_OBJECT(l->data));
+  }
+  g_list_free_full(objects, g_object_unref);
+  self->manager_ = manager;
+
+  g_signal_connect(manager, "object-added", G_CALLBACK(onObjectAdded), self);
+  g_signal_connect(manager, "object-removed", G_CALLBACK(onObjectRemoved), self);
+  g_signal_connect(manager, "interface-added", G_CALLBACK(onInterfaceAdded), self);
+  g_signal_connect(manager, "interface-removed", G_CALLBACK(onInterfaceRemoved), self);
+  g_signal_connect(manager, "interface-proxy-properties-changed",
+                   G_CALLBACK(onInterfaceProxyPropertiesChanged), self);
+
+  self->notify(Change::READY, {});
+}
+
+void BluezBackend::loadObject(GDBusObject* object) {
+  std::string path = g_dbus_object_get_object_path(object);
+
+  if (GDBusProxy* proxy = getProxy(object, ADAPTER_INTERFACE); proxy != nullptr) {
+    auto [it, added] = controllers_.try_emplace(path);
+    it->second = {.path = path};
+    loadCachedProperties(proxy, it->second, applyControllerProperty);
+    g_object_unref(proxy);
+    if (ready()) {
+      notify(added ? Change::CONTROLLER_ADDED : Change::CONTROLLER_CHANGED, path);
+    }
+  }
+
+  if (GDBusProxy* proxy = getProxy(object, DEVICE_INTERFACE); proxy != nullptr) {
+    auto& device = devices_[path];
+    device = {.path = path};
+    loadCachedProperties(proxy, device, applyDeviceProperty);
+    g_object_unref(proxy);
+
+    if (GDBusProxy* battery = getProxy(object, BATTERY_INTERFACE); battery != nullptr) {
+      loadCachedProperties(battery, device, applyBatteryProperty);
+      g_object_unref(battery);
+    }
+    if (ready()) {
+      notify(Change::DEVICE_CHANGED, path);
+    }
+  }
+}
+
+void BluezBackend::onObjectAdded(GDBusObjectManager* /*manager*/, GDBusObject* object,
+                                 gpointer user_data) {
+  static_cast<BluezBackend*>(user_data)->loadObject(object);
+}
+
+void BluezBackend::onObjectRemoved(GDBusObjectManager* /*manager*/, GDBusObject* object,
+                                   gpointer user_data) {
+  auto* self = static_cast<BluezBackend*>(user_data);
+  std::string path = g_dbus_object_get_object_path(object);
+
+  if (self->controllers_.erase(path) != 0) {
+    self->notify(Change::CONTROLLER_REMOVED, path);
+  }
+  if (self->devices_.erase(path) != 0) {
+    self->notify(Change::DEVICE_REMOVED, path);
+  }
+}
+
+void BluezBackend::onInterfaceAdded(GDBusObjectManager* /*manager*/, GDBusObject* object,
+                                    GDBusInterface* /*interface*/, gpointer user_data) {
+  static_cast<BluezBackend*>(user_data)->loadObject(object);
+}
+
+void BluezBackend::onInterfaceRemoved(GDBusObjectManager* /*manager*/, GDBusObject* object,
+                                      GDBusInterface* interface, gpointer user_data) {
+  auto* self = static_cast<BluezBackend*>(user_data);
+  std::string_view interface_name = g_dbus_proxy_get_interface_name(G_DBUS_PROXY(interface));
+  std::string path = g_dbus_object_get_object_path(object);
+
+  if (interface_name == ADAPTER_INTERFACE) {
+    if (self->controllers_.erase(path) != 0) {
+      self->notify(Change::CONTROLLER_REMOVED, path);
+    }
+  } else if (interface_name == DEVICE_INTERFACE) {
+    if (self->devices_.erase(path) != 0) {
+      self->notify(Change::DEVICE_REMOVED, path);
+    }
+  } else if (interface_name == BATTERY_INTERFACE) {
+    if (auto it = self->devices_.find(path); it != self->devices_.end()) {
+      it->second.battery_percentage.reset();
+      self->notify(Change::DEVICE_CHANGED, path);
+    }
+  }
+}
+
+void BluezBackend::onInterfaceProxyPropertiesChanged(GDBusObjectManagerClient* /*manager*/,
+                                                     GDBusObjectProxy* object_proxy,
+                                                     GDBusProxy* interface_proxy,
+                                                     GVariant* changed_properties,
+                                                     const gchar* const* invalidated_properties,
+                                                     gpointer user_data) {
+  auto* self = static_cast<BluezBackend*>(user_data);
+  std::string_view interface_name = g_dbus_proxy_get_interface_name(interface_proxy);
+  std::string path = g_dbus_object_get_object_path(G_DBUS_OBJECT(object_proxy));
+
+  if (interface_name == ADAPTER_INTERFACE) {
+    auto it = self->controllers_.find(path);
+    if (it == self->controllers_.end()) {
+      self->loadObject(G_DBUS_OBJECT(object_proxy));
+      return;
+    }
+    loadChangedProperties(changed_properties, it->second, applyControllerProperty);
+    self->notify(Change::CONTROLLER_CHANGED, path);
+  } else if (interface_name == DEVICE_INTERFACE || interface_name == BATTERY_INTERFACE) {
+    auto it = self->devices_.find(path);
+    if (it == self->devices_.end()) {
+      self->loadObject(G_DBUS_OBJECT(object_proxy));
+      return;
+    }
+    if (interface_name == DEVICE_INTERFACE) {
+      loadChangedProperties(changed_properties, it->second, applyDeviceProperty);
+      for (auto* name = invalidated_properties; name != nullptr && *name != nullptr; ++name) {
+        if (std::string_view(*name) == "Icon") {
+          it->second.icon.reset();
+        }
+      }
+    } else {
+      loadChangedProperties(changed_properties, it->second, applyBatteryProperty);
+    }
+    self->notify(Change::DEVICE_CHANGED, path);
+  }
+}
+
+}  // namespace waybar::util
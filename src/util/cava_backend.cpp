@@ -0,0 +1,286 @@
+#include "util/cava_backend.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace waybar::util {
+
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+void upThreadDelay(std::chrono::milliseconds& delay, std::chrono::seconds& delta) {
+  if (delta == std::chrono::seconds{0}) {
+    delta += std::chrono::seconds{1};
+    delay += delta;
+  }
+}
+
+void downThreadDelay(std::chrono::milliseconds& delay, std::chrono::seconds& delta) {
+  if (delta > std::chrono::seconds{0}) {
+    delay -= delta;
+    delta -= std::chrono::seconds{1};
+  }
+}
+
+}  // namespace
+
+std::shared_ptr<CavaBackend> CavaBackend::getInstance(const Json::Value& config) {
+  // Module instances of every output share the same engine as long as the configuration matches
+  static std::map<std::string, std::weak_ptr<CavaBackend>> instances;
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  const auto key = Json::writeString(builder, config);
+
+  auto backend = instances[key].lock();
+  if (!backend) {
+    private_constructor_tag tag;
+    backend = std::make_shared<CavaBackend>(config, tag);
+    instances[key] = backend;
+  }
+  return backend;
+}
+
+CavaBackend::CavaBackend(const Json::Value& config, private_constructor_tag tag) {
+  // Load waybar module config
+  char cfgPath[PATH_MAX];
+  cfgPath[0] = '\0';
+
+  if (config["cava_config"].isString()) strcpy(cfgPath, config["cava_config"].asString().data());
+  // Load cava config
+  error_.length = 0;
+
+  if (!load_config(cfgPath, &prm_, false, &error_)) {
+    spdlog::error("Error loading config. {0}", error_.message);
+    exit(EXIT_FAILURE);
+  }
+
+  // Override cava parameters by the user config
+  prm_.inAtty = 0;
+  prm_.output = cava::output_method::OUTPUT_RAW;
+  strcpy(prm_.data_format, "ascii");
+  strcpy(prm_.raw_target, "/dev/stdout");
+  // Graph rendering doesn't depend on format-icons and uses a fixed resolution instead
+  prm_.ascii_range = (config["graph"].isBool() && config["graph"].asBool())
+                         ? GRAPH_RANGE
+                         : config["format-icons"].size() - 1;
+
+  prm_.bar_width = 2;
+  prm_.bar_spacing = 0;
+  prm_.bar_height = 32;
+  prm_.bar_width = 1;
+  prm_.orientation = cava::ORIENT_TOP;
+  prm_.xaxis = cava::xaxis_scale::NONE;
+  prm_.mono_opt = cava::AVERAGE;
+  prm_.autobars = 0;
+  prm_.gravity = 0;
+  prm_.integral = 1;
+
+  if (config["framerate"].isInt()) prm_.framerate = config["framerate"].asInt();
+  if (config["autosens"].isInt()) prm_.autosens = config["autosens"].asInt();
+  if (config["sensitivity"].isInt()) prm_.sens = config["sensitivity"].asInt();
+  if (config["bars"].isInt()) prm_.fixedbars = config["bars"].asInt();
+  if (config["lower_cutoff_freq"].isNumeric())
+    prm_.lower_cut_off = config["lower_cutoff_freq"].asLargestInt();
+  if (config["higher_cutoff_freq"].isNumeric())
+    prm_.upper_cut_off = config["higher_cutoff_freq"].asLargestInt();
+  if (config["sleep_timer"].isInt()) prm_.sleep_timer = config["sleep_timer"].asInt();
+  if (config["method"].isString())
+    prm_.input = cava::input_method_by_name(config["method"].asString().c_str());
+  if (config["source"].isString()) prm_.audio_source = config["source"].asString().data();
+  if (config["sample_rate"].isNumeric()) prm_.samplerate = config["sample_rate"].asLargestInt();
+  if (config["sample_bits"].isInt()) prm_.samplebits = config["sample_bits"].asInt();
+  if (config["stereo"].isBool()) prm_.stereo = config["stereo"].asBool();
+  if (config["reverse"].isBool()) prm_.reverse = config["reverse"].asBool();
+  if (config["bar_delimiter"].isInt()) prm_.bar_delim = config["bar_delimiter"].asInt();
+  if (config["monstercat"].isBool()) prm_.monstercat = config["monstercat"].asBool();
+  if (config["waves"].isBool()) prm_.waves = config["waves"].asBool();
+  if (config["noise_reduction"].isDouble())
+    prm_.noise_reduction = config["noise_reduction"].asDouble();
+  if (config["input_delay"].isInt())
+    fetch_input_delay_ = std::chrono::seconds(config["input_delay"].asInt());
+  // Make cava parameters configuration
+  plan_ = new cava::cava_plan{};
+
+  audio_raw_.height = prm_.ascii_range;
+  audio_data_.format = -1;
+  audio_data_.source = new char[1 + strlen(prm_.audio_source)];
+  audio_data_.source[0] = '\0';
+  strcpy(audio_data_.source, prm_.audio_source);
+
+  audio_data_.rate = 0;
+  audio_data_.samples_counter = 0;
+  audio_data_.channels = 2;
+  audio_data_.IEEE_FLOAT = 0;
+
+  audio_data_.input_buffer_size = BUFFER_SIZE * audio_data_.channels;
+  audio_data_.cava_buffer_size = audio_data_.input_buffer_size * 8;
+
+  audio_data_.cava_in = new double[audio_data_.cava_buffer_size]{0.0};
+
+  audio_data_.terminate = 0;
+  audio_data_.suspendFlag = false;
+  input_source_ = get_input(&audio_data_, &prm_);
+
+  if (!input_source_) {
+    spdlog::error("cava API didn't provide input audio source method");
+    exit(EXIT_FAILURE);
+  }
+  // Calculate delay for the worker thread
+  frame_time_milsec_ = std::chrono::milliseconds((int)(1e3 / prm_.framerate));
+
+  // Init cava plan, audio_raw structure
+  audio_raw_init(&audio_data_, &audio_raw_, &prm_, plan_);
+  if (!plan_) spdlog::error("cava plan is not provided");
+  audio_raw_.previous_frame[0] = -1;  // For the first frame need to rePaint text message
+
+  frame_size_ = audio_raw_.number_of_bars;
+  frame_bars_ = std::make_unique<std::atomic<int>[]>(frame_size_);
+
+  // Read audio source trough cava API. Cava orginizes this process via infinity loop
+  thread_fetch_input_ = [this] {
+    thread_fetch_input_.sleep_for(fetch_input_delay_);
+    input_source_(&audio_data_);
+  };
+
+  // Run FFT off the main thread, modules only render the published frames
+  thread_ = [this] {
+    process();
+    thread_.sleep_for(frame_time_milsec_);
+  };
+}
+
+CavaBackend::~CavaBackend() {
+  audio_data_.terminate = 1;
+  thread_fetch_input_.stop();
+  thread_.stop();
+  delete plan_;
+  plan_ = nullptr;
+}
+
+void CavaBackend::process() {
+  pthread_mutex_lock(&audio_data_.lock);
+  const bool suspended = audio_data_.suspendFlag;
+  pthread_mutex_unlock(&audio_data_.lock);
+  if (suspended) {
+    upThreadDelay(frame_time_milsec_, suspend_silence_delay_);
+    return;
+  }
+
+  const bool was_silent = silence_;
+  silence_ = true;
+
+  for (int i{0}; i < audio_data_.input_buffer_size; ++i) {
+    if (audio_data_.cava_in[i]) {
+      silence_ = false;
+      sleep_counter_ = 0;
+      break;
+    }
+  }
+
+  if (silence_ && prm_.sleep_timer) {
+    if (sleep_counter_ <=
+        (int)(std::chrono::milliseconds(prm_.sleep_timer * 1s) / frame_time_milsec_)) {
+      ++sleep_counter_;
+      silence_ = false;
+    }
+  }
+
+  if (silence_) {
+    upThreadDelay(frame_time_milsec_, suspend_silence_delay_);
+    if (!was_silent) publish(true);
+    return;
+  }
+
+  downThreadDelay(frame_time_milsec_, suspend_silence_delay_);
+  // Process: execute cava
+  pthread_mutex_lock(&audio_data_.lock);
+  cava::cava_execute(audio_data_.cava_in, audio_data_.samples_counter, audio_raw_.cava_out, plan_);
+  if (audio_data_.samples_counter > 0) audio_data_.samples_counter = 0;
+  pthread_mutex_unlock(&audio_data_.lock);
+
+  // Do transformation under raw data
+  audio_raw_fetch(&audio_raw_, &prm_, &rePaint_, plan_);
+
+  if (rePaint_ == 1 || was_silent) {
+    for (int i{0}; i < audio_raw_.number_of_bars; ++i)
+      audio_raw_.previous_frame[i] = audio_raw_.bars[i];
+    publish(false);
+  }
+}
+
+void CavaBackend::publish(bool silent) {
+  // Single producer seqlock: readers retry if the sequence changed while they were copying
+  const auto seq = seq_.load(std::memory_order_relaxed);
+  seq_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  frame_silent_.store(silent, std::memory_order_relaxed);
+  if (!silent) {
+    const auto size = std::min(frame_size_, audio_raw_.number_of_bars);
+    for (int i{0}; i < size; ++i) {
+      const auto bar = audio_raw_.bars[i];
+      frame_bars_[i].store((bar > prm_.ascii_range) ? prm_.ascii_range : bar,
+                           std::memory_order_relaxed);
+    }
+  }
+
+  seq_.store(seq + 2, std::memory_order_release);
+  notify();
+}
+
+bool CavaBackend::readFrame(Frame& frame) const {
+  uint64_t begin;
+  uint64_t end;
+  bool silent;
+  frame.bars.resize(frame_size_);
+  do {
+    begin = seq_.load(std::memory_order_acquire);
+    if (begin == frame.generation) return false;
+    if (begin & 1) continue;
+
+    silent = frame_silent_.load(std::memory_order_relaxed);
+    for (int i{0}; i < frame_size_; ++i)
+      frame.bars[i] = frame_bars_[i].load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    end = seq_.load(std::memory_order_relaxed);
+  } while ((begin & 1) || begin != end);
+
+  frame.generation = begin;
+  frame.silent = silent;
+  return true;
+}
+
+int CavaBackend::subscribe(std::function<void()> cb) {
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  subscribers_.emplace(next_subscriber_id_, std::move(cb));
+  return next_subscriber_id_++;
+}
+
+void CavaBackend::unsubscribe(int id) {
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  subscribers_.erase(id);
+}
+
+void CavaBackend::notify() {
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  for (const auto& [id, cb] : subscribers_) cb();
+}
+
+// Cava actions
+void CavaBackend::pauseResume() {
+  pthread_mutex_lock(&audio_data_.lock);
+  if (audio_data_.suspendFlag) {
+    audio_data_.suspendFlag = false;
+    pthread_cond_broadcast(&audio_data_.resumeCond);
+  } else {
+    audio_data_.suspendFlag = true;
+  }
+  pthread_mutex_unlock(&audio_data_.lock);
+  thread_.wake_up();
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,100 @@
+#include "util/dbus.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <map>
+#include <string>
+#include <utility>
+
+namespace waybar::util::dbus {
+
+void getConnection(Gio::DBus::BusType bus_type, const Glib::RefPtr<Gio::Cancellable>& cancellable,
+                   ConnectionReady ready) {
+  Gio::DBus::Connection::get(
+      bus_type,
+      [cancellable, ready = std::move(ready)](Glib::RefPtr<Gio::AsyncResult>& result) {
+        if (cancellable->is_cancelled()) {
+          return;
+        }
+        try {
+          ready(Gio::DBus::Connection::get_finish(result));
+        } catch (const Glib::Error& e) {
+          spdlog::error("Unable to connect to DBus: {}", std::string(e.what()));
+        }
+      },
+      cancellable);
+}
+
+void createProxy(Gio::DBus::BusType bus_type, const Glib::ustring& name,
+                 const Glib::ustring& object_path, const Glib::ustring& interface_name,
+                 const Glib::RefPtr<Gio::Cancellable>& cancellable, ProxyReady ready) {
+  Gio::DBus::Proxy::create_for_bus(
+      bus_type, name, object_path, interface_name,
+      [cancellable, name, ready = std::move(ready)](Glib::RefPtr<Gio::AsyncResult>& result) {
+        if (cancellable->is_cancelled()) {
+          return;
+        }
+        try {
+          ready(Gio::DBus::Proxy::create_for_bus_finish(result));
+        } catch (const Glib::Error& e) {
+          spdlog::error("Unable to create DBus proxy for {}: {}", name.raw(),
+                        std::string(e.what()));
+        }
+      },
+      cancellable);
+}
+
+void call(const Glib::RefPtr<Gio::DBus::Proxy>& proxy, const Glib::ustring& method,
+          const Glib::VariantContainerBase& parameters,
+          const Glib::RefPtr<Gio::Cancellable>& cancellable, CallReady ready) {
+  proxy->call(
+      method,
+      [proxy, method, cancellable,
+       ready = std::move(ready)](Glib::RefPtr<Gio::AsyncResult>& result) {
+        if (cancellable->is_cancelled()) {
+          return;
+        }
+        try {
+          auto reply = proxy->call_finish(result);
+          if (ready) {
+            ready(reply);
+          }
+        } catch (const Glib::Error& e) {
+          spdlog::error("DBus call {} on {} failed: {}", method.raw(), proxy->get_name().raw(),
+                        std::string(e.what()));
+        }
+      },
+      cancellable, parameters);
+}
+
+void getProperty(const Glib::RefPtr<Gio::DBus::Proxy>& proxy, const Glib::ustring& interface_name,
+                 const Glib::ustring& property, const Glib::RefPtr<Gio::Cancellable>& cancellable,
+                 PropertyReady ready) {
+  auto parameters = Glib::VariantContainerBase(
+      g_variant_new("(ss)", interface_name.c_str(), property.c_str()));
+  call(proxy, "Get", parameters, cancellable,
+       [ready = std::move(ready)](const Glib::VariantContainerBase& reply) {
+         if (!reply.is_of_type(Glib::VariantType("(v)"))) {
+           return;
+         }
+         Glib::Variant<Glib::VariantBase> value;
+         reply.get_child(value, 0);
+         ready(value.get());
+       });
+}
+
+std::optional<Glib::VariantBase> changedProperty(const Glib::VariantContainerBase& parameters,
+                                                 const Glib::ustring& property) {
+  if (!parameters.is_of_type(Glib::VariantType("(sa{sv}as)"))) {
+    return std::nullopt;
+  }
+  Glib::Variant<std::map<Glib::ustring, Glib::VariantBase>> changed;
+  parameters.get_child(changed, 1);
+  auto properties = changed.get();
+  if (auto it = properties.find(property); it != properties.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+}  // namespace waybar::util::dbus
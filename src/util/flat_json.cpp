@@ -0,0 +1,238 @@
+#include "util/flat_json.hpp"
+
+#include <charconv>
+#include <cstdint>
+
+namespace waybar::util {
+
+namespace {
+
+void skipWhitespace(std::string_view s, size_t& pos) {
+  while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\n' || s[pos] == '\r')) {
+    ++pos;
+  }
+}
+
+bool consume(std::string_view s, size_t& pos, char c) {
+  skipWhitespace(s, pos);
+  if (pos < s.size() && s[pos] == c) {
+    ++pos;
+    return true;
+  }
+  return false;
+}
+
+bool parseHex(std::string_view s, size_t& pos, size_t digits, uint32_t& out) {
+  if (pos + digits > s.size()) {
+    return false;
+  }
+  auto [end, ec] = std::from_chars(s.data() + pos, s.data() + pos + digits, out, 16);
+  if (ec != std::errc() || end != s.data() + pos + digits) {
+    return false;
+  }
+  pos += digits;
+  return true;
+}
+
+void appendUtf8(std::string& out, uint32_t cp) {
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += static_cast<char>(0xE0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+}
+
+bool parseEscape(std::string_view s, size_t& pos, std::string& out) {
+  if (pos >= s.size()) {
+    return false;
+  }
+  const char c = s[pos++];
+  switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+      out += c;
+      return true;
+    case 'b':
+      out += '\b';
+      return true;
+    case 'f':
+      out += '\f';
+      return true;
+    case 'n':
+      out += '\n';
+      return true;
+    case 'r':
+      out += '\r';
+      return true;
+    case 't':
+      out += '\t';
+      return true;
+    case 'x': {
+      uint32_t cp;
+      if (!parseHex(s, pos, 2, cp)) {
+        return false;
+      }
+      appendUtf8(out, cp);
+      return true;
+    }
+    case 'u': {
+      uint32_t cp;
+      if (!parseHex(s, pos, 4, cp)) {
+        return false;
+      }
+      // Characters outside the BMP are sent as a surrogate pair
+      if (cp >= 0xD800 && cp < 0xDC00) {
+        uint32_t low;
+        if (pos + 2 > s.size() || s[pos] != '\\' || s[pos + 1] != 'u') {
+          return false;
+        }
+        pos += 2;
+        if (!parseHex(s, pos, 4, low) || low < 0xDC00 || low >= 0xE000) {
+          return false;
+        }
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+      } else if (cp >= 0xDC00 && cp < 0xE000) {
+        return false;
+      }
+      appendUtf8(out, cp);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+bool parseString(std::string_view s, size_t& pos, std::string& out) {
+  out.clear();
+  if (!consume(s, pos, '"')) {
+    return false;
+  }
+  while (pos < s.size()) {
+    // Copy unescaped runs at once
+    const auto end = s.find_first_of("\"\\", pos);
+    if (end == std::string_view::npos) {
+      return false;
+    }
+    out.append(s.substr(pos, end - pos));
+    pos = end + 1;
+    if (s[end] == '"') {
+      return true;
+    }
+    if (!parseEscape(s, pos, out)) {
+      return false;
+    }
+  }
+  return false;
+}
+
+bool parseLiteral(std::string_view s, size_t& pos, std::string_view literal) {
+  if (s.substr(pos, literal.size()) != literal) {
+    return false;
+  }
+  pos += literal.size();
+  return true;
+}
+
+bool parseNumber(std::string_view s, size_t& pos, double& out) {
+  // from_chars also accepts "inf" and "nan", which are not JSON
+  const size_t digit = s[pos] == '-' ? pos + 1 : pos;
+  if (digit >= s.size() || s[digit] < '0' || s[digit] > '9') {
+    return false;
+  }
+  auto [end, ec] = std::from_chars(s.data() + pos, s.data() + s.size(), out);
+  if (ec != std::errc()) {
+    return false;
+  }
+  pos = end - s.data();
+  return true;
+}
+
+bool parseStringArray(std::string_view s, size_t& pos, std::vector<std::string>& out) {
+  size_t count = 0;
+  ++pos;
+  if (!consume(s, pos, ']')) {
+    do {
+      if (count == out.size()) {
+        out.emplace_back();
+      }
+      if (!parseString(s, pos, out[count++])) {
+        return false;
+      }
+    } while (consume(s, pos, ','));
+    if (!consume(s, pos, ']')) {
+      return false;
+    }
+  }
+  out.resize(count);
+  return true;
+}
+
+bool parseValue(std::string_view s, size_t& pos, FlatJsonValue& value) {
+  skipWhitespace(s, pos);
+  if (pos >= s.size()) {
+    return false;
+  }
+  switch (s[pos]) {
+    case '"':
+      value.type = FlatJsonValue::Type::STRING;
+      return parseString(s, pos, value.string);
+    case '[':
+      value.type = FlatJsonValue::Type::STRING_ARRAY;
+      return parseStringArray(s, pos, value.strings);
+    case 't':
+    case 'f':
+      value.type = FlatJsonValue::Type::BOOL;
+      value.boolean = s[pos] == 't';
+      return parseLiteral(s, pos, value.boolean ? "true" : "false");
+    case 'n':
+      value.type = FlatJsonValue::Type::NUL;
+      return parseLiteral(s, pos, "null");
+    default:
+      value.type = FlatJsonValue::Type::NUMBER;
+      return parseNumber(s, pos, value.number);
+  }
+}
+
+}  // namespace
+
+FlatJsonMember& FlatJsonReader::nextMember() {
+  if (size_ == members_.size()) {
+    members_.emplace_back();
+  }
+  return members_[size_++];
+}
+
+bool FlatJsonReader::parse(std::string_view line) {
+  size_ = 0;
+  size_t pos = 0;
+  if (!consume(line, pos, '{')) {
+    return false;
+  }
+  if (!consume(line, pos, '}')) {
+    do {
+      auto& member = nextMember();
+      if (!parseString(line, pos, member.key) || !consume(line, pos, ':') ||
+          !parseValue(line, pos, member.value)) {
+        return false;
+      }
+    } while (consume(line, pos, ','));
+    if (!consume(line, pos, '}')) {
+      return false;
+    }
+  }
+  skipWhitespace(line, pos);
+  return pos == line.size();
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,110 @@
+#include "util/metrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace waybar::util::metrics {
+
+namespace detail {
+std::atomic<bool> enabled{false};
+}
+
+namespace {
+
+std::mutex registry_mutex;
+std::map<std::string, std::map<std::string, std::unique_ptr<Histogram>>> registry;
+
+}  // namespace
+
+void setEnabled(bool enabled) { detail::enabled.store(enabled, std::memory_order_relaxed); }
+
+void Histogram::record(int64_t value) {
+  const auto v = static_cast<uint64_t>(std::max<int64_t>(value, 0));
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(v, std::memory_order_relaxed);
+
+  auto min = min_.load(std::memory_order_relaxed);
+  while (v < min && !min_.compare_exchange_weak(min, v, std::memory_order_relaxed)) {
+  }
+  auto max = max_.load(std::memory_order_relaxed);
+  while (v > max && !max_.compare_exchange_weak(max, v, std::memory_order_relaxed)) {
+  }
+
+  const auto bucket = std::min<size_t>(std::bit_width(v), BUCKETS - 1);
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+Json::Value Histogram::toJson() const {
+  Json::Value json(Json::objectValue);
+  const auto count = count_.load(std::memory_order_relaxed);
+  json["count"] = Json::UInt64(count);
+  if (count == 0) {
+    return json;
+  }
+  const auto sum = sum_.load(std::memory_order_relaxed);
+  json["sum"] = Json::UInt64(sum);
+  json["min"] = Json::UInt64(min_.load(std::memory_order_relaxed));
+  json["max"] = Json::UInt64(max_.load(std::memory_order_relaxed));
+  json["mean"] = static_cast<double>(sum) / static_cast<double>(count);
+
+  // Percentiles are reported as the upper bound of the bucket they fall in
+  std::array<uint64_t, BUCKETS> buckets;
+  uint64_t total = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += buckets[i];
+  }
+  constexpr std::array<std::pair<const char*, uint64_t>, 3> PERCENTILES{
+      {{"p50", 50}, {"p90", 90}, {"p99", 99}}};
+  for (auto [name, percentile] : PERCENTILES) {
+    const auto rank = (total * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      seen += buckets[i];
+      if (seen >= rank) {
+        json[name] = Json::UInt64((uint64_t{1} << i) - 1);
+        break;
+      }
+    }
+  }
+  return json;
+}
+
+Histogram* histogram(const std::string& module, const std::string& metric) {
+  if (!enabled()) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto& histogram = registry[module][metric];
+  if (!histogram) {
+    histogram = std::make_unique<Histogram>();
+  }
+  return histogram.get();
+}
+
+Json::Value toJson() {
+  Json::Value json(Json::objectValue);
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (const auto& [module, metrics] : registry) {
+    for (const auto& [metric, histogram] : metrics) {
+      json[module][metric] = histogram->toJson();
+    }
+  }
+  return json;
+}
+
+bool dump(const std::string& path) {
+  std::ofstream file(path);
+  if (!file) {
+    return false;
+  }
+  file << toJson().toStyledString();
+  return static_cast<bool>(file);
+}
+
+}  // namespace waybar::util::metrics
@@ -0,0 +1,68 @@
+#include "util/netdev.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace waybar::util {
+
+namespace {
+
+constexpr std::string_view WHITESPACE = " \t";
+
+// Parses the next whitespace separated column, advances `pos` past it
+unsigned long long nextColumn(std::string_view line, std::string_view::size_type& pos) {
+  unsigned long long value = 0ull;
+  pos = line.find_first_not_of(WHITESPACE, pos);
+  if (pos == std::string_view::npos) {
+    pos = line.size();
+    return value;
+  }
+  auto [ptr, ec] = std::from_chars(line.data() + pos, line.data() + line.size(), value);
+  pos = ptr - line.data();
+  // skip the rest of a malformed column
+  pos = std::min(line.find_first_of(WHITESPACE, pos), line.size());
+  return value;
+}
+
+}  // namespace
+
+std::pair<unsigned long long, unsigned long long> parseNetdevBytes(std::string_view netdev,
+                                                                   std::string_view ifname) {
+  std::string_view::size_type pos = 0;
+  // skip the headers (first two lines)
+  for (int i = 0; i < 2 && pos != std::string_view::npos; ++i) {
+    pos = netdev.find('\n', pos);
+    if (pos != std::string_view::npos) ++pos;
+  }
+
+  while (pos != std::string_view::npos && pos < netdev.size()) {
+    auto eol = netdev.find('\n', pos);
+    auto line = netdev.substr(pos, eol == std::string_view::npos ? eol : eol - pos);
+    pos = eol == std::string_view::npos ? eol : eol + 1;
+
+    // line starts with the right aligned "eth0:"
+    auto colon = line.find(':');
+    if (colon == std::string_view::npos) continue;
+    auto name = line.substr(0, colon);
+    name.remove_prefix(std::min(name.find_first_not_of(WHITESPACE), name.size()));
+    if (name != ifname) continue;
+
+    // The rest of the line consists of whitespace separated counts divided
+    // into two groups (receive and transmit). Each group has the following
+    // columns: bytes, packets, errs, drop, fifo, frame, compressed, multicast
+    //
+    // We only care about the bytes count, so we'll just ignore the 7 other
+    // columns.
+    auto col = colon + 1;
+    auto received = nextColumn(line, col);
+    for (int colsToSkip = 7; colsToSkip > 0; colsToSkip--) {
+      nextColumn(line, col);
+    }
+    auto transmitted = nextColumn(line, col);
+    return {received, transmitted};
+  }
+
+  return {0ull, 0ull};
+}
+
+}  // namespace waybar::util
@@ -3,15 +3,135 @@
 #include <json/value.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cctype>
+#include <locale>
+#include <string_view>
 #include <utility>
 
 namespace waybar::util {
 
+namespace {
+
+// Print cache statistics every this many lookups
+constexpr std::size_t STATS_INTERVAL = 1024;
+
+// Same case folding std::regex uses for icase, so the literal check never rejects a match
+std::string to_lower(std::string_view str) {
+  std::string lower{str};
+  const auto& ctype = std::use_facet<std::ctype<char>>(std::locale());
+  ctype.tolower(lower.data(), lower.data() + lower.size());
+  return lower;
+}
+
+// Length of the operand following the escaped character at `pos`
+std::size_t escape_operand_size(std::string_view pattern, std::size_t pos) {
+  if (pos >= pattern.size()) return 0;
+  const auto count = [&](std::size_t max, auto is_operand) {
+    std::size_t n = 0;
+    while (n < max && pos + 1 + n < pattern.size() &&
+           is_operand(static_cast<unsigned char>(pattern[pos + 1 + n]))) {
+      ++n;
+    }
+    return n;
+  };
+  const auto is_hex = [](unsigned char ch) { return std::isxdigit(ch) != 0; };
+  const auto is_digit = [](unsigned char ch) { return std::isdigit(ch) != 0; };
+  switch (pattern[pos]) {
+    case 'x':
+      return count(2, is_hex);
+    case 'u':
+      return count(4, is_hex);
+    case 'c':
+      return count(1, [](unsigned char ch) { return std::isalpha(ch) != 0; });
+    default:
+      // Multi-digit back references
+      return is_digit(static_cast<unsigned char>(pattern[pos])) ? count(pattern.size(), is_digit)
+                                                                 : 0;
+  }
+}
+
+}  // namespace
+
 int default_priority_function(std::string& key) { return 0; }
 
+std::string required_literal(const std::string& pattern) {
+  // Any alternation may make every literal optional
+  if (pattern.find('|') != std::string::npos) return {};
+
+  std::string best;
+  std::string run;
+  int depth = 0;
+  const auto end_run = [&] {
+    if (run.size() > best.size()) best = run;
+    run.clear();
+  };
+
+  for (std::size_t i = 0; i < pattern.size(); ++i) {
+    const char c = pattern[i];
+    switch (c) {
+      case '\\':
+        // Escaped punctuation is a literal, escaped letters and digits are classes or references
+        if (i + 1 < pattern.size() && depth == 0 &&
+            !std::isalnum(static_cast<unsigned char>(pattern[i + 1]))) {
+          run += pattern[++i];
+        } else {
+          // The escape and its operand (\xhh, \uhhhh, \cX, \12) are no literal text
+          end_run();
+          i += 1 + escape_operand_size(pattern, i + 1);
+        }
+        break;
+      case '[':
+        end_run();
+        // Skip the class, a leading ']' or '^]' is part of it
+        if (i + 1 < pattern.size() && pattern[i + 1] == '^') ++i;
+        if (i + 1 < pattern.size() && pattern[i + 1] == ']') ++i;
+        while (++i < pattern.size() && pattern[i] != ']') {
+          if (pattern[i] == '\\') ++i;
+        }
+        break;
+      case '(':
+        end_run();
+        ++depth;
+        break;
+      case ')':
+        end_run();
+        --depth;
+        break;
+      case '?':
+      case '*':
+      case '{':
+        // The previous character is optional
+        if (!run.empty()) run.pop_back();
+        end_run();
+        if (c == '{') {
+          while (i + 1 < pattern.size() && pattern[i] != '}') ++i;
+        }
+        break;
+      case '+':
+        // The previous character is required but may repeat
+        end_run();
+        break;
+      case '.':
+      case '^':
+      case '$':
+        end_run();
+        break;
+      default:
+        if (depth == 0) {
+          run += c;
+        }
+        break;
+    }
+  }
+  end_run();
+  return to_lower(best);
+}
+
 RegexCollection::RegexCollection(const Json::Value& map, std::string default_repr,
-                                 const std::function<int(std::string&)>& priority_function)
-    : default_repr(std::move(default_repr)) {
+                                 const std::function<int(std::string&)>& priority_function,
+                                 std::size_t cache_size)
+    : regex_cache(cache_size), default_repr(std::move(default_repr)) {
   if (!map.isObject()) {
     spdlog::warn("Mapping is not an object");
     return;
@@ -23,18 +143,33 @@ RegexCollection::RegexCollection(const Json::Value& map, std::string default_rep
       int priority = priority_function(key);
       try {
         const std::regex rule{key, std::regex_constants::icase};
-        rules.emplace_back(rule, it->asString(), priority);
+        rules.emplace_back(rule, it->asString(), priority, required_literal(key));
       } catch (const std::regex_error& e) {
         spdlog::error("Invalid rule '{}': {}", key, e.what());
       }
     }
   }
 
-  std::sort(rules.begin(), rules.end(), [](Rule& a, Rule& b) { return a.priority > b.priority; });
+  // Keep the configuration order for rules of the same priority
+  std::stable_sort(rules.begin(), rules.end(),
+                   [](const Rule& a, const Rule& b) { return a.priority > b.priority; });
+}
+
+RegexCollection::~RegexCollection() {
+  if (cache_hits + cache_misses > 0) {
+    log_stats();
+  }
 }
 
 std::string RegexCollection::find_match(std::string& value, bool& matched_any) {
+  // Rules are case insensitive, so compare literals against a lowercase copy
+  const std::string lower = to_lower(value);
+  const std::string_view haystack{lower};
+
   for (auto& rule : rules) {
+    if (!rule.literal.empty() && haystack.find(rule.literal) == std::string_view::npos) {
+      continue;
+    }
     std::smatch match;
     if (std::regex_search(value, match, rule.rule)) {
       matched_any = true;
@@ -46,12 +181,20 @@ std::string RegexCollection::find_match(std::string& value, bool& matched_any) {
 }
 
 std::string& RegexCollection::get(std::string& value, bool& matched_any) {
-  if (regex_cache.contains(value)) {
-    return regex_cache[value];
+  auto* cached = regex_cache.find(value);
+  if (cached != nullptr) {
+    ++cache_hits;
+  } else {
+    ++cache_misses;
+  }
+  if ((cache_hits + cache_misses) % STATS_INTERVAL == 0) {
+    log_stats();
   }
 
-  // std::string repr =
-  // waybar::util::find_match(value, window_rewrite_rules_, matched_any);
+  if (cached != nullptr) {
+    matched_any = cached->matched_any;
+    return cached->repr;
+  }
 
   std::string repr = find_match(value, matched_any);
 
@@ -59,9 +202,7 @@ std::string& RegexCollection::get(std::string& value, bool& matched_any) {
     repr = default_repr;
   }
 
-  regex_cache.emplace(value, repr);
-
-  return regex_cache[value];  // Necessary in order to return a reference to the heap
+  return regex_cache.insert(value, {std::move(repr), matched_any}).repr;
 }
 
 std::string& RegexCollection::get(std::string& value) {
@@ -69,4 +210,9 @@ std::string& RegexCollection::get(std::string& value) {
   return get(value, matched_any);
 }
 
+void RegexCollection::log_stats() const {
+  spdlog::debug("Regex cache: {} hits, {} misses, {}/{} entries, {} rules", cache_hits,
+                cache_misses, regex_cache.size(), regex_cache.capacity(), rules.size());
+}
+
 }  // namespace waybar::util
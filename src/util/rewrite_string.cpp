@@ -29,4 +29,50 @@ std::string rewriteString(const std::string& value, const Json::Value& rules) {
 
   return res;
 }
+
+RewriteRuleSet::RewriteRuleSet(const Json::Value& rules, std::size_t cache_size)
+    : cache_(cache_size) {
+  if (!rules.isObject()) {
+    return;
+  }
+
+  for (auto it = rules.begin(); it != rules.end(); ++it) {
+    if (it.key().isString() && it->isString()) {
+      try {
+        // malformated regexes will cause an exception.
+        // in this case, log error and skip the rule.
+        rules_.push_back(
+            {std::regex{it.key().asString(),
+                        std::regex_constants::icase | std::regex_constants::optimize},
+             it->asString()});
+      } catch (const std::regex_error& e) {
+        spdlog::error("Invalid rule {}: {}", it.key().asString(), e.what());
+      }
+    }
+  }
+}
+
+std::string RewriteRuleSet::rewrite(const std::string& value) const {
+  std::string res = value;
+
+  for (const auto& rule : rules_) {
+    if (std::regex_match(value, rule.regex)) {
+      res = std::regex_replace(res, rule.regex, rule.replacement);
+    }
+  }
+
+  return res;
+}
+
+std::string RewriteRuleSet::apply(const std::string& value) {
+  if (rules_.empty()) {
+    return value;
+  }
+
+  if (auto* cached = cache_.find(value); cached != nullptr) {
+    return *cached;
+  }
+
+  return cache_.insert(value, rewrite(value));
+}
 }  // namespace waybar::util
@@ -1,23 +1,55 @@
-#include <array>
+#include <cstddef>
 #include <string>
 #include <util/sanitize_str.hpp>
-#include <utility>
 
 namespace waybar::util {
+
+namespace {
+
+// Number of bytes the escaped form of `c` adds. Branch-free so the counting loop vectorizes.
+constexpr std::size_t extra_length(char c) {
+  return (c == '&') * 4 + (c == '<') * 3 + (c == '>') * 3 + (c == '"') * 5 + (c == '\'') * 5;
+}
+
+}  // namespace
+
 // replaces ``<>&"'`` with their encoded counterparts
 std::string sanitize_string(std::string str) {
-  // note: it's important that '&' is replaced first; therefore we *can't* use std::map
-  const std::pair<char, std::string> replacement_table[] = {
-      {'&', "&amp;"}, {'<', "&lt;"}, {'>', "&gt;"}, {'"', "&quot;"}, {'\'', "&apos;"}};
-  size_t startpoint;
-  for (const auto& pair : replacement_table) {
-    startpoint = 0;
-    while ((startpoint = str.find(pair.first, startpoint)) != std::string::npos) {
-      str.replace(startpoint, 1, pair.second);
-      startpoint += pair.second.length();
+  std::size_t extra = 0;
+  for (const char c : str) extra += extra_length(c);
+  // Most strings don't contain anything to escape, hand them back without copying
+  if (extra == 0) return str;
+
+  std::string res;
+  res.reserve(str.size() + extra);
+  std::size_t start = 0;
+  for (std::size_t i = 0; i < str.size(); ++i) {
+    const char* replacement;
+    switch (str[i]) {
+      case '&':
+        replacement = "&amp;";
+        break;
+      case '<':
+        replacement = "&lt;";
+        break;
+      case '>':
+        replacement = "&gt;";
+        break;
+      case '"':
+        replacement = "&quot;";
+        break;
+      case '\'':
+        replacement = "&apos;";
+        break;
+      default:
+        continue;
     }
+    res.append(str, start, i - start);
+    res.append(replacement);
+    start = i + 1;
   }
+  res.append(str, start, std::string::npos);
 
-  return str;
+  return res;
 }
 }  // namespace waybar::util
@@ -0,0 +1,119 @@
+#include "util/update_dispatcher.hpp"
+
+#include <glibmm/dispatcher.h>
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+#include "util/metrics.hpp"
+#include "util/scope_guard.hpp"
+
+namespace waybar::util {
+
+class UpdateQueue {
+ public:
+  static UpdateQueue& instance() {
+    static UpdateQueue queue;
+    return queue;
+  }
+
+  void push(UpdateDispatcher* dispatcher) {
+    bool wake;
+    {
+      std::lock_guard lock(mutex_);
+      wake = pending_.empty();
+      pending_.push_back(dispatcher);
+    }
+    // The main loop is already going to run the other pending updates
+    if (wake) {
+      dispatcher_.emit();
+    }
+  }
+
+  void remove(UpdateDispatcher* dispatcher) {
+    {
+      std::lock_guard lock(mutex_);
+      pending_.erase(std::remove(pending_.begin(), pending_.end(), dispatcher), pending_.end());
+    }
+    std::replace(running_.begin(), running_.end(), dispatcher,
+                 static_cast<UpdateDispatcher*>(nullptr));
+  }
+
+ private:
+  UpdateQueue() { dispatcher_.connect([this] { run(); }); }
+
+  void run() {
+    {
+      std::lock_guard lock(mutex_);
+      running_.swap(pending_);
+    }
+    size_t next = 0;
+    // A throwing slot must not leave the updates behind it pending forever: their flags are still
+    // set, so their emits won't queue them again. Hand them back to the next run.
+    ScopeGuard finish([this, &next] {
+      if (next < running_.size()) {
+        requeue(next);
+      }
+      running_.clear();
+    });
+    // An update may destroy a module whose update is still queued, see remove()
+    while (next < running_.size()) {
+      auto* dispatcher = running_[next++];
+      if (dispatcher == nullptr) {
+        continue;
+      }
+      // Emits from now on need another update. Acquire from every emit that found the flag set
+      // and skipped the push, so the slot sees what those producers wrote before emitting.
+      dispatcher->pending_.exchange(false, std::memory_order_acq_rel);
+      if (dispatcher->slot_) {
+        dispatcher->slot_();
+      }
+    }
+  }
+
+  void requeue(size_t from) {
+    bool wake;
+    {
+      std::lock_guard lock(mutex_);
+      wake = pending_.empty();
+      std::copy_if(running_.begin() + from, running_.end(),
+                   std::inserter(pending_, pending_.begin()),
+                   [](auto* dispatcher) { return dispatcher != nullptr; });
+      wake = wake && !pending_.empty();
+    }
+    if (wake) {
+      dispatcher_.emit();
+    }
+  }
+
+  Glib::Dispatcher dispatcher_;
+  std::mutex mutex_;
+  std::vector<UpdateDispatcher*> pending_;
+  // Only used by the main thread
+  std::vector<UpdateDispatcher*> running_;
+};
+
+UpdateDispatcher::UpdateDispatcher() {
+  // The shared Glib::Dispatcher has to be created on the main thread
+  UpdateQueue::instance();
+}
+
+UpdateDispatcher::~UpdateDispatcher() {
+  if (pending_.load(std::memory_order_acquire)) {
+    UpdateQueue::instance().remove(this);
+  }
+}
+
+void UpdateDispatcher::emit() {
+  if (metrics::enabled()) {
+    int64_t none = 0;
+    requested_.compare_exchange_strong(none, metrics::nowUs(), std::memory_order_relaxed);
+  }
+  if (!pending_.exchange(true, std::memory_order_acq_rel)) {
+    UpdateQueue::instance().push(this);
+  }
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,23 @@
+#include "util/format.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <fmt/format.h>
+
+#include <string>
+
+TEST_CASE("Format sizes and rates", "[bench][format]") {
+  // Network and disk module style formats
+  const std::string format = "⇣{:>} ⇡{:>} {:=} used";
+
+  REQUIRE(fmt::format("{}", pow_format(1536, "B", true)) == "1.5kiB");
+
+  BENCHMARK("pow_format") {
+    return fmt::format(fmt::runtime(format), pow_format(12345678, "b/s"),
+                       pow_format(4321, "b/s"), pow_format(987654321, "B", true));
+  };
+}
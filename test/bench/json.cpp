@@ -0,0 +1,55 @@
+#include "util/json.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "util/flat_json.hpp"
+
+namespace {
+
+// Payloads recorded from the compositors, see test/bench/fixtures
+std::string readFixture(const std::string& name) {
+  std::ifstream file("test/bench/fixtures/" + name);
+  REQUIRE(file.is_open());
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+}  // namespace
+
+TEST_CASE("Parse compositor IPC payloads", "[bench][json]") {
+  waybar::util::JsonParser parser;
+  const auto hyprland = readFixture("hyprland_clients.json");
+  const auto sway = readFixture("sway_tree.json");
+  const auto niri = readFixture("niri_windows.json");
+
+  REQUIRE(parser.parse(hyprland).size() == 24);
+  REQUIRE(parser.parse(sway)["nodes"].size() == 2);
+  REQUIRE(parser.parse(niri)["WindowsChanged"]["windows"].size() == 16);
+
+  BENCHMARK("JsonParser::parse, Hyprland clients") { return parser.parse(hyprland); };
+  BENCHMARK("JsonParser::parse, Sway tree") { return parser.parse(sway); };
+  BENCHMARK("JsonParser::parse, Niri event") { return parser.parse(niri); };
+}
+
+TEST_CASE("Parse custom module output", "[bench][json]") {
+  waybar::util::JsonParser parser;
+  waybar::util::FlatJsonReader reader;
+  const std::string line =
+      R"({"text": "  42%", "alt": "playing", "tooltip": "Artist - Title\nAlbum, 2024", )"
+      R"("class": ["playing", "spotify"], "percentage": 42})";
+
+  REQUIRE(reader.parse(line));
+
+  BENCHMARK("JsonParser::parse") { return parser.parse(line); };
+  BENCHMARK("FlatJsonReader::parse") { return reader.parse(line); };
+}
@@ -0,0 +1,28 @@
+#include "util/netdev.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+TEST_CASE("Parse /proc/net/dev", "[bench][netdev]") {
+  // Host with containers and a VPN, the interface of interest is not the first one
+  std::ifstream file("test/bench/fixtures/net_dev");
+  REQUIRE(file.is_open());
+  std::stringstream ss;
+  ss << file.rdbuf();
+  const auto netdev = ss.str();
+
+  REQUIRE(waybar::util::parseNetdevBytes(netdev, "wlp2s0").first == 4567890123ull);
+
+  BENCHMARK("parseNetdevBytes") { return waybar::util::parseNetdevBytes(netdev, "wlp2s0"); };
+  BENCHMARK("parseNetdevBytes, last interface") {
+    return waybar::util::parseNetdevBytes(netdev, "tailscale0");
+  };
+}
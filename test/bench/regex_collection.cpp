@@ -0,0 +1,80 @@
+#include "util/regex_collection.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <fmt/format.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// Window rewrite map of a taskbar or workspace module
+Json::Value makeMap() {
+  Json::Value map;
+  map["class<firefox>"] = "🌎";
+  map["class<firefox> title<.*github.*>"] = "";
+  map["class<(chromium|google-chrome)>"] = "🌐";
+  map["class<(code|codium)>"] = "💻";
+  map["class<(kitty|foot|alacritty)>"] = "💲";
+  map["class<kitty> title<nvim.*>"] = "📝";
+  map["class<org.telegram.desktop>"] = "✈";
+  map["class<(discord|vesktop)>"] = "💬";
+  map["class<Slack>"] = "💬";
+  map["class<thunderbird>"] = "📧";
+  map["class<Spotify>"] = "🎵";
+  map["class<(mpv|vlc)>"] = "🎬";
+  map["class<gimp.*>"] = "🎨";
+  map["class<libreoffice-.*>"] = "📝";
+  map["class<steam>"] = "🎮";
+  map["title<.*YouTube.*>"] = "📺";
+  map["title<.*Twitch.*>"] = "📺";
+  return map;
+}
+
+// `distinct` windows per kind, repeated to 50 windows per kind
+std::vector<std::string> makeWindows(int distinct) {
+  std::vector<std::string> windows;
+  for (int i = 0; i < 50; ++i) {
+    const auto n = i % distinct;
+    windows.push_back(fmt::format("class<kitty> title<nvim src/file_{}.cpp>", n));
+    windows.push_back(fmt::format("class<firefox> title<Issue #{} · github.com>", 1000 + n));
+    windows.push_back(fmt::format("class<Spotify> title<Track {}>", n));
+  }
+  return windows;
+}
+
+}  // namespace
+
+TEST_CASE("Match window representations", "[bench][regex_collection]") {
+  const auto map = makeMap();
+
+  // A few windows whose titles repeat, mostly cache hits
+  auto windows = makeWindows(5);
+  waybar::util::RegexCollection collection{map, "?"};
+  BENCHMARK("RegexCollection::get") {
+    std::size_t total = 0;
+    for (auto& window : windows) {
+      total += collection.get(window).size();
+    }
+    return total;
+  };
+
+  // Every lookup misses: distinct strings, and each run starts from a copy of an unused collection
+  auto distinctWindows = makeWindows(50);
+  const waybar::util::RegexCollection unused{map, "?"};
+  BENCHMARK_ADVANCED("RegexCollection::get, cold cache")(Catch::Benchmark::Chronometer meter) {
+    std::vector<waybar::util::RegexCollection> collections(meter.runs(), unused);
+    meter.measure([&](int run) {
+      std::size_t total = 0;
+      for (auto& window : distinctWindows) {
+        total += collections[run].get(window).size();
+      }
+      return total;
+    });
+  };
+}
@@ -0,0 +1,99 @@
+#include "util/rewrite_string.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <fmt/format.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// Rewrite rules similar to the ones found in user configurations
+Json::Value makeRules() {
+  Json::Value rules;
+  rules["(.*) — Mozilla Firefox"] = "🌎 $1";
+  rules["(.*) - Mozilla Firefox"] = "🌎 $1";
+  rules["(.*) — Chromium"] = "🌐 $1";
+  rules["(.*) - Google Chrome"] = "🌐 $1";
+  rules["(.*) - Visual Studio Code"] = "💻 $1";
+  rules["(.*) - VSCodium"] = "💻 $1";
+  rules["(.*) - Thunderbird"] = "📧 $1";
+  rules["(.*) - Discord"] = "💬 $1";
+  rules["Slack \\| (.*)"] = "💬 $1";
+  rules["(.*) - Telegram"] = "✈ $1";
+  rules["Spotify( Premium)?"] = "🎵 Spotify";
+  rules["(.*) - mpv"] = "🎬 $1";
+  rules["(.*) - VLC media player"] = "🎬 $1";
+  rules["(.*) - GIMP"] = "🎨 $1";
+  rules["(.*) - Inkscape"] = "🎨 $1";
+  rules["(.*) - LibreOffice Writer"] = "📝 $1";
+  rules["(.*) - LibreOffice Calc"] = "📊 $1";
+  rules["(.*) - Zathura"] = "📖 $1";
+  rules["(.*) - Okular"] = "📖 $1";
+  rules["(.*) - Steam"] = "🎮 $1";
+  rules["nvim (.*)"] = "📝 $1";
+  rules["vim (.*)"] = "📝 $1";
+  rules["htop"] = "📈 htop";
+  rules["btop"] = "📈 btop";
+  rules["ssh (.*)"] = "🔒 $1";
+  rules["(.*)@(.*): (.*)"] = "💲 $3";
+  rules["foot"] = "💲 foot";
+  rules["Alacritty"] = "💲 Alacritty";
+  rules["kitty"] = "💲 kitty";
+  rules["(.*) - Thunar"] = "📁 $1";
+  return rules;
+}
+
+// A terminal that sets its title for every command plus a browser switching between tabs
+std::vector<std::string> makeTitles() {
+  std::vector<std::string> titles;
+  for (int i = 0; i < 50; ++i) {
+    titles.push_back(fmt::format("user@host: ~/src/project/build-{}", i % 10));
+    titles.push_back(fmt::format("Issue #{} · waybar - Mozilla Firefox", 1000 + i % 5));
+    titles.push_back(fmt::format("nvim src/file_{}.cpp", i % 7));
+  }
+  return titles;
+}
+
+}  // namespace
+
+TEST_CASE("Rewrite window titles", "[bench][rewrite]") {
+  const auto rules = makeRules();
+  const auto titles = makeTitles();
+
+  BENCHMARK("rewriteString") {
+    std::size_t total = 0;
+    for (const auto& title : titles) {
+      total += waybar::util::rewriteString(title, rules).size();
+    }
+    return total;
+  };
+
+  waybar::util::RewriteRuleSet ruleSet{rules};
+  BENCHMARK("RewriteRuleSet::apply") {
+    std::size_t total = 0;
+    for (const auto& title : titles) {
+      total += ruleSet.apply(title).size();
+    }
+    return total;
+  };
+
+  // Every run starts from a copy of a set that hasn't rewritten anything yet, so each title
+  // goes through the regexes once and the rest are cache hits, like a fresh bar
+  BENCHMARK_ADVANCED("RewriteRuleSet::apply, cold cache")(Catch::Benchmark::Chronometer meter) {
+    const waybar::util::RewriteRuleSet coldSet{rules};
+    std::vector<waybar::util::RewriteRuleSet> sets(meter.runs(), coldSet);
+    meter.measure([&](int run) {
+      std::size_t total = 0;
+      for (const auto& title : titles) {
+        total += sets[run].apply(title).size();
+      }
+      return total;
+    });
+  };
+}
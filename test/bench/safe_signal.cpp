@@ -0,0 +1,44 @@
+#include "util/SafeSignal.hpp"
+
+#include <glibmm.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <string>
+#include <thread>
+
+#include "../utils/fixtures/GlibTestsFixture.hpp"
+
+/**
+ * Events from a backend thread delivered to the main loop, e.g. IPC messages or sensor readings.
+ * Each sample includes starting the producer thread.
+ */
+TEST_CASE_METHOD(GlibTestsFixture, "Deliver events across threads", "[bench][signal]") {
+  const int NUM_EVENTS = 1000;
+  int count = 0;
+
+  waybar::SafeSignal<int, std::string> signal;
+  signal.connect([&](int, const std::string&) {
+    if (++count == NUM_EVENTS) {
+      quit();
+    }
+  });
+
+  BENCHMARK("SafeSignal, 1000 events") {
+    count = 0;
+    std::thread producer;
+    run([&]() {
+      producer = std::thread([&]() {
+        for (auto i = 0; i < NUM_EVENTS; ++i) {
+          signal.emit(i, "workspace");
+        }
+      });
+    });
+    producer.join();
+    return count;
+  };
+}
@@ -0,0 +1,29 @@
+#include "util/sanitize_str.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <string>
+
+TEST_CASE("Escape window titles", "[bench][sanitize]") {
+  // Long browser title without any markup characters
+  std::string plain;
+  // Same title with a few characters to escape, e.g. from a search query
+  std::string markup;
+  for (int i = 0; i < 8; ++i) {
+    plain += "Waybar issue tracker: rendering glitches with long titles on multiple outputs - ";
+    markup += "Search results for \"<b>waybar</b> & sway\" - Mozilla Firefox's history - ";
+  }
+
+  REQUIRE(waybar::util::sanitize_string("a<b>&\"'") == "a&lt;b&gt;&amp;&quot;&apos;");
+  REQUIRE(waybar::util::sanitize_string(plain) == plain);
+
+  BENCHMARK("sanitize_string, nothing to escape") {
+    return waybar::util::sanitize_string(plain);
+  };
+  BENCHMARK("sanitize_string, markup") { return waybar::util::sanitize_string(markup); };
+}
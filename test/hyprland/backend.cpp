@@ -4,6 +4,9 @@
 #include <catch2/catch.hpp>
 #endif
 
+#include <string>
+#include <vector>
+
 #include "fixtures/IPCTestFixture.hpp"
 
 namespace fs = std::filesystem;
@@ -57,3 +60,96 @@ TEST_CASE_METHOD(IPCTestFixture, "getSocket1Reply throws on no socket", "[getSoc
 
   CHECK_THROWS(getSocket1Reply(request));
 }
+
+TEST_CASE("IPCEvent splits the payload into arguments", "[IPCEvent]") {
+  std::string line = "openwindow>>80e62df0,2,kitty,vim a,b";
+
+  auto event = hyprland::IPCEvent::parse(line);
+
+  REQUIRE(event.name == "openwindow");
+  REQUIRE(event.payload == "80e62df0,2,kitty,vim a,b");
+  REQUIRE(event.args.size() == 5);
+  REQUIRE(event.args[2] == "kitty");
+  REQUIRE(event.argsFrom(3) == "vim a,b");
+  REQUIRE(event.argsFrom(5).empty());
+}
+
+TEST_CASE_METHOD(IPCTestFixture, "parseIPC dispatches events by name", "[parseIPC]") {
+  struct Recorder : hyprland::EventHandler {
+    std::vector<std::string> received;
+    bool unregisterOnEvent = false;
+    hyprland::IPC* ipc = nullptr;
+
+    void onEvent(const hyprland::IPCEvent& ev) override {
+      received.emplace_back(ev.payload);
+      if (unregisterOnEvent) {
+        ipc->unregisterForIPC(this);
+      }
+    }
+  };
+
+  Recorder submap;
+  Recorder both;
+  Recorder once;
+  once.unregisterOnEvent = true;
+  once.ipc = this;
+  registerForIPC("submap", &submap);
+  registerForIPC("submap", &both);
+  registerForIPC("activelayout", &both);
+  registerForIPC("activelayout", &once);
+
+  parseIPC("submap>>resize");
+  parseIPC("activelayout>>keyboard,English (US)");
+  parseIPC("activelayout>>keyboard,German");
+  parseIPC("unknown>>ignored");
+
+  REQUIRE(submap.received == std::vector<std::string>{"resize"});
+  REQUIRE(both.received == std::vector<std::string>{"resize", "keyboard,English (US)",
+                                                    "keyboard,German"});
+  REQUIRE(once.received == std::vector<std::string>{"keyboard,English (US)"});
+
+  unregisterForIPC(&submap);
+  parseIPC("submap>>");
+
+  REQUIRE(submap.received.size() == 1);
+  REQUIRE(both.received.size() == 4);
+
+  unregisterForIPC(&both);
+}
+
+TEST_CASE_METHOD(IPCTestFixture, "parseIPC publishes window state snapshots", "[parseIPC]") {
+  auto initial = state();
+  parseIPC("createworkspacev2>>1,1");
+  parseIPC("openwindow>>a1,1,foot,~");
+  parseIPC("openwindow>>a2,1,firefox,Waybar");
+
+  auto opened = state();
+  REQUIRE(opened->generation() == initial->generation() + 2);
+  REQUIRE(opened->windows().windowCount("1") == 2);
+
+  SECTION("Events that don't change the windows keep the version") {
+    parseIPC("activewindowv2>>a1");
+    parseIPC("windowtitlev2>>ff,unknown window");
+    REQUIRE(state() == opened);
+  }
+
+  SECTION("Snapshots are immutable") {
+    parseIPC("windowtitlev2>>a1,vim");
+    parseIPC("movewindowv2>>a2,2,2");
+    parseIPC("closewindow>>a1");
+
+    auto current = state();
+    REQUIRE(current->generation() == opened->generation() + 3);
+    REQUIRE(current->windows().find("a1") == nullptr);
+    REQUIRE(current->windows().find("a2")->workspaceName == "2");
+    REQUIRE(opened->windows().find("a1")->windowTitle == "~");
+    REQUIRE(opened->windows().find("a2")->workspaceName == "1");
+    REQUIRE(opened->windows().windowCount("1") == 2);
+  }
+
+  SECTION("Renamed workspaces keep their windows") {
+    parseIPC("renameworkspace>>1,web");
+    REQUIRE(state()->windows().windowCount("web") == 2);
+    REQUIRE(state()->windows().windowCount("1") == 0);
+  }
+}
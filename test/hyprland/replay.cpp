@@ -0,0 +1,112 @@
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "../replay/replay_server.hpp"
+#include "modules/hyprland/backend.hpp"
+
+namespace fs = std::filesystem;
+namespace hyprland = waybar::modules::hyprland;
+using namespace waybar::replay;
+
+namespace {
+
+// Never instantiated, only clears the cached socket folder of previous tests
+struct SocketFolder : hyprland::IPC {
+  static void reset() { socketFolder_.clear(); }
+};
+
+// Sets an environment variable and restores the previous value when leaving the scope
+class ScopedEnv {
+ public:
+  ScopedEnv(const char* name, const char* value) : name_(name) {
+    if (const char* previous = getenv(name)) previous_ = previous;
+    setenv(name, value, 1);
+  }
+  ~ScopedEnv() {
+    if (previous_)
+      setenv(name_, previous_->c_str(), 1);
+    else
+      unsetenv(name_);
+  }
+  ScopedEnv(const ScopedEnv&) = delete;
+  ScopedEnv& operator=(const ScopedEnv&) = delete;
+
+ private:
+  const char* name_;
+  std::optional<std::string> previous_;
+};
+
+struct Counter : hyprland::EventHandler {
+  std::atomic<size_t> received = 0;
+  void onEvent(const hyprland::IPCEvent& ev) override { ++received; }
+};
+
+}  // namespace
+
+TEST_CASE("Drive the IPC with a recorded event stream", "[replay]") {
+  const fs::path runtimeDir = fs::temp_directory_path() / "hypr_replay_test";
+  fs::create_directories(runtimeDir / "hypr");
+  const ScopedEnv runtimeEnv("XDG_RUNTIME_DIR", runtimeDir.c_str());
+  const ScopedEnv instanceEnv("HYPRLAND_INSTANCE_SIGNATURE", "replay");
+  SocketFolder::reset();
+
+  auto recording = Recording::load(Protocol::HYPRLAND, "test/replay/recordings/hyprland.events",
+                                   "test/replay/recordings/hyprland.responses");
+  const auto events = recording.events.size();
+  std::set<std::string> names;
+  for (const auto& event : recording.events) {
+    names.insert(event.payload.substr(0, event.payload.find(">>")));
+  }
+
+  {
+    ReplayServer server(Protocol::HYPRLAND, std::move(recording), runtimeDir / "hypr" / "replay",
+                        {.paused = true});
+
+    SECTION("Canned socket1 replies") {
+      REQUIRE(hyprland::IPC::getSocket1Reply("j/clients").starts_with("["));
+      REQUIRE(hyprland::IPC::getSocket1Reply("dispatch workspace 2") == "ok");
+      REQUIRE(hyprland::IPC::getSocket1Reply("j/binds") == "unknown request");
+      REQUIRE(server.unknownRequests() == std::vector<std::string>{"j_binds"});
+    }
+
+    SECTION("Every event reaches the handlers") {
+      Counter counter;
+      hyprland::modulesReady = true;
+      // Declared after the server, so its event thread is stopped and joined first
+      hyprland::IPC ipc;
+      for (const auto& name : names) {
+        ipc.registerForIPC(name, &counter);
+      }
+      server.start();
+
+      REQUIRE(server.waitForStreams(1, std::chrono::seconds(5)));
+      REQUIRE(server.streams()[0].events == events);
+      for (int i = 0; i < 500 && counter.received < events; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      REQUIRE(counter.received == events);
+      // The clients loaded at startup with every window event applied on top
+      auto state = ipc.state();
+      REQUIRE(state->windows().size() == 6);
+      REQUIRE(state->windows().find("55d4a1b2c340")->windowTitle == "~/src/waybar: make -j12");
+      REQUIRE(state->windows().find("55d4a1b2cea0") == nullptr);
+      ipc.unregisterForIPC(&counter);
+      hyprland::modulesReady = false;
+    }
+  }
+
+  SocketFolder::reset();
+  fs::remove_all(runtimeDir);
+}
@@ -0,0 +1,93 @@
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <json/value.h>
+
+#include "modules/hyprland/windowindex.hpp"
+
+using waybar::modules::hyprland::WindowIndex;
+
+TEST_CASE("Window index bookkeeping", "[hyprland][window_index]") {
+  WindowIndex index;
+  index.insert("a1", "1", "foot", "~");
+  index.insert("a2", "1", "firefox", "Waybar");
+  index.insert("a3", "special:scratch", "kitty", "htop");
+
+  REQUIRE(index.windowCount("1") == 2);
+  REQUIRE(index.windowCount("scratch") == 1);
+  REQUIRE(index.windowCount("special:scratch") == 1);
+  REQUIRE(index.find("a3")->workspaceName == "scratch");
+
+  SECTION("Move") {
+    index.insert("a2", "2", "firefox", "Waybar");
+    REQUIRE(index.windowCount("1") == 1);
+    REQUIRE(index.windowCount("2") == 1);
+    REQUIRE(index.find("a2")->workspaceName == "2");
+    REQUIRE(index.size() == 3);
+  }
+
+  SECTION("Close") {
+    REQUIRE(index.erase("a1") == "1");
+    REQUIRE(index.erase("a2") == "1");
+    REQUIRE(index.windowCount("1") == 0);
+    REQUIRE(index.find("a1") == nullptr);
+    REQUIRE_FALSE(index.erase("a1").has_value());
+  }
+
+  SECTION("Rename") {
+    index.renameWorkspace("1", "web");
+    REQUIRE(index.windowCount("1") == 0);
+    REQUIRE(index.windowCount("web") == 2);
+    REQUIRE(index.find("a1")->workspaceName == "web");
+    REQUIRE(index.find("a2")->workspaceName == "web");
+    REQUIRE(index.find("a3")->workspaceName == "scratch");
+
+    // Later events use the new name
+    REQUIRE(index.erase("a1") == "web");
+    index.insert("a2", "scratch", "firefox", "Waybar");
+    REQUIRE(index.windowCount("web") == 0);
+    REQUIRE(index.windowCount("scratch") == 2);
+  }
+
+  SECTION("Rebuild from clients") {
+    Json::Value clients(Json::arrayValue);
+    Json::Value client;
+    client["address"] = "0xb1";
+    client["workspace"]["name"] = "3";
+    client["class"] = "foot";
+    client["title"] = "vim";
+    clients.append(client);
+    index.rebuild(clients);
+
+    REQUIRE(index.size() == 1);
+    REQUIRE(index.windowCount("1") == 0);
+    REQUIRE(index.windowCount("3") == 1);
+    REQUIRE(index.find("b1")->windowTitle == "vim");
+  }
+}
+
+TEST_CASE("Window index copies are independent", "[hyprland][window_index]") {
+  WindowIndex index;
+  index.insert("a1", "1", "foot", "~");
+  index.insert("0xa2", "1", "firefox", "Waybar");
+  // Not a window address
+  index.insert("foot", "1", "foot", "~");
+  REQUIRE(index.size() == 2);
+  REQUIRE(index.find("0xa1") == index.find("a1"));
+
+  auto copy = index;
+  REQUIRE(copy.setTitle("a1", "vim"));
+  REQUIRE_FALSE(copy.setTitle("a3", "htop"));
+  copy.renameWorkspace("1", "web");
+  copy.erase("a2");
+
+  REQUIRE(copy.find("a1")->windowTitle == "vim");
+  REQUIRE(copy.windowCount("web") == 1);
+  REQUIRE(index.find("a1")->windowTitle == "~");
+  REQUIRE(index.find("a1")->workspaceName == "1");
+  REQUIRE(index.windowCount("1") == 2);
+  REQUIRE(index.find("a2") != nullptr);
+}
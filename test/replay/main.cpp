@@ -0,0 +1,150 @@
+#include <getopt.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include "replay_server.hpp"
+
+/**
+ * Serves a recorded compositor event stream, so the Hyprland, Sway and Niri modules can be run
+ * and measured without the compositor:
+ *
+ *   waybar-ipc-replay --speed 10 --loop 100 hyprland test/replay/recordings/hyprland.events
+ *
+ * Start waybar with the printed environment (and --metrics to record per-event dispatch times).
+ */
+
+namespace fs = std::filesystem;
+using namespace waybar::replay;
+
+namespace {
+
+void usage(const char* name) {
+  fprintf(stderr,
+          "Usage: %s [options] hyprland|sway|niri EVENTS\n"
+          "  -r, --responses DIR  canned replies, default: EVENTS without extension + .responses\n"
+          "  -s, --speed FACTOR   replay speed relative to the recording, 0 for no delays "
+          "(default 1)\n"
+          "  -l, --loop COUNT     number of times the events are sent (default 1)\n",
+          name);
+}
+
+fs::path runtimeDir() {
+  const char* dir = getenv("XDG_RUNTIME_DIR");
+  return dir != nullptr ? fs::path(dir) : fs::temp_directory_path();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  constexpr option OPTIONS[] = {{"responses", required_argument, nullptr, 'r'},
+                                {"speed", required_argument, nullptr, 's'},
+                                {"loop", required_argument, nullptr, 'l'},
+                                {"help", no_argument, nullptr, 'h'},
+                                {nullptr, 0, nullptr, 0}};
+  fs::path responses;
+  ReplayOptions options{.speed = 1};
+  for (int opt; (opt = getopt_long(argc, argv, "r:s:l:h", OPTIONS, nullptr)) != -1;) {
+    switch (opt) {
+      case 'r':
+        responses = optarg;
+        break;
+      case 's':
+        options.speed = std::strtod(optarg, nullptr);
+        break;
+      case 'l':
+        options.loops = std::strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        usage(argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (argc - optind != 2) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  const std::string name = argv[optind];
+  const fs::path events = argv[optind + 1];
+  if (responses.empty()) {
+    responses = fs::path(events).replace_extension(".responses");
+  }
+
+  Protocol protocol;
+  fs::path path;
+  std::string environment;
+  const auto id = "waybar-replay-" + std::to_string(getpid());
+  if (name == "hyprland") {
+    protocol = Protocol::HYPRLAND;
+    // Same lookup as the module: $XDG_RUNTIME_DIR/hypr if it exists, /tmp/hypr otherwise
+    const char* xdg = getenv("XDG_RUNTIME_DIR");
+    fs::path base = xdg != nullptr && fs::exists(fs::path(xdg) / "hypr") ? fs::path(xdg) / "hypr"
+                                                                          : fs::path("/tmp/hypr");
+    path = base / id;
+    environment = "HYPRLAND_INSTANCE_SIGNATURE=" + id;
+  } else if (name == "sway") {
+    protocol = Protocol::SWAY;
+    path = runtimeDir() / (id + ".sock");
+    environment = "SWAYSOCK=" + path.string();
+  } else if (name == "niri") {
+    protocol = Protocol::NIRI;
+    path = runtimeDir() / (id + ".sock");
+    environment = "NIRI_SOCKET=" + path.string();
+  } else {
+    usage(argv[0]);
+    return 1;
+  }
+
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+  try {
+    auto recording =
+        Recording::load(protocol, events, fs::is_directory(responses) ? responses : fs::path());
+    const auto count = recording.events.size();
+    ReplayServer server(protocol, std::move(recording), path, options);
+    printf("export %s\n", environment.c_str());
+    fflush(stdout);
+    fprintf(stderr, "Replaying %zu events %u time(s), press Ctrl-C to stop\n", count,
+            options.loops);
+
+    // Report every finished stream until interrupted
+    std::atomic<bool> done{false};
+    std::thread reporter([&server, &done] {
+      for (size_t reported = 0; !done;) {
+        if (!server.waitForStreams(reported + 1, std::chrono::milliseconds(200))) continue;
+        const auto stats = server.streams()[reported++];
+        const auto seconds = stats.elapsed.count() / 1e6;
+        fprintf(stderr, "Stream %zu: %zu events in %.3f s, %.0f events/s\n", reported,
+                stats.events, seconds, seconds > 0 ? stats.events / seconds : 0.0);
+      }
+    });
+
+    int sig;
+    sigwait(&mask, &sig);
+    done = true;
+    reporter.join();
+    for (const auto& request : server.unknownRequests()) {
+      fprintf(stderr, "No canned reply for %s\n", request.c_str());
+    }
+  } catch (const std::exception& e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  if (protocol == Protocol::HYPRLAND) {
+    std::error_code ec;
+    fs::remove_all(path, ec);
+  }
+  return 0;
+}
@@ -0,0 +1,467 @@
+#include "replay_server.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "modules/sway/ipc/ipc.hpp"
+
+namespace waybar::replay {
+
+namespace {
+
+constexpr std::string_view SWAY_MAGIC = "i3-ipc";
+
+constexpr std::array<std::pair<std::string_view, uint32_t>, 10> SWAY_EVENTS{{
+    {"workspace", IPC_EVENT_WORKSPACE},
+    {"output", IPC_EVENT_OUTPUT},
+    {"mode", IPC_EVENT_MODE},
+    {"window", IPC_EVENT_WINDOW},
+    {"barconfig_update", IPC_EVENT_BARCONFIG_UPDATE},
+    {"binding", IPC_EVENT_BINDING},
+    {"shutdown", IPC_EVENT_SHUTDOWN},
+    {"tick", IPC_EVENT_TICK},
+    {"bar_state_update", IPC_EVENT_BAR_STATE_UPDATE},
+    {"input", IPC_EVENT_INPUT},
+}};
+
+constexpr std::array<std::pair<uint32_t, std::string_view>, 13> SWAY_MESSAGES{{
+    {IPC_COMMAND, "COMMAND"},
+    {IPC_GET_WORKSPACES, "GET_WORKSPACES"},
+    {IPC_SUBSCRIBE, "SUBSCRIBE"},
+    {IPC_GET_OUTPUTS, "GET_OUTPUTS"},
+    {IPC_GET_TREE, "GET_TREE"},
+    {IPC_GET_MARKS, "GET_MARKS"},
+    {IPC_GET_BAR_CONFIG, "GET_BAR_CONFIG"},
+    {IPC_GET_VERSION, "GET_VERSION"},
+    {IPC_GET_BINDING_MODES, "GET_BINDING_MODES"},
+    {IPC_GET_CONFIG, "GET_CONFIG"},
+    {IPC_SEND_TICK, "SEND_TICK"},
+    {IPC_GET_INPUTS, "GET_INPUTS"},
+    {IPC_GET_SEATS, "GET_SEATS"},
+}};
+
+std::string_view nextToken(std::string_view& line) {
+  const auto begin = line.find_first_not_of(" \t");
+  if (begin == std::string_view::npos) {
+    line = {};
+    return {};
+  }
+  line.remove_prefix(begin);
+  const auto end = std::min(line.find_first_of(" \t"), line.size());
+  auto token = line.substr(0, end);
+  line.remove_prefix(end);
+  return token;
+}
+
+Event parseEvent(Protocol protocol, std::string_view line) {
+  Event event{};
+  auto offset = nextToken(line);
+  double ms = 0;
+  auto [end, ec] = std::from_chars(offset.data(), offset.data() + offset.size(), ms);
+  if (ec != std::errc() || end != offset.data() + offset.size() || ms < 0) {
+    throw std::runtime_error("invalid event offset: " + std::string(offset));
+  }
+  event.time = std::chrono::microseconds(static_cast<int64_t>(ms * 1000));
+
+  if (protocol == Protocol::SWAY) {
+    auto name = nextToken(line);
+    auto it = std::find_if(SWAY_EVENTS.begin(), SWAY_EVENTS.end(),
+                           [name](const auto& entry) { return entry.first == name; });
+    if (it == SWAY_EVENTS.end()) {
+      throw std::runtime_error("unknown sway event: " + std::string(name));
+    }
+    event.type = it->second;
+  }
+
+  const auto begin = line.find_first_not_of(" \t");
+  if (begin == std::string_view::npos) {
+    throw std::runtime_error("event without payload");
+  }
+  event.payload = line.substr(begin);
+  return event;
+}
+
+bool writeAll(int fd, std::string_view data) {
+  while (!data.empty()) {
+    const auto res = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (res < 0 && errno == EINTR) continue;
+    if (res <= 0) return false;
+    data.remove_prefix(res);
+  }
+  return true;
+}
+
+bool readAll(int fd, char* data, size_t size) {
+  while (size > 0) {
+    const auto res = ::read(fd, data, size);
+    if (res < 0 && errno == EINTR) continue;
+    if (res <= 0) return false;
+    data += res;
+    size -= res;
+  }
+  return true;
+}
+
+std::string swayMessage(uint32_t type, std::string_view payload) {
+  std::string message(SWAY_MAGIC);
+  const std::array<uint32_t, 2> header{static_cast<uint32_t>(payload.size()), type};
+  message.append(reinterpret_cast<const char*>(header.data()), sizeof(header));
+  message.append(payload);
+  return message;
+}
+
+// The first member name of an object request or the string of a plain one, e.g. "Workspaces"
+std::string niriRequestName(std::string_view request) {
+  const auto begin = request.find('"');
+  const auto end = request.find('"', begin + 1);
+  if (begin == std::string_view::npos || end == std::string_view::npos) {
+    return std::string(request);
+  }
+  return std::string(request.substr(begin + 1, end - begin - 1));
+}
+
+}  // namespace
+
+Recording Recording::load(Protocol protocol, const std::filesystem::path& events,
+                          const std::filesystem::path& responses) {
+  Recording recording;
+
+  std::ifstream file(events);
+  if (!file.is_open()) {
+    throw std::runtime_error("can't open " + events.string());
+  }
+  std::string line;
+  for (size_t number = 1; std::getline(file, line); ++number) {
+    const auto begin = line.find_first_not_of(" \t");
+    if (begin == std::string::npos || line[begin] == '#') continue;
+    try {
+      recording.events.push_back(parseEvent(protocol, line));
+    } catch (const std::exception& e) {
+      throw std::runtime_error(events.string() + ":" + std::to_string(number) + ": " + e.what());
+    }
+  }
+
+  if (responses.empty()) return recording;
+  for (const auto& entry : std::filesystem::directory_iterator(responses)) {
+    if (entry.path().extension() != ".json") continue;
+    std::ifstream response(entry.path());
+    std::stringstream ss;
+    ss << response.rdbuf();
+    auto content = ss.str();
+    // Niri replies are a single line
+    if (protocol == Protocol::NIRI) {
+      std::replace(content.begin(), content.end(), '\n', ' ');
+    }
+    recording.responses.emplace(entry.path().stem().string(), std::move(content));
+  }
+  return recording;
+}
+
+ReplayServer::ReplayServer(Protocol protocol, Recording recording, std::filesystem::path path,
+                           ReplayOptions options)
+    : protocol_(protocol),
+      recording_(std::move(recording)),
+      path_(std::move(path)),
+      options_(options),
+      started_(!options.paused) {
+  if (pipe2(stopPipe_, O_CLOEXEC) == -1) {
+    throw std::runtime_error("replay: pipe failed");
+  }
+  if (protocol_ == Protocol::HYPRLAND) {
+    std::filesystem::create_directories(path_);
+    requestFd_ = listen(path_ / ".socket.sock");
+    eventFd_ = listen(path_ / ".socket2.sock");
+  } else {
+    eventFd_ = listen(path_);
+  }
+  acceptThread_ = std::thread([this] { acceptLoop(); });
+}
+
+ReplayServer::~ReplayServer() {
+  stopping_ = true;
+  (void)!write(stopPipe_[1], "x", 1);
+  acceptThread_.join();
+
+  {
+    std::unique_lock lock(mutex_);
+    changed_.notify_all();
+    for (auto fd : clientFds_) {
+      shutdown(fd, SHUT_RDWR);
+    }
+    changed_.wait(lock, [this] { return clients_ == 0; });
+  }
+
+  for (auto fd : {requestFd_, eventFd_, stopPipe_[0], stopPipe_[1]}) {
+    if (fd != -1) close(fd);
+  }
+  std::error_code ec;
+  if (protocol_ == Protocol::HYPRLAND) {
+    std::filesystem::remove(path_ / ".socket.sock", ec);
+    std::filesystem::remove(path_ / ".socket2.sock", ec);
+  } else {
+    std::filesystem::remove(path_, ec);
+  }
+}
+
+int ReplayServer::listen(const std::filesystem::path& socket) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (socket.native().size() >= sizeof(addr.sun_path)) {
+    throw std::runtime_error("replay: socket path too long: " + socket.string());
+  }
+  strncpy(addr.sun_path, socket.c_str(), sizeof(addr.sun_path) - 1);
+
+  std::error_code ec;
+  std::filesystem::remove(socket, ec);
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd == -1 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 ||
+      ::listen(fd, 16) == -1) {
+    const auto error = std::string(strerror(errno));
+    if (fd != -1) close(fd);
+    throw std::runtime_error("replay: can't listen on " + socket.string() + ": " + error);
+  }
+  return fd;
+}
+
+void ReplayServer::acceptLoop() {
+  std::array<pollfd, 3> fds{
+      {{stopPipe_[0], POLLIN, 0}, {eventFd_, POLLIN, 0}, {requestFd_, POLLIN, 0}}};
+  const nfds_t count = requestFd_ == -1 ? 2 : 3;
+
+  while (!stopping_) {
+    if (poll(fds.data(), count, -1) == -1) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    if (fds[0].revents != 0) return;
+
+    for (nfds_t i = 1; i < count; ++i) {
+      if ((fds[i].revents & POLLIN) == 0) continue;
+      const int fd = accept4(fds[i].fd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd == -1) continue;
+
+      std::lock_guard lock(mutex_);
+      ++clients_;
+      clientFds_.insert(fd);
+      std::thread([this, fd, eventSocket = i == 1] {
+        serveClient(fd, eventSocket);
+        std::lock_guard lock(mutex_);
+        clientFds_.erase(fd);
+        close(fd);
+        --clients_;
+        changed_.notify_all();
+      }).detach();
+    }
+  }
+}
+
+void ReplayServer::serveClient(int fd, bool eventSocket) {
+  switch (protocol_) {
+    case Protocol::HYPRLAND:
+      // Connecting to socket2 is the subscription
+      if (eventSocket) {
+        stream(fd);
+        holdOpen(fd);
+      } else {
+        serveHyprlandRequest(fd);
+      }
+      break;
+    case Protocol::SWAY:
+      serveSway(fd);
+      break;
+    case Protocol::NIRI:
+      serveNiri(fd);
+      break;
+  }
+}
+
+void ReplayServer::serveHyprlandRequest(int fd) {
+  // The client writes the whole request, then reads the reply until the socket is closed
+  std::array<char, 8192> buffer;
+  ssize_t res;
+  do {
+    res = read(fd, buffer.data(), buffer.size());
+  } while (res < 0 && errno == EINTR);
+  if (res <= 0) return;
+
+  std::string request(buffer.data(), res);
+  if (request.starts_with("j/")) {
+    std::replace(request.begin(), request.end(), '/', '_');
+    writeAll(fd, reply(request, "unknown request"));
+  } else {
+    // Dispatchers and keywords
+    writeAll(fd, "ok");
+  }
+}
+
+void ReplayServer::serveSway(int fd) {
+  std::array<char, SWAY_MAGIC.size() + 8> header;
+  while (readAll(fd, header.data(), header.size())) {
+    if (std::string_view(header.data(), SWAY_MAGIC.size()) != SWAY_MAGIC) {
+      // Waybar sends garbage on purpose when it closes the connection
+      return;
+    }
+    std::array<uint32_t, 2> sizeAndType;
+    memcpy(sizeAndType.data(), header.data() + SWAY_MAGIC.size(), sizeof(sizeAndType));
+    std::string payload(sizeAndType[0], '\0');
+    if (!readAll(fd, payload.data(), payload.size())) return;
+
+    const auto type = sizeAndType[1];
+    if (type == IPC_SUBSCRIBE) {
+      if (!writeAll(fd, swayMessage(type, "{\"success\": true}"))) return;
+      stream(fd);
+      continue;
+    }
+    if (type == IPC_COMMAND) {
+      if (!writeAll(fd, swayMessage(type, "[{\"success\": true}]"))) return;
+      continue;
+    }
+
+    auto it = std::find_if(SWAY_MESSAGES.begin(), SWAY_MESSAGES.end(),
+                           [type](const auto& entry) { return entry.first == type; });
+    const auto key = it != SWAY_MESSAGES.end() ? std::string(it->second) : std::to_string(type);
+    if (!writeAll(fd, swayMessage(type, reply(key, "[]")))) return;
+  }
+}
+
+void ReplayServer::serveNiri(int fd) {
+  std::string buffer;
+  std::array<char, 4096> chunk;
+  while (true) {
+    const auto newline = buffer.find('\n');
+    if (newline == std::string::npos) {
+      const auto res = read(fd, chunk.data(), chunk.size());
+      if (res < 0 && errno == EINTR) continue;
+      if (res <= 0) return;
+      buffer.append(chunk.data(), res);
+      continue;
+    }
+    const auto request = buffer.substr(0, newline);
+    buffer.erase(0, newline + 1);
+
+    const auto name = niriRequestName(request);
+    if (name == "EventStream") {
+      if (!writeAll(fd, "{\"Ok\":\"Handled\"}\n")) return;
+      stream(fd);
+      holdOpen(fd);
+      return;
+    }
+    const auto response =
+        name == "Action" ? R"({"Ok":"Handled"})" : reply(name, R"({"Err":"unknown request"})");
+    if (!writeAll(fd, response + '\n')) return;
+  }
+}
+
+void ReplayServer::start() {
+  std::lock_guard lock(mutex_);
+  started_ = true;
+  changed_.notify_all();
+}
+
+void ReplayServer::stream(int fd) {
+  {
+    std::unique_lock lock(mutex_);
+    changed_.wait(lock, [this] { return started_ || stopping_; });
+  }
+
+  StreamStats stats;
+  const auto start = std::chrono::steady_clock::now();
+  const auto length = recording_.events.empty() ? std::chrono::microseconds(0)
+                                                : recording_.events.back().time;
+
+  for (unsigned loop = 0; loop < options_.loops; ++loop) {
+    for (const auto& event : recording_.events) {
+      if (options_.speed > 0) {
+        const auto offset = std::chrono::duration_cast<std::chrono::microseconds>(
+            (length * loop + event.time) / options_.speed);
+        if (!sleepUntil(start + offset)) return;
+      } else if (stopping_) {
+        return;
+      }
+
+      bool sent;
+      switch (protocol_) {
+        case Protocol::SWAY:
+          sent = writeAll(fd, swayMessage(event.type, event.payload));
+          break;
+        default:
+          sent = writeAll(fd, event.payload + '\n');
+          break;
+      }
+      if (!sent) return;
+      ++stats.events;
+    }
+  }
+
+  stats.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  std::lock_guard lock(mutex_);
+  streams_.push_back(stats);
+  changed_.notify_all();
+}
+
+void ReplayServer::holdOpen(int fd) {
+  // Closing the stream would make the client reconnect or spin on EOF
+  std::array<pollfd, 2> fds{{{stopPipe_[0], POLLIN, 0}, {fd, POLLIN, 0}}};
+  std::array<char, 256> discard;
+  while (!stopping_) {
+    if (poll(fds.data(), fds.size(), -1) == -1 && errno != EINTR) return;
+    if (fds[0].revents != 0) return;
+    if (fds[1].revents != 0 && read(fd, discard.data(), discard.size()) <= 0) return;
+  }
+}
+
+bool ReplayServer::sleepUntil(std::chrono::steady_clock::time_point deadline) {
+  while (!stopping_) {
+    const auto left = deadline - std::chrono::steady_clock::now();
+    if (left <= std::chrono::steady_clock::duration::zero()) return true;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+    const timespec timeout{static_cast<time_t>(ns / 1000000000),
+                           static_cast<long>(ns % 1000000000)};
+    pollfd fd{stopPipe_[0], POLLIN, 0};
+    if (ppoll(&fd, 1, &timeout, nullptr) > 0) return false;
+  }
+  return false;
+}
+
+std::string ReplayServer::reply(const std::string& key, const std::string& fallback) {
+  auto it = recording_.responses.find(key);
+  if (it != recording_.responses.end()) return it->second;
+
+  std::lock_guard lock(mutex_);
+  if (std::find(unknownRequests_.begin(), unknownRequests_.end(), key) == unknownRequests_.end()) {
+    unknownRequests_.push_back(key);
+  }
+  return fallback;
+}
+
+bool ReplayServer::waitForStreams(size_t subscribers, std::chrono::milliseconds timeout) {
+  std::unique_lock lock(mutex_);
+  return changed_.wait_for(lock, timeout, [&] { return streams_.size() >= subscribers; });
+}
+
+std::vector<StreamStats> ReplayServer::streams() const {
+  std::lock_guard lock(mutex_);
+  return streams_;
+}
+
+std::vector<std::string> ReplayServer::unknownRequests() const {
+  std::lock_guard lock(mutex_);
+  return unknownRequests_;
+}
+
+}  // namespace waybar::replay
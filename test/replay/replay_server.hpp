@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace waybar::replay {
+
+enum class Protocol { HYPRLAND, SWAY, NIRI };
+
+struct Event {
+  // Offset from the start of the recording
+  std::chrono::microseconds time;
+  // Sway event type (with the high bit set), unused by the other protocols
+  uint32_t type;
+  std::string payload;
+};
+
+/**
+ * A recorded event stream plus canned replies to requests.
+ *
+ * The events file has one event per line, "<milliseconds> <payload>", where the offset is relative
+ * to the start of the recording. For sway the payload starts with the event name, e.g.
+ * "12.5 workspace {...}". Empty lines and lines starting with '#' are skipped.
+ *
+ * Replies are read from `<responses>/<key>.json`, where the key is the socket1 request with '/'
+ * replaced by '_' for Hyprland ("j_clients"), the message type for sway ("GET_TREE") and the
+ * request name for niri ("Workspaces").
+ */
+struct Recording {
+  std::vector<Event> events;
+  std::unordered_map<std::string, std::string> responses;
+
+  /// Throws std::runtime_error if a file can't be read or a line is malformed
+  static Recording load(Protocol protocol, const std::filesystem::path& events,
+                        const std::filesystem::path& responses = {});
+};
+
+struct StreamStats {
+  size_t events = 0;
+  std::chrono::microseconds elapsed{0};
+};
+
+struct ReplayOptions {
+  // Multiplier of the recorded pace, 0 sends as fast as the client reads
+  double speed = 0;
+  // Number of times the recording is sent to each subscriber
+  unsigned loops = 1;
+  // Subscribers wait for start(), e.g. until the test registered its handlers
+  bool paused = false;
+};
+
+/**
+ * Serves a Recording the way the compositor would, so the IPC backends can be driven without one.
+ *
+ * `path` is the instance folder holding .socket.sock and .socket2.sock for Hyprland and the socket
+ * itself for sway and niri. Every client subscribing to events gets the whole stream. Requests are
+ * answered from the canned replies at any time.
+ */
+class ReplayServer {
+ public:
+  ReplayServer(Protocol protocol, Recording recording, std::filesystem::path path,
+               ReplayOptions options = {});
+  ~ReplayServer();
+  ReplayServer(const ReplayServer&) = delete;
+  ReplayServer& operator=(const ReplayServer&) = delete;
+
+  /// Releases the event streams of a paused server
+  void start();
+
+  /// Blocks until `subscribers` clients received the whole stream, or `timeout` expired
+  bool waitForStreams(size_t subscribers, std::chrono::milliseconds timeout);
+
+  /// One entry per finished event stream, in completion order
+  std::vector<StreamStats> streams() const;
+  /// Requests that had no canned reply
+  std::vector<std::string> unknownRequests() const;
+
+ private:
+  static int listen(const std::filesystem::path& socket);
+  void acceptLoop();
+  void serveClient(int fd, bool eventSocket);
+  void serveHyprlandRequest(int fd);
+  void serveSway(int fd);
+  void serveNiri(int fd);
+  void stream(int fd);
+  void holdOpen(int fd);
+  // Returns false once the server is stopping
+  bool sleepUntil(std::chrono::steady_clock::time_point deadline);
+  std::string reply(const std::string& key, const std::string& fallback);
+
+  const Protocol protocol_;
+  const Recording recording_;
+  const std::filesystem::path path_;
+  const ReplayOptions options_;
+
+  // Hyprland listens on the request and the event socket, the others on a single socket
+  int requestFd_ = -1;
+  int eventFd_ = -1;
+  int stopPipe_[2] = {-1, -1};
+  std::atomic<bool> stopping_{false};
+  std::thread acceptThread_;
+
+  // Client threads are detached, the destructor waits for `clients_` to drop to zero
+  mutable std::mutex mutex_;
+  std::condition_variable changed_;
+  size_t clients_ = 0;
+  bool started_;
+  std::unordered_set<int> clientFds_;
+  std::vector<StreamStats> streams_;
+  std::vector<std::string> unknownRequests_;
+};
+
+}  // namespace waybar::replay
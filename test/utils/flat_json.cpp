@@ -0,0 +1,55 @@
+#include "util/flat_json.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+using waybar::util::FlatJsonReader;
+using Type = waybar::util::FlatJsonValue::Type;
+
+TEST_CASE("Flat json members", "[flat_json]") {
+  FlatJsonReader reader;
+  REQUIRE(reader.parse(
+      R"({"text": "up", "percentage": 42.5, "class": ["a", "b"], "alt": null, "x": true})"));
+  auto members = reader.members();
+  REQUIRE(members.size() == 5);
+  REQUIRE(members[0].key == "text");
+  REQUIRE(members[0].value.type == Type::STRING);
+  REQUIRE(members[0].value.string == "up");
+  REQUIRE(members[1].value.type == Type::NUMBER);
+  REQUIRE(members[1].value.number == 42.5);
+  REQUIRE(members[2].value.type == Type::STRING_ARRAY);
+  REQUIRE(members[2].value.strings == std::vector<std::string>{"a", "b"});
+  REQUIRE(members[3].value.type == Type::NUL);
+  REQUIRE(members[4].value.type == Type::BOOL);
+  REQUIRE(members[4].value.boolean);
+
+  SECTION("Storage is reused for the next line") {
+    REQUIRE(reader.parse(R"({"percentage": -3})"));
+    REQUIRE(reader.members().size() == 1);
+    REQUIRE(reader.members()[0].value.number == -3);
+  }
+}
+
+TEST_CASE("Flat json escapes", "[flat_json]") {
+  FlatJsonReader reader;
+  REQUIRE(reader.parse(R"({"text": "a\"b\\c\né😊\xab"})"));
+  REQUIRE(reader.members()[0].value.string == "a\"b\\c\né😊«");
+}
+
+TEST_CASE("Flat json rejects invalid lines", "[flat_json]") {
+  FlatJsonReader reader;
+  REQUIRE(reader.parse("{}"));
+  REQUIRE_FALSE(reader.parse(""));
+  REQUIRE_FALSE(reader.parse("plain text"));
+  REQUIRE_FALSE(reader.parse(R"({"text": "unterminated})"));
+  REQUIRE_FALSE(reader.parse(R"({"text": {"nested": 1}})"));
+  REQUIRE_FALSE(reader.parse(R"({"percentage": nan})"));
+  REQUIRE_FALSE(reader.parse(R"({"percentage": -inf})"));
+  REQUIRE_FALSE(reader.parse(R"({"percentage": -nan})"));
+  REQUIRE_FALSE(reader.parse(R"({"percentage": -})"));
+  REQUIRE_FALSE(reader.parse(R"({"text": "a"} trailing)"));
+  REQUIRE_FALSE(reader.parse(R"({"text": "\ud83d"})"));
+}
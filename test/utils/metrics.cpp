@@ -0,0 +1,42 @@
+#include "util/metrics.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+namespace metrics = waybar::util::metrics;
+
+TEST_CASE("Metrics are only collected when enabled", "[metrics]") {
+  metrics::setEnabled(false);
+  REQUIRE(metrics::histogram("test", "disabled") == nullptr);
+
+  metrics::setEnabled(true);
+  auto* histogram = metrics::histogram("test", "enabled");
+  REQUIRE(histogram != nullptr);
+  REQUIRE(metrics::histogram("test", "enabled") == histogram);
+  metrics::setEnabled(false);
+
+  auto json = metrics::toJson();
+  REQUIRE(json["test"].isMember("enabled"));
+  REQUIRE_FALSE(json["test"].isMember("disabled"));
+}
+
+TEST_CASE("Histogram summary", "[metrics]") {
+  metrics::Histogram histogram;
+  REQUIRE(histogram.toJson()["count"].asUInt64() == 0);
+
+  for (int i = 1; i <= 100; ++i) {
+    histogram.record(i);
+  }
+  auto json = histogram.toJson();
+  REQUIRE(json["count"].asUInt64() == 100);
+  REQUIRE(json["sum"].asUInt64() == 5050);
+  REQUIRE(json["min"].asUInt64() == 1);
+  REQUIRE(json["max"].asUInt64() == 100);
+  REQUIRE(json["mean"].asDouble() == 50.5);
+  // Percentiles are rounded up to the bucket bounds
+  REQUIRE(json["p50"].asUInt64() == 63);
+  REQUIRE(json["p99"].asUInt64() == 127);
+}
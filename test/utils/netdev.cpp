@@ -0,0 +1,34 @@
+#include "util/netdev.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+namespace {
+constexpr const char* NETDEV =
+    "Inter-|   Receive                                                |  Transmit\n"
+    " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs "
+    "drop fifo colls carrier compressed\n"
+    "    lo: 1234567     100    0    0    0     0          0         0  7654321     100    0    "
+    "0    0     0       0          0\n"
+    "  eth0:987654321 5000    0    0    0     0          0         0 123456789  400    0    0    "
+    "0     0       0          0\n";
+}  // namespace
+
+TEST_CASE("Parse /proc/net/dev", "[netdev][util]") {
+  SECTION("Interface counters") {
+    auto [received, transmitted] = waybar::util::parseNetdevBytes(NETDEV, "eth0");
+    REQUIRE(received == 987654321ull);
+    REQUIRE(transmitted == 123456789ull);
+  }
+  SECTION("Interface name is matched exactly") {
+    REQUIRE(waybar::util::parseNetdevBytes(NETDEV, "eth").first == 0ull);
+    REQUIRE(waybar::util::parseNetdevBytes(NETDEV, "lo").second == 7654321ull);
+  }
+  SECTION("Missing interface") {
+    REQUIRE(waybar::util::parseNetdevBytes(NETDEV, "wlan0") ==
+            std::pair<unsigned long long, unsigned long long>{0ull, 0ull});
+  }
+}
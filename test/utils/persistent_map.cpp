@@ -0,0 +1,66 @@
+#include "util/persistent_map.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <map>
+#include <string>
+
+using waybar::util::PersistentMap;
+
+TEST_CASE("Persistent map", "[persistent_map][util]") {
+  PersistentMap<std::string> map;
+  REQUIRE(map.empty());
+  REQUIRE(map.find(1) == nullptr);
+  REQUIRE_FALSE(map.erase(1));
+
+  map.set(1, "one");
+  map.set(33, "thirty-three");  // same first slot as 1
+  map.set(1ull << 63, "high");
+  REQUIRE(map.size() == 3);
+  REQUIRE(*map.find(1) == "one");
+  REQUIRE(*map.find(33) == "thirty-three");
+  REQUIRE(*map.find(1ull << 63) == "high");
+  REQUIRE(map.find(65) == nullptr);
+
+  SECTION("Copies don't see later changes") {
+    const auto snapshot = map;
+    map.set(1, "uno");
+    map.set(2, "two");
+    REQUIRE(map.erase(33));
+
+    REQUIRE(*snapshot.find(1) == "one");
+    REQUIRE(*snapshot.find(33) == "thirty-three");
+    REQUIRE(snapshot.find(2) == nullptr);
+    REQUIRE(snapshot.size() == 3);
+
+    REQUIRE(*map.find(1) == "uno");
+    REQUIRE(*map.find(2) == "two");
+    REQUIRE(map.find(33) == nullptr);
+    REQUIRE(map.size() == 3);
+  }
+
+  SECTION("Matches std::map") {
+    std::map<uint64_t, std::string> expected{
+        {1, "one"}, {33, "thirty-three"}, {1ull << 63, "high"}};
+    uint64_t key = 12345;
+    for (int i = 0; i < 5000; ++i) {
+      key = key * 6364136223846793005ull + 1442695040888963407ull;
+      const auto id = (i % 3 == 0 ? key : key >> 52);
+      if (i % 4 == 3) {
+        REQUIRE(map.erase(id) == (expected.erase(id) == 1));
+      } else {
+        map.set(id, std::to_string(i));
+        expected[id] = std::to_string(i);
+      }
+    }
+
+    REQUIRE(map.size() == expected.size());
+    std::map<uint64_t, std::string> visited;
+    map.forEach([&visited](uint64_t id, const std::string& value) { visited.emplace(id, value); });
+    REQUIRE(visited == expected);
+  }
+}
@@ -0,0 +1,80 @@
+#include "util/regex_collection.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+using waybar::util::RegexCollection;
+using waybar::util::required_literal;
+
+TEST_CASE("Extract required literals", "[regex_collection][util]") {
+  REQUIRE(required_literal("class<firefox>") == "class<firefox>");
+  REQUIRE(required_literal("title<.*YouTube.*>") == "youtube");
+  REQUIRE(required_literal("class<firefox> title<.*github.*>") == "class<firefox> title<");
+  REQUIRE(required_literal("colou?r") == "colo");
+  REQUIRE(required_literal("ab+cde") == "cde");
+  REQUIRE(required_literal("a\\.b\\d") == "a.b");
+  REQUIRE(required_literal("(optional)?text[0-9]{2,3}") == "text");
+  REQUIRE(required_literal("firefox|chromium").empty());
+  REQUIRE(required_literal(".*").empty());
+  // Operands of escapes are not literal text
+  REQUIRE(required_literal("a\\x41bc") == "bc");
+  REQUIRE(required_literal("title<\\u0041bc>") == "title<");
+  REQUIRE(required_literal("foo\\cJbar") == "foo");
+  REQUIRE(required_literal("(a)\\1bc") == "bc");
+}
+
+TEST_CASE("Match rules with escapes", "[regex_collection][util]") {
+  Json::Value rules;
+  rules["a\\x41b"] = "hex";
+  rules["title<\\u0041bc>"] = "unicode";
+  RegexCollection collection{rules, "?"};
+
+  std::string hex = "aAb";
+  std::string unicode = "title<Abc>";
+  REQUIRE(collection.get(hex) == "hex");
+  REQUIRE(collection.get(unicode) == "unicode");
+}
+
+TEST_CASE("Match rules", "[regex_collection][util]") {
+  Json::Value rules;
+  rules["class<firefox>"] = "F";
+  rules["title<.* - (.*) - VSCodium>"] = "codium $1";
+  rules["FOOT"] = "T";
+  RegexCollection collection{rules, "?"};
+
+  std::string firefox = "class<Firefox> title<Waybar>";
+  std::string codium = "class<codium> title<main.cpp - waybar - VSCodium>";
+  std::string foot = "class<foot> title<~>";
+  std::string other = "class<kitty> title<~>";
+
+  bool matched = false;
+  REQUIRE(collection.get(firefox, matched) == "F");
+  REQUIRE(matched);
+  REQUIRE(collection.get(codium) == "codium waybar");
+  REQUIRE(collection.get(foot) == "T");
+
+  matched = false;
+  REQUIRE(collection.get(other, matched) == "?");
+  REQUIRE_FALSE(matched);
+
+  SECTION("Cached results") {
+    matched = false;
+    REQUIRE(collection.get(firefox, matched) == "F");
+    REQUIRE(matched);
+  }
+  SECTION("Bounded cache") {
+    RegexCollection small{rules, "?", waybar::util::default_priority_function, 2};
+    REQUIRE(small.get(firefox) == "F");
+    REQUIRE(small.get(codium) == "codium waybar");
+    REQUIRE(small.get(foot) == "T");
+    REQUIRE(small.get(firefox) == "F");
+  }
+  SECTION("Copies keep working") {
+    RegexCollection copy = collection;
+    REQUIRE(copy.get(codium) == "codium waybar");
+    REQUIRE(copy.get(other) == "?");
+  }
+}
@@ -0,0 +1,101 @@
+#include "util/update_dispatcher.hpp"
+
+#include <glibmm.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <atomic>
+#include <thread>
+
+#include "fixtures/GlibTestsFixture.hpp"
+
+using waybar::util::UpdateDispatcher;
+
+/**
+ * Emits pending for the same module collapse into one update, updates of different modules run
+ * in the same main loop iteration.
+ */
+TEST_CASE_METHOD(GlibTestsFixture, "UpdateDispatcher collapses emits", "[dispatcher][util]") {
+  auto context = main_loop_->get_context();
+  int first_updates = 0;
+  int second_updates = 0;
+  int second_updates_seen_by_first = -1;
+  int first_updates_seen_by_second = -1;
+
+  UpdateDispatcher first;
+  UpdateDispatcher second;
+  first.connect([&]() {
+    ++first_updates;
+    second_updates_seen_by_first = second_updates;
+  });
+  second.connect([&]() {
+    ++second_updates;
+    first_updates_seen_by_second = first_updates;
+  });
+
+  first.emit();
+  first.emit();
+  second.emit();
+  // nothing runs before the main loop gets control back
+  REQUIRE(first_updates == 0);
+  REQUIRE(second_updates == 0);
+
+  context->iteration(true);
+  REQUIRE(first_updates == 1);
+  REQUIRE(second_updates == 1);
+  // both ran in the same pass, in emit order
+  REQUIRE(second_updates_seen_by_first == 0);
+  REQUIRE(first_updates_seen_by_second == 1);
+
+  // nothing is left pending
+  while (context->iteration(false)) {
+  }
+  REQUIRE(first_updates == 1);
+  REQUIRE(second_updates == 1);
+
+  // an emit after an update needs another one
+  first.emit();
+  context->iteration(true);
+  REQUIRE(first_updates == 2);
+  REQUIRE(second_updates == 1);
+}
+
+/**
+ * Emits from another thread are followed by an update that sees everything written before the last
+ * emit.
+ */
+TEST_CASE_METHOD(GlibTestsFixture, "UpdateDispatcher updates after emits from other threads",
+                 "[dispatcher][util]") {
+  const int NUM_EVENTS = 1000;
+  int updates = 0;
+  std::atomic<bool> producer_done = false;
+
+  UpdateDispatcher dispatcher;
+  dispatcher.connect([&]() {
+    ++updates;
+    if (producer_done) {
+      this->quit();
+    }
+  });
+
+  // timeout the test in 500ms
+  setTimeout(500);
+
+  std::thread producer;
+  run([&]() {
+    producer = std::thread([&]() {
+      for (auto i = 0; i < NUM_EVENTS; ++i) {
+        dispatcher.emit();
+      }
+      producer_done = true;
+      // an update pending before producer_done was set may not see it
+      dispatcher.emit();
+    });
+  });
+  producer.join();
+
+  REQUIRE(updates >= 1);
+}